@@ -6,6 +6,13 @@
  */
 
 #include "PushButton.h"
+#include "PushButtonManager.h"
+#include "PushButtonEventQueue.h"
+#include "PushButtonTrace.h"
+#include "PushButtonSampler.h"
+#if ESP_PLATFORM==1
+#include "esp_timer.h"
+#endif
 
 
 
@@ -18,6 +25,11 @@
 static const char* _MODULE_ = "[PushBtn].......";
 #define _EXPR_	(_defdbg && !IS_ISR())
 
+/** Cerrojo de escritura de la configuracion, con inicializacion constante para poder configurar pulsadores
+ *  construidos de forma estatica
+ */
+std::atomic<uint32_t> PushButton::_cfg_writer(0);
+
 
 //------------------------------------------------------------------------------------
 //-- PUBLIC METHODS IMPLEMENTATION ---------------------------------------------------
@@ -26,57 +38,77 @@ static const char* _MODULE_ = "[PushBtn].......";
 
 //------------------------------------------------------------------------------------
 PushButton::PushButton(PinName32 btn, uint32_t id, LogicLevel level, PinMode mode, uint32_t filter_us, bool defdbg) : _defdbg(defdbg) {
-    // Crea objeto
-	DEBUG_TRACE_I(_EXPR_, _MODULE_, "Creando PushButton en pin %d", btn);
-	_iin = new InterruptIn((PinName)btn);
-	MBED_ASSERT(_iin);
-	_iin->mode(mode);
-	_iin->rise(NULL);
-	_iin->fall(NULL);
-    _level = level;
-    _id = id;
-    _hold_us = 0;
-    _hold_running = false;
-    _endis_gfilt = true;
-    _filter_timeout_us = filter_us;
-    
-    // Desactiva las callbacks de notificaci�n
-    DEBUG_TRACE_I(_EXPR_, _MODULE_, "Desactivando callbacks");
-    _pressCb = (Callback<void(uint32_t)>) NULL;
-    _holdCb = (Callback<void(uint32_t)>) NULL;
-    _releaseCb = (Callback<void(uint32_t)>) NULL;
-    _pressCb2 = (Callback<void()>) NULL;
-    _holdCb2 = (Callback<void()>) NULL;
-    _releaseCb2 = (Callback<void()>) NULL;
-
-
-    // Crea temporizadores
-    DEBUG_TRACE_I(_EXPR_, _MODULE_, "Creando tickers de tarea");
-	#if __MBED__==1
-    _tick_filt = new RtosTimer(callback(this, &PushButton::gpioFilterCallback), osTimerOnce);
-    MBED_ASSERT(_tick_filt);
-    _tick_hold = new RtosTimer(callback(this, &PushButton::holdTickCallback), osTimerPeriodic);
-    MBED_ASSERT(_tick_hold);
-	#elif ESP_PLATFORM==1
-    _tick_filt = new RtosTimer(callback(this, &PushButton::gpioFilterCallback), osTimerOnce, "BtnTmrFilt");
-    MBED_ASSERT(_tick_filt);
-    _tick_hold = new RtosTimer(callback(this, &PushButton::holdTickCallback), osTimerPeriodic, "BtnTmrHold");
-    MBED_ASSERT(_tick_hold);
-	#endif
-    sprintf(_th_name,"pushb_%x", (uint32_t)this);
-    _th = new Thread(osPriorityNormal, OS_STACK_SIZE, NULL, _th_name);
-    MBED_ASSERT(_th);
-    _th->start(callback(this, &PushButton::_task));
+	_mgr = NULL;
+	_smp = NULL;
+	init(btn, id, level, mode, filter_us);
+	startDispatcher();
+}
 
+
+//------------------------------------------------------------------------------------
+PushButton::PushButton(PushButtonManager* mgr, PinName32 btn, uint32_t id, LogicLevel level, PinMode mode, uint32_t filter_us, bool defdbg) : _defdbg(defdbg) {
+	MBED_ASSERT(mgr);
+	_mgr = mgr;
+	_smp = NULL;
+	init(btn, id, level, mode, filter_us);
+	startDispatcher();
+}
+
+
+//------------------------------------------------------------------------------------
+PushButton::PushButton(PushButtonSampler* smp, uint8_t input, uint32_t id, LogicLevel level, uint32_t filter_us,
+					   PushButtonManager* mgr, bool defdbg) : _defdbg(defdbg) {
+	MBED_ASSERT(smp && input < PushButtonSampler::MaxInputs);
+	_mgr = mgr;
+	_smp = smp;
+	_input = input;
+	init(0, id, level, PullNone, filter_us);
+	startDispatcher();
 }
 
 
 //------------------------------------------------------------------------------------
 PushButton::~PushButton() {
-	delete(_tick_filt);
-	delete(_tick_hold);
-	delete(_iin);
-	delete(_th);
+	if(_smp){
+		_smp->detach(_input);
+	}
+	else{
+		_iin->rise(NULL);
+		_iin->fall(NULL);
+	}
+	if(_mgr){
+		_mgr->stopTimer(&_filt_node);
+		_mgr->stopTimer(&_hold_node);
+		_mgr->detach(_slot);
+	}
+	if(_queue){
+		_queue->purge(this);
+	}
+	if(_own){
+		delete(_own->tick_filt);
+		delete(_own->tick_hold);
+		delete(_own->th);
+		delete(_own);
+	}
+	if(_iin){
+		_iin->~InterruptIn();
+	}
+	Extension* ext = getExtension();
+	if(ext){
+		ext->~Extension();
+	}
+	if(_ext_owned){
+		delete(_ext_mem);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::setExtensionStorage(ExtensionStorage* storage){
+	lockConfig();
+	MBED_ASSERT(storage && !getExtension());
+	_ext_mem = storage;
+	unlockConfig();
 }
 
 
@@ -86,7 +118,10 @@ void PushButton::enablePressEvents(Callback<void(uint32_t)>pressCb){
 		disablePressEvents();
 		return;
 	}
-	_pressCb = pressCb;
+	lockConfig();
+	_cfg.edit().pressCb = pressCb;
+	_cfg.publish();
+	unlockConfig();
 	enableRiseFallCallbacks();
 }
 
@@ -97,7 +132,11 @@ void PushButton::enablePressEvents(Callback<void()>pressCb){
 		disablePressEvents();
 		return;
 	}
-	_pressCb2 = pressCb;
+	lockConfig();
+	Extension* ext = requireExtension();
+	ext->cfg.edit().pressCb2 = pressCb;
+	ext->cfg.publish();
+	unlockConfig();
 	enableRiseFallCallbacks();
 }
 
@@ -108,8 +147,19 @@ void PushButton::enableHoldEvents(Callback<void(uint32_t)>holdCb, uint32_t milli
 		disableHoldEvents();
 		return;
 	}
-	_holdCb = holdCb;
-	_hold_us = 1000 * millis;
+	lockConfig();
+	// el periodo fijo sustituye al perfil instalado
+	Extension* ext = getExtension();
+	if(ext){
+		ext->cfg.edit().hold = HoldProfile();
+		ext->cfg.publish();
+	}
+	Config& cfg = _cfg.edit();
+	cfg.holdCb = holdCb;
+	cfg.hold_us = 1000 * millis;
+	cfg.hold_period_us = 1000 * millis;
+	_cfg.publish();
+	unlockConfig();
 	enableRiseFallCallbacks();
 }
 
@@ -120,19 +170,79 @@ void PushButton::enableHoldEvents(Callback<void()>holdCb, uint32_t millis){
 		disableHoldEvents();
 		return;
 	}
-	_holdCb2 = holdCb;
-	_hold_us = 1000 * millis;
+	lockConfig();
+	Extension* ext = requireExtension();
+	Extension::Config& xcfg = ext->cfg.edit();
+	xcfg.holdCb2 = holdCb;
+	xcfg.hold = HoldProfile();
+	ext->cfg.publish();
+	Config& cfg = _cfg.edit();
+	cfg.hold_us = 1000 * millis;
+	cfg.hold_period_us = 1000 * millis;
+	_cfg.publish();
+	unlockConfig();
+	enableRiseFallCallbacks();
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::enableHoldEvents(Callback<void(uint32_t, uint32_t, uint32_t)>holdCb, const HoldProfile& profile){
+	if(!holdCb || profile.delay_ms == 0 || profile.period_ms == 0){
+		disableHoldEvents();
+		return;
+	}
+	MBED_ASSERT(profile.steps <= MaxHoldSteps);
+	lockConfig();
+	Extension* ext = requireExtension();
+	Extension::Config& xcfg = ext->cfg.edit();
+	xcfg.holdCb3 = holdCb;
+	xcfg.hold = profile;
+	ext->cfg.publish();
+	Config& cfg = _cfg.edit();
+	cfg.hold_us = 1000 * profile.delay_ms;
+	cfg.hold_period_us = 1000 * profile.period_ms;
+	_cfg.publish();
+	unlockConfig();
 	enableRiseFallCallbacks();
 }
 
 
+//------------------------------------------------------------------------------------
+void PushButton::enableHoldStepEvents(Callback<void(uint32_t, uint8_t)>stepCb){
+	if(!stepCb){
+		disableHoldStepEvents();
+		return;
+	}
+	lockConfig();
+	Extension* ext = requireExtension();
+	ext->cfg.edit().holdStepCb = stepCb;
+	ext->cfg.publish();
+	unlockConfig();
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::disableHoldStepEvents(){
+	lockConfig();
+	Extension* ext = getExtension();
+	if(ext){
+		ext->cfg.edit().holdStepCb = (Callback<void(uint32_t, uint8_t)>) NULL;
+		ext->cfg.publish();
+	}
+	unlockConfig();
+}
+
+
 //------------------------------------------------------------------------------------
 void PushButton::enableReleaseEvents(Callback<void(uint32_t)>releaseCb){
 	if(!releaseCb){
 		disableReleaseEvents();
 		return;
 	}
-	_releaseCb = releaseCb;
+	lockConfig();
+	_cfg.edit().releaseCb = releaseCb;
+	_cfg.publish();
+	unlockConfig();
 	enableRiseFallCallbacks();
 }
 
@@ -143,34 +253,326 @@ void PushButton::enableReleaseEvents(Callback<void()>releaseCb){
 		disableReleaseEvents();
 		return;
 	}
-	_releaseCb2 = releaseCb;
+	lockConfig();
+	Extension* ext = requireExtension();
+	ext->cfg.edit().releaseCb2 = releaseCb;
+	ext->cfg.publish();
+	unlockConfig();
 	enableRiseFallCallbacks();
 }
 
 
 //------------------------------------------------------------------------------------
 void PushButton::disablePressEvents(){
-    _pressCb = (Callback<void(uint32_t)>) NULL;
-    _pressCb2 = (Callback<void()>) NULL;
+	lockConfig();
+	_cfg.edit().pressCb = (Callback<void(uint32_t)>) NULL;
+	_cfg.publish();
+	Extension* ext = getExtension();
+	if(ext){
+		ext->cfg.edit().pressCb2 = (Callback<void()>) NULL;
+		ext->cfg.publish();
+	}
+	unlockConfig();
 }
 
 
 //------------------------------------------------------------------------------------
 void PushButton::disableHoldEvents(){
-	if(_hold_running){
-		_tick_hold->stop();
+	// tras publicar, un timer hold que venza antes de que el hilo de despacho aplique la solicitud se detiene
+	// sin notificar eventos (ver notifyHold)
+	lockConfig();
+	Config& cfg = _cfg.edit();
+    cfg.holdCb = (Callback<void(uint32_t)>) NULL;
+    cfg.hold_us = 0;
+	_cfg.publish();
+	Extension* ext = getExtension();
+	if(ext){
+		Extension::Config& xcfg = ext->cfg.edit();
+		xcfg.holdCb2 = (Callback<void()>) NULL;
+		xcfg.holdCb3 = (Callback<void(uint32_t, uint32_t, uint32_t)>) NULL;
+		ext->cfg.publish();
 	}
-	_hold_running = false;
-    _holdCb = (Callback<void(uint32_t)>) NULL;
-    _holdCb2 = (Callback<void()>) NULL;
-    _hold_us = 0;
+	unlockConfig();
+	postRequest(ReqHold);
 }
 
 
 //------------------------------------------------------------------------------------
 void PushButton::disableReleaseEvents(){
-    _releaseCb = (Callback<void(uint32_t)>) NULL;
-    _releaseCb2 = (Callback<void()>) NULL;
+	lockConfig();
+	_cfg.edit().releaseCb = (Callback<void(uint32_t)>) NULL;
+	_cfg.publish();
+	Extension* ext = getExtension();
+	if(ext){
+		ext->cfg.edit().releaseCb2 = (Callback<void()>) NULL;
+		ext->cfg.publish();
+	}
+	unlockConfig();
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::enableGestureEvents(Callback<void(uint32_t, PushButtonGesture::Gesture, uint8_t)>gestureCb, const PushButtonGesture::Config& cfg){
+	if(!gestureCb){
+		disableGestureEvents();
+		return;
+	}
+	lockConfig();
+	Extension* ext = requireExtension();
+	Extension::Config& xcfg = ext->cfg.edit();
+	xcfg.gestureCb = gestureCb;
+	xcfg.gesture = cfg;
+	ext->cfg.publish();
+	unlockConfig();
+	postRequest(ReqGesture);
+	enableRiseFallCallbacks();
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::disableGestureEvents(){
+	lockConfig();
+	Extension* ext = getExtension();
+	if(ext){
+		ext->cfg.edit().gestureCb = (Callback<void(uint32_t, PushButtonGesture::Gesture, uint8_t)>) NULL;
+		ext->cfg.publish();
+	}
+	unlockConfig();
+	if(ext){
+		postRequest(ReqGesture);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::enableCancelEvents(Callback<void(uint32_t)>cancelCb){
+	if(!cancelCb){
+		disableCancelEvents();
+		return;
+	}
+	lockConfig();
+	Extension* ext = requireExtension();
+	ext->cfg.edit().cancelCb = cancelCb;
+	ext->cfg.publish();
+	unlockConfig();
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::disableCancelEvents(){
+	lockConfig();
+	Extension* ext = getExtension();
+	if(ext){
+		ext->cfg.edit().cancelCb = (Callback<void(uint32_t)>) NULL;
+		ext->cfg.publish();
+	}
+	unlockConfig();
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::enableEventCallback(Callback<void(const Event&)>eventCb){
+	if(!eventCb){
+		disableEventCallback();
+		return;
+	}
+	lockConfig();
+	Extension* ext = requireExtension();
+	ext->cfg.edit().eventCb = eventCb;
+	ext->cfg.publish();
+	unlockConfig();
+	enableRiseFallCallbacks();
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::disableEventCallback(){
+	lockConfig();
+	Extension* ext = getExtension();
+	if(ext){
+		ext->cfg.edit().eventCb = (Callback<void(const Event&)>) NULL;
+		ext->cfg.publish();
+	}
+	unlockConfig();
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::enableStormEvents(Callback<void(uint32_t)>stormCb){
+	if(!stormCb){
+		disableStormEvents();
+		return;
+	}
+	lockConfig();
+	Extension* ext = requireExtension();
+	ext->cfg.edit().stormCb = stormCb;
+	ext->cfg.publish();
+	unlockConfig();
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::disableStormEvents(){
+	lockConfig();
+	Extension* ext = getExtension();
+	if(ext){
+		ext->cfg.edit().stormCb = (Callback<void(uint32_t)>) NULL;
+		ext->cfg.publish();
+	}
+	unlockConfig();
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::setTraceRecorder(PushButtonTrace* trace){
+	lockConfig();
+	Extension* ext = (trace)? requireExtension() : getExtension();
+	unlockConfig();
+	if(!ext){
+		return;
+	}
+	if(trace){
+		ConfigLatch::Reader cfg(_cfg);
+		trace->setup(_level, cfg->filt_mode, _filter_timeout_us, cfg->hold_us, readPin(),
+				(_leading)? PushButtonTrace::FlagLeadingEdge : 0);
+	}
+	ext->trace = trace;
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::setFilterMode(FilterMode mode){
+	lockConfig();
+	// el filtrado adaptativo utiliza el aprendizaje del rebote
+	if(mode == FilterAdaptive){
+		requireExtension();
+	}
+	_cfg.edit().filt_mode = mode;
+	_cfg.publish();
+	unlockConfig();
+	postRequest(ReqFilter);
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::setAdaptiveFilter(const PushButtonBounceEstimator::Config& cfg){
+	lockConfig();
+	Extension* ext = requireExtension();
+	ext->cfg.edit().bounce = cfg;
+	ext->cfg.publish();
+	_cfg.edit().filt_mode = FilterAdaptive;
+	_cfg.publish();
+	unlockConfig();
+	postRequest(ReqBounce | ReqFilter);
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::getBounceStats(PushButtonBounceEstimator::Stats& stats){
+	Extension* ext = getExtension();
+	if(ext){
+		ext->bounce.getStats(stats);
+	}
+	else{
+		PushButtonBounceEstimator(_filter_timeout_us).getStats(stats);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::setLowPowerMode(bool enable){
+	lockConfig();
+	Config& cfg = _cfg.edit();
+	uint32_t req = (enable != cfg.low_power)? ReqLowPower : 0;
+	cfg.low_power = enable;
+	if(req != 0 && enable && cfg.filt_mode == FilterTimer){
+		cfg.filt_mode = FilterStableTime;
+		req |= ReqFilter;
+	}
+	_cfg.publish();
+	unlockConfig();
+	if(req != 0){
+		postRequest(req);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::setStormProtection(uint32_t max_edges, uint32_t window_ms, uint32_t backoff_ms){
+	lockConfig();
+	Extension* ext = (max_edges > 0)? requireExtension() : getExtension();
+	unlockConfig();
+	if(!ext){
+		return;
+	}
+	// la ISR solo consulta el umbral, que se actualiza el ultimo
+	core_util_critical_section_enter();
+	ext->storm_max = 0;
+	ext->storm_window_us = 1000 * ((window_ms > 0)? window_ms : 1);
+	ext->storm_base_us = 1000 * ((backoff_ms > 0)? backoff_ms : 1);
+	ext->storm_win_us = getTimeUs();
+	ext->storm_edges = 0;
+	ext->storm_max = (_smp)? 0 : max_edges;
+	core_util_critical_section_exit();
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::getStormStats(StormStats& stats){
+	Extension* ext = getExtension();
+	if(!ext){
+		memset(&stats, 0, sizeof(StormStats));
+		return;
+	}
+	core_util_critical_section_enter();
+	stats = ext->storm_stats;
+	stats.masked = ext->storm_masked || ext->storm_pending;
+	core_util_critical_section_exit();
+}
+
+
+//------------------------------------------------------------------------------------
+uint32_t PushButton::getPressedMask(PushButton* const btns[], uint32_t count){
+	MBED_ASSERT(count <= 32);
+	uint32_t mask = 0;
+	for(uint32_t i = 0; i < count; i++){
+		mask |= (btns[i] && btns[i]->isPressed())? (1u << i) : 0;
+	}
+	return mask;
+}
+
+
+//------------------------------------------------------------------------------------
+uint32_t PushButton::getEdgeOverflowCount(){
+	return (_mgr)? _mgr->getEdgeOverflowCount() : _own->edges.getOverflowCount();
+}
+
+
+//------------------------------------------------------------------------------------
+bool PushButton::getStats(PushButtonStats::Snapshot& snap){
+	#if defined(ENABLE_PUSHBUTTON_STATS)
+	_stats.getSnapshot(snap);
+	return true;
+	#else
+	(void)snap;
+	return false;
+	#endif
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::resetStats(){
+	PUSHBUTTON_STATS(_stats.reset();)
+}
+
+
+//------------------------------------------------------------------------------------
+uint32_t PushButton::getTimeUs(){
+	#if ESP_PLATFORM==1
+	return (uint32_t)esp_timer_get_time();
+	#else
+	return us_ticker_read();
+	#endif
 }
 
 
@@ -180,89 +582,917 @@ void PushButton::disableReleaseEvents(){
 
 
 //------------------------------------------------------------------------------------
-void PushButton::_task(){
-	for(;;){
-		osEvent oe = _th->signal_wait(osFlagsWaitAny, osWaitForever);
+void PushButton::init(PinName32 btn, uint32_t id, LogicLevel level, PinMode mode, uint32_t filter_us) {
+    // Crea objeto. Con muestreador, los flancos se reciben desde su hilo
+	_iin = NULL;
+	if(_smp){
+		DEBUG_TRACE_I(_EXPR_, _MODULE_, "Creando PushButton en entrada muestreada %d", _input);
+	}
+	else{
+		DEBUG_TRACE_I(_EXPR_, _MODULE_, "Creando PushButton en pin %d", btn);
+		_iin = new(_iin_mem) InterruptIn((PinName)btn);
+		_iin->mode(mode);
+		_iin->rise(NULL);
+		_iin->fall(NULL);
+	}
+    _level = level;
+    _id = id;
+    _hold_running = false;
+    _low_power = false;
+    _hold_armed = false;
+    _requests = 0;
+    _ext = NULL;
+    _ext_mem = NULL;
+    _ext_owned = false;
+    _own = NULL;
+    _leading = false;
+    _lead_press = false;
+    _hold_next_us = 0;
+    _hold_period_us = 0;
+    _hold_repeat = 0;
+    _hold_step = 0;
+    _wakeups = 0;
+    _endis_gfilt = true;
+    _filter_timeout_us = filter_us;
+    _filt_mode = FilterTimer;
+    _debouncer.setup(PushButtonDebouncer::StableTime, filter_us);
+    // nivel inicial, antes de que el hilo de despacho o el gestor atiendan el pulsador
+    _curr_value = readPin();
+    _stable_value = _curr_value;
+    _debouncer.reset(_curr_value, getTimeUs());
+    _burst = false;
+    _burst_ts_us = 0;
+    _event_ts_us = 0;
+    _level_ts_us = 0;
+    _queue = NULL;
+    _state.press_ts_us = 0;
+    _state.presses = 0;
+    _state.releases = 0;
+    _state.holds = 0;
+    _state.pressed = false;
+    _state_pub.write(_state);
+
+    // En modo grupo los temporizadores se programan en la rueda compartida del gestor
+    _filt_node.ctx = this;
+    _hold_node.ctx = this;
+}
+
+
+//------------------------------------------------------------------------------------
+PushButton::Extension::Extension(uint32_t filter_us) : bounce(filter_us) {
+	trace = NULL;
+	storm_max = 0;
+	storm_window_us = 0;
+	storm_base_us = 0;
+	storm_win_us = 0;
+	storm_edges = 0;
+	storm_pending = false;
+	storm_masked = false;
+	storm_ts_us = 0;
+	storm_until_us = 0;
+	storm_unmask_us = 0;
+	storm_stats.storms = 0;
+	storm_stats.masked_ms = 0;
+	storm_stats.backoff_ms = 0;
+	storm_stats.masked = false;
+}
+
+
+//------------------------------------------------------------------------------------
+PushButton::Extension* PushButton::requireExtension(){
+	Extension* ext = getExtension();
+	if(ext){
+		return ext;
+	}
+	if(!_ext_mem){
+		DEBUG_TRACE_I(_EXPR_, _MODULE_, "Creando funciones opcionales");
+		_ext_mem = new ExtensionStorage;
+		MBED_ASSERT(_ext_mem);
+		_ext_owned = true;
+	}
+	// se publica completamente construida, ya que la ISR y el hilo de despacho la consultan sin bloqueos
+	ext = new(_ext_mem->mem) Extension(_filter_timeout_us);
+	_ext.store(ext);
+	return ext;
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::startDispatcher(){
+	if(_mgr){
+		// Se registra en el gestor, que se encargara de procesar sus eventos
+		DEBUG_TRACE_I(_EXPR_, _MODULE_, "Registrando PushButton en gestor");
+		int slot = _mgr->attach(this);
+		MBED_ASSERT(slot >= 0);
+		_slot = (uint8_t)slot;
+		return;
+	}
+	_slot = 0;
+
+	// Crea los temporizadores, el buffer de flancos y el hilo propio
+	_own = new Standalone();
+	MBED_ASSERT(_own);
+    DEBUG_TRACE_I(_EXPR_, _MODULE_, "Creando tickers de tarea");
+	#if __MBED__==1
+    _own->tick_filt = new RtosTimer(callback(this, &PushButton::filterTickCallback), osTimerOnce);
+    MBED_ASSERT(_own->tick_filt);
+    _own->tick_hold = new RtosTimer(callback(this, &PushButton::holdTickCallback), osTimerPeriodic);
+    MBED_ASSERT(_own->tick_hold);
+	#elif ESP_PLATFORM==1
+    _own->tick_filt = new RtosTimer(callback(this, &PushButton::filterTickCallback), osTimerOnce, "BtnTmrFilt");
+    MBED_ASSERT(_own->tick_filt);
+    _own->tick_hold = new RtosTimer(callback(this, &PushButton::holdTickCallback), osTimerPeriodic, "BtnTmrHold");
+    MBED_ASSERT(_own->tick_hold);
+	#endif
+    _own->filt_due_us = 0;
+    _own->hold_tick_ms = 0;
+    sprintf(_own->th_name,"pushb_%x", (uint32_t)(uintptr_t)this);
+    _own->th = new Thread(osPriorityNormal, OS_STACK_SIZE, NULL, _own->th_name);
+    MBED_ASSERT(_own->th);
+    _own->th->start(callback(this, &PushButton::_task));
+}
+
+
+//------------------------------------------------------------------------------------
+uint8_t PushButton::readPin(){
+	return (_smp)? _smp->getLevel(_input) : (uint8_t)_iin->read();
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::lockConfig(){
+	while(_cfg_writer.exchange(1) != 0){
+		Thread::wait(1);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::unlockConfig(){
+	_cfg_writer.store(0);
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::postRequest(uint32_t req){
+	// la configuracion ya esta publicada: el hilo de despacho la lee tras recoger la solicitud
+	_requests |= req;
+	if(_mgr){
+		_mgr->postRequest(_slot);
+	}
+	else{
+		_own->th->signal_set(EvConfig);
+	}
+}
 
-		// Evalua rise
-		if(oe.status == osEventSignal &&  (oe.value.signals & EvRise) != 0){
-			_curr_value = 1;
-			if(_endis_gfilt){
-				_tick_filt->start(_filter_timeout_us/1000);
+
+//------------------------------------------------------------------------------------
+void PushButton::applyRequests(uint32_t now_us){
+	uint32_t req = _requests.exchange(0);
+	if(req == 0){
+		return;
+	}
+	bool hold;
+	FilterMode mode;
+	bool low_power;
+	{
+		ConfigLatch::Reader cfg(_cfg);
+		hold = (cfg->hold_us > 0);
+		mode = cfg->filt_mode;
+		low_power = cfg->low_power;
+	}
+	// las solicitudes de gestos y filtrado adaptativo se realizan tras construir las funciones opcionales
+	Extension* ext = getExtension();
+	if(ext && (req & (ReqGesture | ReqBounce)) != 0){
+		bool gestures;
+		PushButtonGesture::Config gesture;
+		PushButtonBounceEstimator::Config bounce;
+		{
+			Extension::ConfigLatch::Reader cfg(ext->cfg);
+			gestures = (bool)cfg->gestureCb;
+			gesture = cfg->gesture;
+			bounce = cfg->bounce;
+		}
+		if((req & ReqGesture) != 0){
+			if(gestures){
+				ext->gesture.setup(gesture);
 			}
 			else{
-				gpioFilterCallback();
+				ext->gesture.reset();
 			}
 		}
-		// Evalua fall
-		if(oe.status == osEventSignal &&  (oe.value.signals & EvFall) != 0){
-			_curr_value = 0;
-			if(_endis_gfilt){
-				_tick_filt->start(_filter_timeout_us/1000);
+		if((req & ReqBounce) != 0){
+			ext->bounce.setup(bounce, _filter_timeout_us);
+		}
+	}
+	if((req & ReqHold) != 0 && !hold){
+		stopHold();
+	}
+	if((req & ReqFilter) != 0){
+		applyFilterMode(mode, now_us);
+	}
+	if((req & ReqLowPower) != 0){
+		applyLowPower(low_power, now_us);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::applyFilterMode(FilterMode mode, uint32_t now_us){
+	_filt_mode = mode;
+	_debouncer.setup((mode == FilterIntegrator)? PushButtonDebouncer::Integrator : PushButtonDebouncer::StableTime,
+			(mode == FilterAdaptive)? getExtension()->bounce.getWindow() : _filter_timeout_us);
+	_debouncer.reset(_stable_value, now_us);
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::applyLowPower(bool enable, uint32_t now_us){
+	if(enable == _low_power){
+		return;
+	}
+	// el evento hold en curso continua con el nuevo mecanismo. El hilo de despacho recalcula su espera tras
+	// aplicar la solicitud
+	bool holding = (_hold_running || _hold_armed);
+	stopHold();
+	_low_power = enable;
+	if(holding){
+		if(_low_power){
+			_hold_next_us = now_us + _hold_period_us;
+			_hold_armed = true;
+		}
+		else{
+			startHoldTimer(_hold_period_us, _hold_period_us);
+		}
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::_task(){
+	for(;;){
+		// la espera finaliza al vencer la ventana en curso (filtrado sin timer o gestos) o con cualquier senal: los
+		// timers propios solo senalizan su vencimiento, de forma que todo el estado del pulsador se modifica en
+		// este hilo
+		osEvent oe = _own->th->signal_wait(0, getWaitTimeout(getTimeUs()));
+		_wakeups++;
+		if(oe.status != osEventSignal){
+			resolveTimeouts(getTimeUs());
+			continue;
+		}
+		if((oe.value.signals & EvConfig) != 0){
+			applyRequests(getTimeUs());
+		}
+		// el vencimiento del filtro se evalua antes que los flancos nuevos, que lo reinician
+		if((oe.value.signals & EvFilter) != 0){
+			resolveFilterTick(getTimeUs());
+		}
+		if((oe.value.signals & EvHold) != 0){
+			resolveHoldTick(getTimeUs());
+		}
+		if((oe.value.signals & EvEdge) == 0){
+			continue;
+		}
+		// procesa el lote completo de flancos pendientes e inicia el filtrado una sola vez
+		EdgeRecord rec;
+		bool edges = false;
+		while(_own->edges.pop(rec)){
+			processEdge(rec);
+			edges = true;
+		}
+		if(edges){
+			commitEdges();
+		}
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::processEdge(const EdgeRecord& rec){
+	bool idle = (_endis_gfilt && _filt_mode != FilterTimer)? !_debouncer.isPending() : !_burst;
+	// el instante de la rafaga es el de su primer flanco
+	if(!_burst){
+		_burst = true;
+		_burst_ts_us = rec.ts_us;
+	}
+	_curr_value = rec.level;
+	PUSHBUTTON_STATS(_stats.dispatch.add(getTimeUs() - rec.ts_us);)
+	if(_endis_gfilt && _filt_mode != FilterTimer){
+		_debouncer.edge(rec.level, rec.ts_us);
+		if(_filt_mode == FilterAdaptive){
+			getExtension()->bounce.edge(rec.ts_us);
+		}
+	}
+	// notificacion inmediata: el primer flanco de la rafaga hacia el nivel de pulsacion se notifica sin filtrar y
+	// el filtro en curso lo verifica al estabilizarse el nivel
+	uint8_t press_level = (_level == PressIsLowLevel)? 0 : 1;
+	if(_leading && idle && rec.level == press_level && _stable_value != press_level){
+		notifyLevel(rec.level, rec.ts_us);
+		_lead_press = true;
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::commitEdges(){
+	if(!_endis_gfilt){
+		gpioFilterCallback();
+	}
+	else if(_filt_mode == FilterTimer){
+		startFilterTimer();
+	}
+	else{
+		resolveDebounce(getTimeUs());
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::resolveDebounce(uint32_t now_us){
+	bool changed = _debouncer.update(now_us);
+	bool resolved = !_debouncer.isPending();
+
+	// una vez resuelta la rafaga, verifica que no se haya perdido ningun flanco por desbordamiento
+	if(resolved){
+		PushButtonBounceEstimator* bounce = (_filt_mode == FilterAdaptive)? &getExtension()->bounce : NULL;
+		if(bounce){
+			bounce->resolve(changed);
+		}
+		uint8_t pin_level = readPin();
+		if(pin_level != _debouncer.getRaw()){
+			DEBUG_TRACE_W(_EXPR_, _MODULE_, "ERR_NOISE");
+			PUSHBUTTON_STATS(_stats.noise_errors++;)
+			if(bounce){
+				bounce->noise();
+			}
+			_debouncer.edge(pin_level, now_us);
+		}
+		// la nueva ventana se aplica a partir de la siguiente rafaga
+		if(bounce){
+			_debouncer.setup(PushButtonDebouncer::StableTime, bounce->getWindow());
+		}
+	}
+	// la rafaga resuelta verifica tambien la pulsacion notificada de forma inmediata, aunque no cambie el nivel
+	if(changed || (resolved && _lead_press)){
+		_burst = false;
+		notifyLevel(_debouncer.getStable(), _debouncer.getBurstStart());
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+bool PushButton::isDebouncePending(){
+	return (_endis_gfilt && _filt_mode != FilterTimer && _debouncer.isPending());
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::resolveTimeouts(uint32_t now_us){
+	Extension* ext = getExtension();
+	if(ext && (ext->storm_pending || ext->storm_masked)){
+		resolveStorm(now_us);
+	}
+	if(isDebouncePending()){
+		resolveDebounce(now_us);
+	}
+	if(ext && ext->gesture.isPending() && Extension::ConfigLatch::Reader(ext->cfg)->gestureCb){
+		ext->gesture.update(now_us);
+		notifyGestures();
+	}
+	// eventos hold sin timer: se programa el siguiente sin acumular el retraso de la activacion
+	if(_hold_armed && (int32_t)(now_us - _hold_next_us) >= 0){
+		// el evento aplica el periodo del escalon vigente del perfil
+		uint32_t due_us = _hold_next_us;
+		notifyHold();
+		_hold_next_us = due_us + _hold_period_us;
+		if((int32_t)(now_us - _hold_next_us) >= 0){
+			_hold_next_us = now_us + _hold_period_us;
+		}
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+uint32_t PushButton::getWaitTimeout(uint32_t now_us){
+	uint32_t remaining = PushButtonGesture::NoDeadline;
+	Extension* ext = getExtension();
+	if(ext && ext->gesture.isPending() && Extension::ConfigLatch::Reader(ext->cfg)->gestureCb){
+		remaining = ext->gesture.getRemaining(now_us);
+	}
+	if(_hold_armed){
+		uint32_t t = ((int32_t)(_hold_next_us - now_us) > 0)? (_hold_next_us - now_us) : 0;
+		remaining = (t < remaining)? t : remaining;
+	}
+	if(isDebouncePending()){
+		uint32_t t = _debouncer.getRemaining(now_us);
+		remaining = (t < remaining)? t : remaining;
+	}
+	// la tormenta detectada en la ISR se atiende de inmediato, y el enmascaramiento al vencer
+	if(ext && ext->storm_pending){
+		remaining = 0;
+	}
+	else if(ext && ext->storm_masked){
+		uint32_t t = ((int32_t)(ext->storm_until_us - now_us) > 0)? (ext->storm_until_us - now_us) : 0;
+		remaining = (t < remaining)? t : remaining;
+	}
+	if(remaining == PushButtonGesture::NoDeadline){
+		return osWaitForever;
+	}
+	return (remaining + 999) / 1000;
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::notifyGestures(){
+	PushButtonGesture::Gesture gesture;
+	uint8_t clicks;
+	Extension* ext = getExtension();
+	while(ext->gesture.poll(gesture, clicks)){
+		DEBUG_TRACE_D(_EXPR_, _MODULE_, "EV_GESTURE %d x%d", gesture, clicks);
+		raiseEvent(EventGesture, _level_ts_us, (uint8_t)gesture, clicks);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::raiseEvent(EventType type, uint32_t ts_us, uint8_t gesture, uint8_t clicks, uint32_t repeat, uint32_t held_ms){
+	// registro del evento, con una correspondencia explicita para que el formato de la traza no dependa del orden
+	// de EventType. Los escalones del perfil hold no se registran, ya que se deducen de los eventos hold
+	Extension* ext = getExtension();
+	if(ext && ext->trace){
+		PushButtonTrace::Kind kind;
+		bool traced = true;
+		switch(type){
+			case EventPress:	kind = PushButtonTrace::KindPress; break;
+			case EventHold:		kind = PushButtonTrace::KindHold; break;
+			case EventRelease:	kind = PushButtonTrace::KindRelease; break;
+			case EventGesture:	kind = PushButtonTrace::KindGesture; break;
+			case EventCancel:	kind = PushButtonTrace::KindCancel; break;
+			case EventStorm:	kind = PushButtonTrace::KindStorm; break;
+			default:			kind = PushButtonTrace::KindPress; traced = false; break;
+		}
+		if(traced){
+			ext->trace->record(kind, ((uint32_t)gesture << 8) | clicks);
+		}
+	}
+	Event ev;
+	ev.btn = this;
+	ev.id = _id;
+	ev.ts_us = ts_us;
+	ev.type = (uint8_t)type;
+	ev.gesture = gesture;
+	ev.clicks = clicks;
+	ev.repeat = repeat;
+	ev.held_ms = held_ms;
+	if(_queue){
+		if(!_queue->post(ev)){
+			DEBUG_TRACE_W(_EXPR_, _MODULE_, "ERR_QUEUE_FULL");
+		}
+		return;
+	}
+	deliverEvent(ev);
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::deliverEvent(const Event& ev){
+	_event_ts_us = ev.ts_us;
+	PUSHBUTTON_STATS(uint32_t cb_us = getTimeUs();)
+	// se copian las callbacks del evento y se libera la configuracion publicada antes de invocarlas, ya que pueden
+	// reconfigurar el pulsador (ver PushButtonLatch)
+	Callback<void(uint32_t)> idCb;
+	Callback<void()> voidCb;
+	Callback<void(uint32_t, uint32_t, uint32_t)> holdCb3;
+	Callback<void(uint32_t, uint8_t)> holdStepCb;
+	Callback<void(uint32_t, PushButtonGesture::Gesture, uint8_t)> gestureCb;
+	Callback<void(const Event&)> eventCb;
+	{
+		ConfigLatch::Reader cfg(_cfg);
+		switch(ev.type){
+			case EventPress:
+				idCb = cfg->pressCb;
+				break;
+			case EventHold:
+				idCb = cfg->holdCb;
+				break;
+			case EventRelease:
+				idCb = cfg->releaseCb;
+				break;
+		}
+	}
+	Extension* ext = getExtension();
+	if(ext){
+		Extension::ConfigLatch::Reader cfg(ext->cfg);
+		switch(ev.type){
+			case EventPress:
+				voidCb = cfg->pressCb2;
+				break;
+			case EventHold:
+				voidCb = cfg->holdCb2;
+				holdCb3 = cfg->holdCb3;
+				break;
+			case EventHoldStep:
+				holdStepCb = cfg->holdStepCb;
+				break;
+			case EventRelease:
+				voidCb = cfg->releaseCb2;
+				break;
+			case EventGesture:
+				gestureCb = cfg->gestureCb;
+				break;
+			case EventCancel:
+				idCb = cfg->cancelCb;
+				break;
+			case EventStorm:
+				idCb = cfg->stormCb;
+				break;
+		}
+		eventCb = cfg->eventCb;
+	}
+	if(idCb){
+		idCb.call(_id);
+	}
+	if(voidCb){
+		voidCb.call();
+	}
+	if(holdCb3){
+		holdCb3.call(_id, ev.repeat, ev.held_ms);
+	}
+	if(holdStepCb){
+		holdStepCb.call(_id, ev.clicks);
+	}
+	if(gestureCb){
+		gestureCb.call(_id, (PushButtonGesture::Gesture)ev.gesture, ev.clicks);
+	}
+	if(eventCb){
+		eventCb.call(ev);
+	}
+	PUSHBUTTON_STATS(_stats.callback.add(getTimeUs() - cb_us);)
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::pushEdge(uint8_t level){
+	EdgeRecord rec;
+	rec.ts_us = getTimeUs();
+	rec.slot = _slot;
+	rec.level = level;
+	Extension* ext = getExtension();
+	if(ext && ext->trace){
+		ext->trace->record((level)? PushButtonTrace::KindRise : PushButtonTrace::KindFall);
+	}
+	if(_mgr){
+		_mgr->notifyEdge(rec);
+		return;
+	}
+	// solo despierta al hilo si no tenia flancos pendientes
+	bool idle = _own->edges.empty();
+	if(_own->edges.push(rec) && idle){
+		_own->th->signal_set(EvEdge);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::isrEdge(uint8_t level){
+	Extension* ext = getExtension();
+	if(ext && ext->storm_max > 0){
+		uint32_t now = getTimeUs();
+		if((uint32_t)(now - ext->storm_win_us) >= ext->storm_window_us){
+			ext->storm_win_us = now;
+			ext->storm_edges = 0;
+		}
+		// tormenta: se enmascaran las ISR del pin y el hilo de despacho la atiende (ver resolveStorm)
+		if(++ext->storm_edges > ext->storm_max){
+			_iin->rise(NULL);
+			_iin->fall(NULL);
+			ext->storm_ts_us = now;
+			ext->storm_pending = true;
+			if(_mgr){
+				_mgr->wakeup();
 			}
 			else{
-				gpioFilterCallback();
+				_own->th->signal_set(EvEdge);
 			}
+			return;
 		}
 	}
+	pushEdge(level);
 }
 
 
+//------------------------------------------------------------------------------------
+void PushButton::resolveStorm(uint32_t now_us){
+	Extension* ext = getExtension();
+	if(ext->storm_pending){
+		// el enmascaramiento se duplica si la tormenta se repite antes de transcurrir otro completo
+		uint32_t backoff_us = ext->storm_base_us;
+		if(ext->storm_stats.storms > 0 && (uint32_t)(ext->storm_ts_us - ext->storm_unmask_us) < 1000 * ext->storm_stats.backoff_ms){
+			backoff_us = 2000 * ext->storm_stats.backoff_ms;
+			backoff_us = (backoff_us > (ext->storm_base_us << StormMaxBackoffShift))? (ext->storm_base_us << StormMaxBackoffShift) : backoff_us;
+		}
+		core_util_critical_section_enter();
+		ext->storm_pending = false;
+		ext->storm_masked = true;
+		ext->storm_until_us = ext->storm_ts_us + backoff_us;
+		ext->storm_stats.storms++;
+		ext->storm_stats.backoff_ms = backoff_us / 1000;
+		core_util_critical_section_exit();
+		DEBUG_TRACE_W(_EXPR_, _MODULE_, "ERR_STORM %dms", backoff_us / 1000);
+		raiseEvent(EventStorm, ext->storm_ts_us);
+
+		// la rafaga en curso se descarta, ya que el nivel del pin no puede conocerse hasta finalizar el
+		// enmascaramiento. Una pulsacion notificada de forma inmediata queda anulada
+		if(_mgr){
+			_mgr->stopTimer(&_filt_node);
+		}
+		else{
+			_own->tick_filt->stop();
+		}
+		if(_lead_press){
+			notifyLevel((uint8_t)!_stable_value, ext->storm_ts_us);
+		}
+		_burst = false;
+		_curr_value = _stable_value;
+		_debouncer.reset(_stable_value, now_us);
+		return;
+	}
+	if(!ext->storm_masked || (int32_t)(now_us - ext->storm_until_us) < 0){
+		return;
+	}
+
+	// fin del enmascaramiento: si el nivel del pin difiere del ultimo estable se entrega al filtro como un flanco,
+	// de forma que un cambio de nivel durante el enmascaramiento se filtra y notifica como cualquier otro
+	ext->storm_stats.masked_ms += (now_us - ext->storm_ts_us) / 1000;
+	ext->storm_unmask_us = now_us;
+	EdgeRecord rec;
+	rec.ts_us = now_us;
+	rec.slot = _slot;
+	rec.level = readPin();
+	if(rec.level != _curr_value){
+		processEdge(rec);
+		commitEdges();
+	}
+	core_util_critical_section_enter();
+	ext->storm_masked = false;
+	ext->storm_win_us = now_us;
+	ext->storm_edges = 0;
+	_iin->rise(callback(this, &PushButton::isrRiseCallback));
+	_iin->fall(callback(this, &PushButton::isrFallCallback));
+	core_util_critical_section_exit();
+}
+
 
 //------------------------------------------------------------------------------------
 void PushButton::isrRiseCallback(){
-	_iin->rise(NULL);
-	_iin->fall(NULL);
-	_th->signal_set(EvRise);
+	isrEdge(1);
 }
 
 
 //------------------------------------------------------------------------------------
 void PushButton::isrFallCallback(){
-	_iin->rise(NULL);
-	_iin->fall(NULL);
-	_th->signal_set(EvFall);
+	isrEdge(0);
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::filterTickCallback(){
+	_wakeups++;
+	_own->th->signal_set(EvFilter);
 }
 
 
 //------------------------------------------------------------------------------------
 void PushButton::holdTickCallback(){
+	_wakeups++;
+	_own->th->signal_set(EvHold);
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::resolveFilterTick(uint32_t now_us){
+	// la senal de un timer ya reiniciado o detenido se descarta: el timer vence como pronto un tick del RTOS antes
+	// del instante programado. Tampoco se atiende si no hay rafaga en curso, por haberla descartado una tormenta
+	// (ver resolveStorm) con la senal ya pendiente
+	if(!_burst || (int32_t)(_own->filt_due_us - now_us) > (int32_t)RtosTickUs){
+		return;
+	}
+	gpioFilterCallback();
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::resolveHoldTick(uint32_t now_us){
+	// la senal de un timer ya detenido o reiniciado por otra pulsacion se descarta
+	if(!_hold_running || (int32_t)(_hold_next_us - now_us) > (int32_t)RtosTickUs){
+		return;
+	}
+	// el timer RTOS solo se reinicia desde el instante actual: si se inicio con el retardo inicial o con un intervalo
+	// de ajuste, se restablece el periodo antes de notificar, y si el perfil cambia el periodo, el primer intervalo
+	// se acorta con el tiempo consumido por las callbacks, de forma que el siguiente evento queda a un periodo del
+	// vencimiento nominal de este
+	uint32_t due_us = _hold_next_us;
+	uint32_t period_us = _hold_period_us;
+	if(1000 * _own->hold_tick_ms != period_us){
+		_own->hold_tick_ms = period_us / 1000;
+		_own->tick_hold->start(_own->hold_tick_ms);
+	}
+	notifyHold();
+	if(!_hold_running){
+		return;
+	}
+	uint32_t now = getTimeUs();
+	_hold_next_us = due_us + _hold_period_us;
+	if((int32_t)(now - _hold_next_us) >= 0){
+		_hold_next_us = now + _hold_period_us;
+	}
+	if(_hold_period_us != period_us){
+		_own->hold_tick_ms = (_hold_next_us - now + 999) / 1000;
+		_own->tick_hold->start(_own->hold_tick_ms);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::notifyHold(){
+	// timer hold iniciado antes de deshabilitar los eventos hold: se detiene sin notificar. El perfil se copia, ya
+	// que las callbacks pueden reconfigurar el pulsador
+	uint32_t hold_us, period_us;
+	HoldProfile hold;
+	{
+		ConfigLatch::Reader cfg(_cfg);
+		hold_us = cfg->hold_us;
+		period_us = cfg->hold_period_us;
+	}
+	Extension* ext = getExtension();
+	if(ext){
+		hold = Extension::ConfigLatch::Reader(ext->cfg)->hold;
+	}
+	if(hold_us == 0){
+		stopHold();
+		return;
+	}
+	uint32_t now = getTimeUs();
+	uint32_t held_ms = (now - _level_ts_us) / 1000;
+	_hold_repeat++;
+	_state.holds = _hold_repeat;
+	publishState();
+
+	// perfil de aceleracion: escalones alcanzados por el tiempo pulsado
+	while(_hold_step < hold.steps && held_ms >= hold.step[_hold_step].after_ms){
+		_hold_step++;
+		DEBUG_TRACE_D(_EXPR_, _MODULE_, "EV_HOLD_STEP %d", _hold_step);
+		raiseEvent(EventHoldStep, _level_ts_us, 0, _hold_step);
+	}
 	DEBUG_TRACE_D(_EXPR_, _MODULE_, "EV_HOLD");
-	if(_holdCb){
-		_holdCb.call(_id);
+	PUSHBUTTON_STATS(_stats.hold_ticks++;)
+	raiseEvent(EventHold, _level_ts_us, 0, 0, _hold_repeat, held_ms);
+	if(_mgr){
+		_mgr->notifyHold(_slot, now);
 	}
-	if(_holdCb2){
-		_holdCb2.call();
+	setHoldPeriod((_hold_step > 0)? (1000 * hold.step[_hold_step - 1].period_ms) : period_us);
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::publishState(){
+	_state_pub.write(_state);
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::startFilterTimer(){
+	if(_mgr){
+		_mgr->startTimer(&_filt_node, _filter_timeout_us, 0);
+		return;
+	}
+	_own->filt_due_us = getTimeUs() + 1000 * (_filter_timeout_us/1000);
+	_own->tick_filt->start(_filter_timeout_us/1000);
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::startHoldTimer(uint32_t delay_us, uint32_t period_us){
+	// el timer RTOS se inicia con el retardo como periodo, que se sustituye en el primer evento (ver resolveHoldTick)
+	if(_mgr){
+		_mgr->startTimer(&_hold_node, delay_us, period_us);
+	}
+	else{
+		_own->hold_tick_ms = delay_us/1000;
+		_hold_next_us = getTimeUs() + 1000 * _own->hold_tick_ms;
+		_own->tick_hold->start(_own->hold_tick_ms);
+	}
+	_hold_period_us = period_us;
+	_hold_running = true;
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::setHoldPeriod(uint32_t period_us){
+	if(period_us == _hold_period_us){
+		return;
+	}
+	// en bajo consumo y con timer RTOS el periodo se aplica al calcular el siguiente vencimiento (ver
+	// resolveTimeouts y resolveHoldTick); la rueda desplaza el siguiente vencimiento sin detener el timer
+	_hold_period_us = period_us;
+	if(_hold_running && _mgr){
+		_mgr->setTimerPeriod(&_hold_node, period_us);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::timerExpired(PushButtonTimerWheel::Node* node){
+	// se ejecuta en el hilo del gestor, que ya contabiliza la activacion
+	if(node == &_filt_node){
+		gpioFilterCallback();
+	}
+	else if(node == &_hold_node && _hold_running){
+		notifyHold();
 	}
 }
 
 
+//------------------------------------------------------------------------------------
+void PushButton::stopHold(){
+	if(_hold_running && _mgr){
+		_mgr->stopTimer(&_hold_node);
+	}
+	else if(_hold_running){
+		_own->tick_hold->stop();
+	}
+	_hold_running = false;
+	_hold_armed = false;
+}
+
+
 //------------------------------------------------------------------------------------
 void PushButton::gpioFilterCallback(){
 	// leo valor del pin
-    uint8_t pin_level = (uint8_t)_iin->read();
+    uint8_t pin_level = readPin();
 
-	// En caso de glitch, descarto y vuelvo a habilitar interrupciones
+	// En caso de glitch (flanco en curso o descartado por desbordamiento), vuelvo a verificar el nivel
 	if(_curr_value != pin_level){
 		DEBUG_TRACE_W(_EXPR_, _MODULE_, "ERR_NOISE");
-		enableRiseFallCallbacks();
+		PUSHBUTTON_STATS(_stats.noise_errors++;)
+		_curr_value = pin_level;
+		if(_endis_gfilt){
+			startFilterTimer();
+		}
         return;
 	}
 
+	_burst = false;
+	notifyLevel(pin_level, _burst_ts_us);
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButton::notifyLevel(uint8_t pin_level, uint32_t ts_us){
+	// verificacion de la pulsacion notificada de forma inmediata: si el nivel no se ha mantenido, se anula
+	if(_lead_press){
+		_lead_press = false;
+		if(pin_level != _stable_value){
+			DEBUG_TRACE_D(_EXPR_, _MODULE_, "EV_CANCEL");
+			_stable_value = pin_level;
+			_level_ts_us = ts_us;
+			stopHold();
+			if(getExtension()){
+				getExtension()->gesture.reset();
+			}
+			_state.pressed = false;
+			_state.releases++;
+			publishState();
+			raiseEvent(EventCancel, ts_us);
+			if(_mgr){
+				_mgr->notifyButton(_slot, false, ts_us);
+			}
+		}
+		return;
+	}
+	// Si el nivel vuelve al ultimo estable, la rafaga era un rebote y no genera eventos
+	if(pin_level == _stable_value){
+		return;
+	}
+	_stable_value = pin_level;
+	_level_ts_us = ts_us;
+
 	// En caso de evento RELEASE
 	if((pin_level == 1 && _level == PressIsLowLevel) || (pin_level == 0 && _level == PressIsHighLevel)){
 		DEBUG_TRACE_D(_EXPR_, _MODULE_, "EV_RELEASE");
-		if(_hold_running){
-			_tick_hold->stop();
-			_hold_running = false;
-		}
-		if(_releaseCb){
-			_releaseCb.call(_id);
+		stopHold();
+		_state.pressed = false;
+		_state.releases++;
+		publishState();
+		raiseEvent(EventRelease, ts_us);
+		if(_mgr){
+			_mgr->notifyButton(_slot, false, ts_us);
 		}
-		if(_releaseCb2){
-			_releaseCb2.call();
+		Extension* ext = getExtension();
+		if(ext && Extension::ConfigLatch::Reader(ext->cfg)->gestureCb){
+			ext->gesture.release(ts_us);
+			notifyGestures();
 		}
-		enableRiseFallCallbacks();
 		return;
 	}
 
@@ -270,43 +1500,67 @@ void PushButton::gpioFilterCallback(){
     if((pin_level == 1 && _level == PressIsHighLevel) || (pin_level == 0 && _level == PressIsLowLevel)){
     	DEBUG_TRACE_D(_EXPR_, _MODULE_, "EV_PRESS");
     	// si el timming para eventos hold est� configurado, primero lo detiene y luego lo inicia
-		if(_hold_running){
-			_tick_hold->stop();
-			_hold_running = false;
+		stopHold();
+		// configuracion copiada, ya que las callbacks del evento pueden reconfigurar el pulsador
+		uint32_t hold_us, period_us;
+		{
+			ConfigLatch::Reader cfg(_cfg);
+			hold_us = cfg->hold_us;
+			period_us = cfg->hold_period_us;
 		}
-        if(_hold_us > 0){
-        	_tick_hold->start(_hold_us/1000);
-        	_hold_running = true;
+		Extension* ext = getExtension();
+		bool gestures = (ext && Extension::ConfigLatch::Reader(ext->cfg)->gestureCb);
+		_hold_repeat = 0;
+		_hold_step = 0;
+		_state.pressed = true;
+		_state.press_ts_us = ts_us;
+		_state.presses++;
+		_state.holds = 0;
+		publishState();
+        if(hold_us > 0 && _low_power){
+        	_hold_next_us = ts_us + hold_us;
+        	_hold_period_us = period_us;
+        	_hold_armed = true;
         }
-        if(_pressCb){
-        	_pressCb.call(_id);
+        else if(hold_us > 0){
+        	startHoldTimer(hold_us, period_us);
         }
-        if(_pressCb2){
-        	_pressCb2.call();
+        raiseEvent(EventPress, ts_us);
+        if(_mgr){
+        	_mgr->notifyButton(_slot, true, ts_us);
+        }
+        if(gestures){
+        	ext->gesture.press(ts_us);
+        	notifyGestures();
         }
-        enableRiseFallCallbacks();
         return;
     }
 
     // No deber�a llegar a este punto nunca, pero por si acaso, reasigna isr's
     DEBUG_TRACE_W(_EXPR_, _MODULE_, "ERR_LEVEL");
-	if(_hold_running){
-		_tick_hold->stop();
-		_hold_running = false;
-	}
+    PUSHBUTTON_STATS(_stats.level_errors++;)
+	stopHold();
+	_curr_value = readPin();
+	_stable_value = _curr_value;
+	_debouncer.reset(_curr_value, getTimeUs());
     enableRiseFallCallbacks();
 }
 
 
 //------------------------------------------------------------------------------------
 void PushButton::enableRiseFallCallbacks(){
-	if((_curr_value = _iin->read())){
-		_iin->rise(NULL);
-		_iin->fall(callback(this, &PushButton::isrFallCallback));
+	// ambos flancos quedan habilitados para capturar la secuencia completa con sus marcas de tiempo. Se invoca
+	// desde el hilo de la aplicacion, por lo que no modifica el estado del filtrado, que pertenece al hilo de
+	// despacho: el nivel de partida se toma en la construccion y un cambio previo a la habilitacion se recupera
+	// al verificar el pin tras la siguiente rafaga
+	if(_smp){
+		_smp->attach(this, _input);
 	}
-	else{
-		_iin->fall(NULL);
+	// con las ISR enmascaradas por una tormenta, se habilitan al finalizar el enmascaramiento
+	Extension* ext = getExtension();
+	if(_iin && !(ext && (ext->storm_masked || ext->storm_pending))){
 		_iin->rise(callback(this, &PushButton::isrRiseCallback));
+		_iin->fall(callback(this, &PushButton::isrFallCallback));
 	}
 }
 
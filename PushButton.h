@@ -15,26 +15,150 @@
 #define __PushButton__H
 
 #include "mbed.h"
+#include <new>
+#include <atomic>
 #if __MBED__==1
 #include "mdf_api_cortex.h"
 #endif
+#include "PushButtonRing.h"
+#include "PushButtonDebouncer.h"
+#include "PushButtonBounceEstimator.h"
+#include "PushButtonStats.h"
+#include "PushButtonGesture.h"
+#include "PushButtonTimerWheel.h"
+#include "PushButtonLatch.h"
+#include "PushButtonSeqLock.h"
 
 
-   
+class PushButtonManager;
+class PushButtonEventQueue;
+class PushButtonTrace;
+class PushButtonSampler;
+
 class PushButton {
   public:
-	static const uint32_t GlitchFilterTimeoutUs = 500000;    /// Por defecto 20ms de timeout antiglitch desde el cambio de nivel
+	static const uint32_t GlitchFilterTimeoutUs = 500000;    /// Por defecto 500ms de timeout antiglitch desde el cambio de nivel (maximo en FilterAdaptive)
 
     enum LogicLevel{
         PressIsLowLevel,
         PressIsHighLevel
     };
+
+    /** Motor de filtrado anti-glitch */
+    enum FilterMode{
+        FilterTimer,                        /// Reinicia un RtosTimer en cada lote de flancos (por defecto)
+        FilterStableTime,                   /// Sin timer: nivel estable tras filter_us sin flancos
+        FilterIntegrator,                   /// Sin timer: integrador de filter_us de recorrido
+        FilterAdaptive                      /// Sin timer: tiempo estable con la ventana aprendida del rebote (maximo filter_us)
+    };
+
+    /** Registro de flanco capturado en la ISR */
+    struct EdgeRecord{
+        uint32_t ts_us;                     /// Instante del flanco (us)
+        uint8_t slot;                       /// Slot del pulsador en el gestor (0 en modo independiente)
+        uint8_t level;                      /// Nivel del pin tras el flanco
+    };
+
+    static const uint32_t EdgeQueueSize = 16;   /// Capacidad del buffer de flancos en modo independiente
+
+    /** Tipos de evento */
+    enum EventType{
+        EventPress,
+        EventHold,
+        EventRelease,
+        EventGesture,
+        EventCancel,
+        EventStorm,
+        EventHoldStep
+    };
+
+    /** Estado del pulsador para su consulta sin callbacks (ver getState). Los contadores no se reinician: las
+     *  pulsaciones desde la ultima consulta son la diferencia con el valor obtenido en ella
+     */
+    struct State{
+        uint32_t press_ts_us;               /// Instante del primer flanco de la ultima pulsacion
+        uint32_t presses;                   /// Pulsaciones notificadas
+        uint32_t releases;                  /// Liberaciones notificadas (incluidas las anulaciones de pulsaciones inmediatas)
+        uint32_t holds;                     /// Eventos hold de la pulsacion en curso o de la ultima
+        bool pressed;                       /// Pulsador pulsado
+    };
+
+    static const uint32_t MaxHoldSteps = 4;	/// Escalones maximos de un perfil de eventos hold
+
+    /** Perfil de aceleracion de los eventos hold (auto-repeticion). El primer evento hold se notifica tras delay_ms
+     *  y los siguientes cada period_ms. Cada escalon reduce el periodo a partir del primer evento hold en el que el
+     *  tiempo pulsado (desde el primer flanco de la pulsacion) alcanza after_ms, y se notifica con EventHoldStep
+     */
+    struct HoldProfile{
+        struct Step{
+            uint32_t after_ms;              /// Tiempo pulsado a partir del que se aplica el escalon
+            uint32_t period_ms;             /// Periodo de los eventos hold del escalon
+        };
+        uint32_t delay_ms;                  /// Retardo del primer evento hold
+        uint32_t period_ms;                 /// Periodo inicial de los eventos hold
+        uint8_t steps;                      /// Escalones configurados, en orden creciente de after_ms
+        Step step[MaxHoldSteps];            /// Escalones
+        HoldProfile() : delay_ms(0), period_ms(0), steps(0) {}
+    };
+
+    /** Estado de la proteccion frente a tormentas de interrupciones (ver setStormProtection) */
+    struct StormStats{
+        uint32_t storms;                    /// Tormentas detectadas
+        uint32_t masked_ms;                 /// Tiempo total con las ISR enmascaradas (tormentas finalizadas)
+        uint32_t backoff_ms;                /// Enmascaramiento aplicado en la ultima tormenta
+        bool masked;                        /// ISR enmascaradas en este momento
+    };
+
+    static const uint32_t StormMaxBackoffShift = 5;	/// El enmascaramiento se duplica como maximo hasta 32 veces el inicial
+
+    /** Almacenamiento de las funciones opcionales de un pulsador (ver setExtensionStorage) */
+    struct ExtensionStorage;
+
+    /** Registro de evento para su entrega diferida a traves de PushButtonEventQueue */
+    struct Event{
+        PushButton* btn;                    /// Pulsador que lo genera (NULL si se ha descartado)
+        uint32_t id;                        /// Identificador del pulsador
+        uint32_t ts_us;                     /// Instante del primer flanco que lo origino
+        uint8_t type;                       /// Tipo de evento (EventType)
+        uint8_t gesture;                    /// Gesto reconocido (EventGesture)
+        uint8_t clicks;                     /// Pulsaciones cortas del gesto (EventGesture) o escalon (EventHoldStep)
+        uint32_t repeat;                    /// Numero de evento hold desde la pulsacion (EventHold)
+        uint32_t held_ms;                   /// Tiempo pulsado (EventHold)
+    };
     
 	/** Constructor y Destructor por defecto */
     PushButton(PinName32 btn, uint32_t id, LogicLevel level, PinMode mode, uint32_t filter_us = GlitchFilterTimeoutUs, bool defdbg = false);
     ~PushButton();
+
+	/** Constructor en modo grupo. El pulsador no crea hilo propio, sino que se registra en el gestor
+	 *  indicado, cuyo hilo procesa los eventos de todos los pulsadores del grupo. En este modo el pulsador
+	 *  no reserva memoria dinamica (ver PushButtonPool).
+	 *  @param mgr Gestor al que se asocia el pulsador
+	 */
+    PushButton(PushButtonManager* mgr, PinName32 btn, uint32_t id, LogicLevel level, PinMode mode, uint32_t filter_us = GlitchFilterTimeoutUs, bool defdbg = false);
+
+	/** Constructor para entradas muestreadas (pines sin interrupcion o entradas de un expansor GPIO). El pulsador
+	 *  no utiliza InterruptIn, sino que recibe los cambios de nivel de su entrada desde el muestreador compartido
+	 *  (ver PushButtonSampler), con su propio hilo o en el gestor indicado.
+	 *  @param smp Muestreador
+	 *  @param input Entrada del muestreador
+	 *  @param mgr Gestor al que se asocia el pulsador (NULL para crear hilo propio)
+	 */
+    PushButton(PushButtonSampler* smp, uint8_t input, uint32_t id, LogicLevel level, uint32_t filter_us = GlitchFilterTimeoutUs,
+    		   PushButtonManager* mgr = NULL, bool defdbg = false);
   
   
+	/** setExtensionStorage
+     *  Asigna el almacenamiento de las funciones opcionales del pulsador: callbacks void, perfiles hold, gestos,
+     *  anulaciones, tormentas, callback de todos los eventos, filtrado adaptativo y trazas. Un pulsador que no
+     *  las utiliza no lo requiere, de forma que su tamanio se limita al de las funciones basicas. Si no se asigna,
+     *  se reserva en memoria dinamica al habilitar la primera funcion opcional. Debe invocarse antes de
+     *  habilitarlas (ver PushButtonPool para crear pulsadores con funciones opcionales sin memoria dinamica)
+     *  @param storage Almacenamiento, que debe mantenerse mientras exista el pulsador
+     */
+    void setExtensionStorage(ExtensionStorage* storage);
+
+
 	/** Instala callback para procesar los eventos de pulsacin. La callback
 	 *  se ejecutar en contexto de tarea
      *  @param pressCb Callback a instalar
@@ -51,6 +175,31 @@ class PushButton {
     void enableHoldEvents(Callback<void(uint32_t)>holdCb, uint32_t millis);
     void enableHoldEvents(Callback<void()>holdCb, uint32_t millis);
 
+
+	/** Instala callback para procesar los eventos de mantenimiento con un perfil de aceleracion (auto-repeticion
+	 *  que se acelera con el tiempo pulsado). La callback se ejecutara en contexto de tarea y recibe el
+	 *  identificador, el numero de evento hold desde la pulsacion (1, 2...) y el tiempo pulsado en milisegundos.
+	 *  El perfil se aplica tambien a las callbacks hold instaladas con un periodo fijo. Los cambios de periodo
+	 *  reprograman el vencimiento en curso, sin detener ni reiniciar el timer en cada evento
+     *  @param holdCb Callback a instalar
+     *  @param profile Perfil de aceleracion
+     */
+    void enableHoldEvents(Callback<void(uint32_t, uint32_t, uint32_t)>holdCb, const HoldProfile& profile);
+
+
+	/** enableHoldStepEvents
+     *  Instala callback para procesar los escalones alcanzados del perfil de eventos hold. La callback se
+     *  ejecutara en contexto de tarea, antes del evento hold del escalon, y recibe el identificador y el
+     *  escalon alcanzado (1, 2...)
+     *  @param stepCb Callback a instalar
+     */
+    void enableHoldStepEvents(Callback<void(uint32_t, uint8_t)>stepCb);
+
+	/** disableHoldStepEvents
+     *  Desinstala callback para procesar los escalones del perfil de eventos hold
+     */
+    void disableHoldStepEvents();
+
     
 	/** Instala callback para procesar los eventos de liberacin. La callback
 	 *  se ejecutar en contexto de tarea
@@ -66,7 +215,8 @@ class PushButton {
     void disablePressEvents();
   
 	/** disableHoldEvents
-     *  Desinstala callback para procesar los eventos de mantenimiento
+     *  Desinstala callback para procesar los eventos de mantenimiento. El hilo de despacho detiene los eventos
+     *  hold en curso
      */
     void disableHoldEvents();
   
@@ -75,6 +225,62 @@ class PushButton {
      */
     void disableReleaseEvents();
 
+
+	/** enableGestureEvents
+     *  Instala callback para procesar los gestos reconocidos (click, doble click, pulsacion larga...). La
+     *  callback se ejecutara en contexto de tarea y recibe el identificador, el gesto y el numero de
+     *  pulsaciones cortas de la secuencia
+     *  @param gestureCb Callback a instalar
+     *  @param cfg Ventanas de reconocimiento
+     */
+    void enableGestureEvents(Callback<void(uint32_t, PushButtonGesture::Gesture, uint8_t)>gestureCb,
+    						 const PushButtonGesture::Config& cfg = PushButtonGesture::Config());
+
+	/** disableGestureEvents
+     *  Desinstala callback para procesar los gestos reconocidos
+     */
+    void disableGestureEvents();
+
+
+	/** enableCancelEvents
+     *  Instala callback para procesar la anulacion de una pulsacion notificada de forma inmediata cuyo nivel no
+     *  llega a estabilizarse (ver setLeadingEdgeMode). La callback se ejecutara en contexto de tarea
+     *  @param cancelCb Callback a instalar
+     */
+    void enableCancelEvents(Callback<void(uint32_t)>cancelCb);
+
+	/** disableCancelEvents
+     *  Desinstala callback para procesar la anulacion de pulsaciones
+     */
+    void disableCancelEvents();
+
+
+	/** enableEventCallback
+     *  Instala callback para procesar todos los eventos del pulsador en una sola callback (p.ej. para reanudar
+     *  las corrutinas en espera, ver PushButtonAwait.h). La callback se ejecutara en contexto de tarea, tras las
+     *  callbacks especificas de cada evento, y recibe el registro completo del evento
+     *  @param eventCb Callback a instalar
+     */
+    void enableEventCallback(Callback<void(const Event&)>eventCb);
+
+	/** disableEventCallback
+     *  Desinstala callback para procesar todos los eventos
+     */
+    void disableEventCallback();
+
+
+	/** enableStormEvents
+     *  Instala callback para procesar las tormentas de interrupciones detectadas (ver setStormProtection). La
+     *  callback se ejecutara en contexto de tarea
+     *  @param stormCb Callback a instalar
+     */
+    void enableStormEvents(Callback<void(uint32_t)>stormCb);
+
+	/** disableStormEvents
+     *  Desinstala callback para procesar las tormentas de interrupciones
+     */
+    void disableStormEvents();
+
     /** Habilita el filtro anti-glitch
      *
      */
@@ -87,31 +293,395 @@ class PushButton {
     void disableGlitchFilter() { _endis_gfilt = false; }
 
 
+	/** setEventQueue
+     *  Selecciona la entrega diferida de eventos. En lugar de invocar las callbacks desde el hilo de despacho
+     *  (propio o del gestor), cada evento se inserta en la cola indicada y las callbacks se invocan
+     *  desde el hilo de la aplicacion que ejecute PushButtonEventQueue::dispatch(), de forma que su coste no
+     *  retrasa el filtrado de los flancos. La cola puede compartirse entre varios pulsadores.
+     *  @param queue Cola de eventos o NULL para volver a la entrega directa
+     */
+    void setEventQueue(PushButtonEventQueue* queue) { _queue = queue; }
+
+
+	/** setTraceRecorder
+     *  Registra los flancos y los eventos del pulsador en el registrador indicado (ver PushButtonTrace), para
+     *  reproducirlos en host. La traza incluye la configuracion vigente, por lo que debe instalarse tras
+     *  configurar el pulsador. Cada pulsador requiere su propio registrador.
+     *  @param trace Registrador o NULL para dejar de registrar
+     */
+    void setTraceRecorder(PushButtonTrace* trace);
+
+
+	/** setFilterMode
+     *  Selecciona el motor de filtrado anti-glitch. Los modos sin timer deducen el nivel estable de las
+     *  marcas de tiempo de los flancos, por lo que no utilizan el servicio de timers del RTOS por flanco.
+     *  El cambio se publica y lo aplica el hilo de despacho, que descarta la rafaga en curso.
+     *  @param mode Motor de filtrado
+     */
+    void setFilterMode(FilterMode mode);
+
+
+	/** setAdaptiveFilter
+     *  Selecciona el filtrado adaptativo (FilterAdaptive), que mide el rebote real del contacto a partir de las
+     *  marcas de tiempo de los flancos y reduce la ventana de filtrado, y con ella la latencia de los eventos,
+     *  hasta la minima segura (ver PushButtonBounceEstimator). Reinicia el aprendizaje en el hilo de despacho.
+     *  @param cfg Parametros del aprendizaje
+     */
+    void setAdaptiveFilter(const PushButtonBounceEstimator::Config& cfg = PushButtonBounceEstimator::Config());
+
+
+	/** getBounceStats
+     *  Obtiene las medidas del rebote del contacto y la ventana aplicada por el filtrado adaptativo
+     *  @param stats Recibe las estadisticas
+     */
+    void getBounceStats(PushButtonBounceEstimator::Stats& stats);
+
+
+	/** setLowPowerMode
+     *  Activa el modo de bajo consumo (tickless). Selecciona el filtrado sin timer (si estaba seleccionado el
+     *  filtrado por timer) y calcula los eventos hold desde la marca de tiempo de la pulsacion, programando
+     *  unicamente el siguiente vencimiento como timeout de espera del hilo de despacho, que en modo grupo es
+     *  compartido por todos los pulsadores. Un pulsador en reposo no genera actividad de timers ni del hilo.
+     *  El hilo de despacho aplica el cambio, y el evento hold en curso continua con el nuevo mecanismo.
+     *  @param enable true para activar, false para volver al timer periodico de eventos hold
+     */
+    void setLowPowerMode(bool enable);
+
+
+	/** setLeadingEdgeMode
+     *  Activa la notificacion inmediata de las pulsaciones. El evento press se notifica al procesar el primer
+     *  flanco de una rafaga hacia el nivel de pulsacion, sin esperar al filtro anti-glitch, que continua en curso
+     *  e ignora los flancos siguientes hasta que el nivel se estabiliza. Si el nivel estable no es el de
+     *  pulsacion, en lugar del evento release se notifica la anulacion (ver enableCancelEvents), se detienen los
+     *  eventos hold y se descarta la secuencia de gestos en curso; en modo grupo la anulacion se refleja como una
+     *  liberacion en la mascara de pulsados, los acordes y los lotes. Las liberaciones se notifican tras el filtrado.
+     *  @param enable true para activar, false para notificar las pulsaciones tras el filtrado (por defecto)
+     */
+    void setLeadingEdgeMode(bool enable) { _leading = enable; }
+
+
+	/** setStormProtection
+     *  Activa la proteccion frente a tormentas de interrupciones (contacto defectuoso, EMI). Las ISR contabilizan
+     *  los flancos del pin en ventanas de window_ms; si en una ventana se superan max_edges, se enmascaran las ISR
+     *  del pin y se notifica el evento storm. Transcurrido el enmascaramiento, el hilo de despacho lee el pin,
+     *  entrega su nivel al filtro anti-glitch como un flanco y vuelve a habilitar las ISR. Si la tormenta se repite
+     *  antes de transcurrir otro enmascaramiento completo, este se duplica (hasta 2^StormMaxBackoffShift veces
+     *  backoff_ms). El coste de un pin defectuoso queda acotado a max_edges ISR y una activacion del hilo por
+     *  enmascaramiento. Sin efecto en entradas muestreadas, cuyo coste ya depende solo del periodo de muestreo.
+     *  @param max_edges Flancos maximos por ventana (0 desactiva la proteccion)
+     *  @param window_ms Ventana de contabilizacion
+     *  @param backoff_ms Enmascaramiento inicial
+     */
+    void setStormProtection(uint32_t max_edges, uint32_t window_ms = 10, uint32_t backoff_ms = 100);
+
+
+	/** getStormStats
+     *  Obtiene los contadores de la proteccion frente a tormentas de interrupciones
+     *  @param stats Recibe los contadores
+     */
+    void getStormStats(StormStats& stats);
+
+
+	/** enableStateTracking
+     *  Habilita la captura de flancos sin instalar callbacks, para consultar unicamente el estado del pulsador
+     *  con getState. Con callbacks instaladas no es necesario
+     */
+    void enableStateTracking() { enableRiseFallCallbacks(); }
+
+
+	/** getState
+     *  Obtiene una copia coherente del estado del pulsador, sin bloqueos ni secciones criticas (ver
+     *  PushButtonSeqLock), por lo que puede consultarse desde cualquier hilo con un coste de unas pocas lecturas
+     *  @param state Recibe el estado
+     */
+    void getState(State& state) const { _state_pub.read(state); }
+
+
+	/** isPressed
+     *  Comprueba si el pulsador esta pulsado (ultimo nivel estable notificado)
+     *  @return true si esta pulsado
+     */
+    bool isPressed() const { State st; _state_pub.read(st); return st.pressed; }
+
+
+	/** getPressedMask
+     *  Obtiene el conjunto de pulsadores pulsados de un grupo de pulsadores independientes o de distintos
+     *  gestores (en un gestor, ver PushButtonManager::getPressedMask)
+     *  @param btns Pulsadores (bit i = btns[i])
+     *  @param count Numero de pulsadores (maximo 32)
+     *  @return Mascara de pulsadores pulsados
+     */
+    static uint32_t getPressedMask(PushButton* const btns[], uint32_t count);
+
+
+	/** getWakeupCount
+     *  Obtiene el numero de activaciones del hilo propio y de los timers del pulsador, para comparar el coste
+     *  en consumo de cada modo de funcionamiento
+     *  @return Activaciones
+     */
+    uint32_t getWakeupCount() { return _wakeups; }
+
+
+	/** getFilterMode
+     *  Obtiene el motor de filtrado anti-glitch seleccionado
+     *  @return Motor de filtrado
+     */
+    FilterMode getFilterMode() { return ConfigLatch::Reader(_cfg)->filt_mode; }
+
+
+	/** getEventTimestamp
+     *  Obtiene el instante del primer flanco que origino el ultimo evento notificado. Invocado desde
+     *  una callback, permite conocer el instante exacto de la pulsacion o liberacion.
+     *  @return Instante en microsegundos
+     */
+    uint32_t getEventTimestamp() { return _event_ts_us; }
+
+
+	/** getEdgeOverflowCount
+     *  Obtiene el numero de flancos descartados por desbordamiento del buffer de flancos
+     *  @return Flancos descartados
+     */
+    uint32_t getEdgeOverflowCount();
+
+
+	/** getTimeUs
+     *  Lee el contador de microsegundos utilizado para marcar los flancos
+     *  @return Microsegundos
+     */
+    static uint32_t getTimeUs();
+
+
+	/** getStats
+     *  Obtiene una instantanea de la instrumentacion de latencias y errores. Requiere compilar con
+     *  ENABLE_PUSHBUTTON_STATS
+     *  @param snap Recibe la instantanea
+     *  @return true si la instrumentacion esta compilada, false en caso contrario
+     */
+    bool getStats(PushButtonStats::Snapshot& snap);
+
+
+	/** resetStats
+     *  Reinicia la instrumentacion de latencias y errores
+     */
+    void resetStats();
+
+
   private:
+    friend class PushButtonManager;
+    friend class PushButtonEventQueue;
+    friend class PushButtonSampler;
 
     /** Eventos de teclado */
-    static const uint32_t EvRise 	= (1<<0);
-    static const uint32_t EvFall 	= (1<<1);
+    static const uint32_t EvEdge 	= (1<<0);
+    static const uint32_t EvFilter 	= (1<<1);	/// Vencimiento del timer del filtro (modo independiente)
+    static const uint32_t EvHold 	= (1<<2);	/// Vencimiento del timer de eventos hold (modo independiente)
+    static const uint32_t EvConfig 	= (1<<3);	/// Cambios de configuracion pendientes (modo independiente)
+
+    /** Cambios de configuracion que aplica el hilo de despacho (ver applyRequests) */
+    static const uint32_t ReqGesture 	= (1<<0);	/// Reinicia el reconocedor de gestos
+    static const uint32_t ReqHold 		= (1<<1);	/// Detiene los eventos hold en curso si se han desinstalado
+    static const uint32_t ReqFilter 	= (1<<2);	/// Aplica el motor de filtrado publicado
+    static const uint32_t ReqBounce 	= (1<<3);	/// Reinicia el aprendizaje del rebote
+    static const uint32_t ReqLowPower 	= (1<<4);	/// Aplica el modo de bajo consumo publicado
+
+    static const uint32_t RtosTickUs = 1000;	/// Resolucion de los timers RTOS
+
+    /** Callbacks basicas instaladas, periodo de los eventos hold y parametros que aplica el hilo de despacho. Se
+     *  publican completas (ver PushButtonLatch), de forma que el hilo de despacho nunca invoca una configuracion a
+     *  medio actualizar. Los lectores copian lo que necesitan y liberan la configuracion antes de invocar las
+     *  callbacks, por lo que bastan dos copias
+     */
+    struct Config {
+        Callback<void(uint32_t)> pressCb;      /// Callback para notificar eventos de pulsacin
+        Callback<void(uint32_t)> holdCb;       /// Callback para notificar eventos de mantenimiento
+        Callback<void(uint32_t)> releaseCb;    /// Callback para notificar eventos de liberacin
+        uint32_t hold_us;                      /// Microsegundos hasta el primer evento hold (0: sin eventos hold)
+        uint32_t hold_period_us;               /// Periodo inicial de los eventos hold
+        FilterMode filt_mode;                  /// Motor de filtrado anti-glitch
+        bool low_power;                        /// Modo de bajo consumo
+        Config() : hold_us(0), hold_period_us(0), filt_mode(FilterTimer), low_power(false) {}
+    };
+    typedef PushButtonLatch<Config, 2> ConfigLatch;
+
+    /** Estado de las funciones opcionales (ver setExtensionStorage). Sus callbacks y parametros se publican como
+     *  la configuracion basica y, al habilitar una funcion, se publican antes que esta, de forma que el hilo de
+     *  despacho nunca observa la configuracion basica nueva con la opcional anterior
+     */
+    struct Extension {
+        struct Config {
+            Callback<void()> pressCb2;         /// Callback para notificar eventos de pulsacin
+            Callback<void()> holdCb2;          /// Callback para notificar eventos de mantenimiento
+            Callback<void()> releaseCb2;       /// Callback para notificar eventos de liberacin
+            Callback<void(uint32_t, uint32_t, uint32_t)> holdCb3;	/// Callback para notificar eventos de mantenimiento con perfil
+            Callback<void(uint32_t, uint8_t)> holdStepCb;	/// Callback para notificar escalones del perfil hold
+            Callback<void(uint32_t, PushButtonGesture::Gesture, uint8_t)> gestureCb;	/// Callback para notificar gestos
+            Callback<void(uint32_t)> cancelCb; /// Callback para notificar la anulacion de pulsaciones inmediatas
+            Callback<void(uint32_t)> stormCb;  /// Callback para notificar tormentas de interrupciones
+            Callback<void(const Event&)> eventCb;	/// Callback para notificar todos los eventos
+            HoldProfile hold;                  /// Perfil de los eventos hold (escalones)
+            PushButtonGesture::Config gesture; /// Ventanas del reconocedor de gestos
+            PushButtonBounceEstimator::Config bounce;	/// Parametros del filtrado adaptativo
+        };
+        typedef PushButtonLatch<Config, 2> ConfigLatch;
+
+        ConfigLatch cfg;                       /// Configuracion opcional publicada
+        PushButtonGesture gesture;             /// Reconocedor de gestos
+        PushButtonBounceEstimator bounce;      /// Aprendizaje del rebote (FilterAdaptive)
+        PushButtonTrace* trace;                /// Registrador de trazas (NULL si no se registran)
+        uint32_t storm_max;                    /// Flancos maximos por ventana (0: sin proteccion)
+        uint32_t storm_window_us;              /// Ventana de contabilizacion de flancos
+        uint32_t storm_base_us;                /// Enmascaramiento inicial
+        uint32_t storm_win_us;                 /// Inicio de la ventana en curso (ISR)
+        uint32_t storm_edges;                  /// Flancos en la ventana en curso (ISR)
+        volatile bool storm_pending;           /// Tormenta detectada en la ISR, pendiente de atender en el hilo
+        bool storm_masked;                     /// ISR enmascaradas por una tormenta
+        uint32_t storm_ts_us;                  /// Instante de deteccion de la tormenta en curso
+        uint32_t storm_until_us;               /// Fin del enmascaramiento en curso
+        uint32_t storm_unmask_us;              /// Instante en que finalizo el ultimo enmascaramiento
+        StormStats storm_stats;                /// Contadores de tormentas
+        Extension(uint32_t filter_us);
+    };
+
+    /** Recursos del modo independiente: hilo, timers y buffer de flancos propios. Se reservan en memoria dinamica,
+     *  por lo que no ocupan espacio en los pulsadores de un grupo
+     */
+    struct Standalone {
+        Thread* th;                            /// Hilo propio
+        RtosTimer* tick_filt;                  /// Timer del filtro
+        RtosTimer* tick_hold;                  /// Timer de eventos hold
+        PushButtonRing<EdgeRecord, EdgeQueueSize> edges;	/// Flancos pendientes
+        uint32_t filt_due_us;                  /// Vencimiento del timer del filtro en curso
+        uint32_t hold_tick_ms;                 /// Periodo con el que esta iniciado el timer de eventos hold
+        char th_name[24];
+    };
 
     uint32_t _filter_timeout_us;
-    InterruptIn* _iin;						/// InterruptIn asociada
+    InterruptIn* _iin;						/// InterruptIn asociada (construida en _iin_mem, NULL con muestreador)
+    uint64_t _iin_mem[(sizeof(InterruptIn) + sizeof(uint64_t) - 1) / sizeof(uint64_t)];	/// Almacenamiento de _iin
     LogicLevel _level;                      /// Nivel lgico
-    Callback<void(uint32_t)> _pressCb;      /// Callback para notificar eventos de pulsacin
-    Callback<void()> 		 _pressCb2;     /// Callback para notificar eventos de pulsacin
-    Callback<void(uint32_t)> _holdCb;       /// Callback para notificar eventos de mantenimiento
-    Callback<void()> 		 _holdCb2;      /// Callback para notificar eventos de mantenimiento
-    Callback<void(uint32_t)> _releaseCb;    /// Callback para notificar eventos de liberacin
-    Callback<void()> 		 _releaseCb2;   /// Callback para notificar eventos de liberacin
-    RtosTimer* _tick_filt;
-    RtosTimer* _tick_hold;
+    ConfigLatch _cfg;						/// Configuracion basica publicada
+    static std::atomic<uint32_t> _cfg_writer;	/// Serializa los cambios de configuracion de todos los pulsadores
+    std::atomic<uint32_t> _requests;		/// Cambios de configuracion pendientes de aplicar (ReqXXX)
+    std::atomic<Extension*> _ext;			/// Funciones opcionales (NULL hasta habilitar la primera)
+    ExtensionStorage* _ext_mem;				/// Almacenamiento de _ext asignado o reservado
+    bool _ext_owned;						/// _ext_mem reservado en memoria dinamica
+    Standalone* _own;						/// Recursos del modo independiente (NULL en modo grupo)
+    PushButtonTimerWheel::Node _filt_node;	/// Timer del filtro en la rueda del gestor (modo grupo)
+    PushButtonTimerWheel::Node _hold_node;	/// Timer de eventos hold en la rueda del gestor (modo grupo)
     bool _hold_running;						/// flag para indicar si el timer hold est en curso
-    uint32_t _hold_us;                      /// Microsegundos entre eventos hold
-    uint32_t _id;                           /// Identificador del pulsador
+    bool _low_power;						/// Modo de bajo consumo aplicado (eventos hold sin timer)
+    bool _hold_armed;						/// Evento hold programado en modo de bajo consumo
+    bool _leading;							/// Notificacion inmediata de las pulsaciones
+    bool _lead_press;						/// Pulsacion notificada de forma inmediata pendiente de verificar
     bool _defdbg;							/// Flag para activar las trazas de depuracin por defecto
-    uint8_t _curr_value;					/// Valor recien ledo del InterruptIn
+    bool _burst;							/// Flag para indicar que hay una rafaga de flancos sin resolver
     bool _endis_gfilt;						/// Flag de control del filtro anti-glitch
-    Thread* _th;							/// Controlador del hilo
-    char _th_name[24];
+    uint8_t _curr_value;					/// Valor recien ledo del InterruptIn
+    uint8_t _stable_value;					/// Ultimo nivel estable notificado
+    uint8_t _hold_step;						/// Escalon vigente del perfil hold
+    uint8_t _slot;							/// Posicion asignada por el gestor
+    uint8_t _input;							/// Entrada del muestreador
+    uint32_t _hold_next_us;					/// Instante del siguiente evento hold en bajo consumo o con timer propio
+    uint32_t _hold_period_us;				/// Periodo vigente de los eventos hold
+    uint32_t _hold_repeat;					/// Eventos hold notificados desde la pulsacion
+    uint32_t _wakeups;						/// Activaciones del hilo propio y de los timers
+    uint32_t _id;                           /// Identificador del pulsador
+    uint32_t _burst_ts_us;					/// Instante del primer flanco de la rafaga en curso
+    uint32_t _event_ts_us;					/// Instante del primer flanco del ultimo evento entregado
+    uint32_t _level_ts_us;					/// Instante del primer flanco del ultimo nivel estable
+    FilterMode _filt_mode;					/// Motor de filtrado anti-glitch aplicado
+    PushButtonDebouncer _debouncer;			/// Filtro por marcas de tiempo (modos sin timer)
+    PUSHBUTTON_STATS(PushButtonStats _stats;)	/// Instrumentacion (solo con ENABLE_PUSHBUTTON_STATS)
+    PushButtonManager* _mgr;				/// Gestor asociado (NULL en modo independiente)
+    PushButtonEventQueue* _queue;			/// Cola de entrega diferida (NULL en entrega directa)
+    PushButtonSampler* _smp;				/// Muestreador de la entrada (NULL con InterruptIn)
+    State _state;							/// Estado del pulsador (copia del escritor)
+    PushButtonSeqLock<State> _state_pub;	/// Estado publicado para su consulta desde otros hilos
+
+	/** publishState
+     *  Publica el estado del pulsador. Se invoca unicamente desde el hilo de despacho (propio o del gestor), unico
+     *  escritor del estado
+     */
+    void publishState();
+
+	/** getExtension
+     *  Obtiene las funciones opcionales, desde cualquier contexto
+     *  @return Funciones opcionales o NULL si no se ha habilitado ninguna
+     */
+    Extension* getExtension() const { return _ext.load(); }
+
+	/** requireExtension
+     *  Obtiene las funciones opcionales y las construye, en el almacenamiento asignado o en memoria dinamica, si no
+     *  se ha habilitado ninguna. Se invoca desde el escritor de la configuracion (ver lockConfig)
+     *  @return Funciones opcionales
+     */
+    Extension* requireExtension();
+
+	/** lockConfig
+     *  Inicia un cambio de configuracion. Los cambios son esporadicos y breves, por lo que un unico cerrojo
+     *  compartido por todos los pulsadores evita un objeto del sistema operativo por pulsador
+     */
+    static void lockConfig();
+
+	/** unlockConfig
+     *  Finaliza un cambio de configuracion
+     */
+    static void unlockConfig();
+
+	/** postRequest
+     *  Solicita al hilo de despacho (propio o del gestor) que aplique los cambios de configuracion publicados
+     *  @param req Cambios solicitados (ReqXXX)
+     */
+    void postRequest(uint32_t req);
+
+	/** applyRequests
+     *  Aplica los cambios de configuracion solicitados. Se invoca unicamente desde el hilo de despacho, de forma
+     *  que el estado del filtrado, de los gestos y de los eventos hold solo se modifica en este
+     *  @param now_us Instante actual
+     */
+    void applyRequests(uint32_t now_us);
+
+	/** applyFilterMode
+     *  Aplica un motor de filtrado anti-glitch y reinicia el filtro sin timer
+     *  @param mode Motor de filtrado
+     *  @param now_us Instante actual
+     */
+    void applyFilterMode(FilterMode mode, uint32_t now_us);
+
+	/** applyLowPower
+     *  Aplica el modo de bajo consumo, continuando el evento hold en curso con el nuevo mecanismo
+     *  @param enable true para activar
+     *  @param now_us Instante actual
+     */
+    void applyLowPower(bool enable, uint32_t now_us);
+
+	/** init
+     *  Inicializa el pulsador, comun a ambos modos de funcionamiento
+     */
+    void init(PinName32 btn, uint32_t id, LogicLevel level, PinMode mode, uint32_t filter_us);
+
+	/** startDispatcher
+     *  Crea el buffer de flancos y el hilo propio o se registra en el gestor
+     */
+    void startDispatcher();
+
+	/** readPin
+     *  Lee el nivel actual del pin, o el de la ultima muestra con muestreador
+     *  @return Nivel
+     */
+    uint8_t readPin();
+
+	/** isrEdge
+     *  Contabiliza la tasa de flancos y registra el flanco, o enmascara las ISR si se supera el umbral
+     *  @param level Nivel del pin tras el flanco
+     */
+    void isrEdge(uint8_t level);
+
+	/** resolveStorm
+     *  Notifica la tormenta detectada en la ISR o finaliza el enmascaramiento vencido
+     *  @param now_us Instante actual
+     */
+    void resolveStorm(uint32_t now_us);
 
 	/** isrRiseCallback
      *  ISR para procesar eventos de cambio de nivel
@@ -128,16 +698,145 @@ class PushButton {
      */
     void gpioFilterCallback();
   
-	/** tickCallback
-     *  ISR para procesar eventos de temporizacin
+	/** filterTickCallback
+     *  Callback del timer del filtro anti-glitch. Se ejecuta en el servicio de timers y solo senaliza el
+     *  vencimiento al hilo propio (ver resolveFilterTick)
+     */
+    void filterTickCallback();
+
+	/** holdTickCallback
+     *  Callback del timer de eventos hold. Se ejecuta en el servicio de timers y solo senaliza el vencimiento al
+     *  hilo propio (ver resolveHoldTick)
      */
     void holdTickCallback();
 
+	/** resolveFilterTick
+     *  Procesa en el hilo propio el vencimiento senalizado del timer del filtro, descartando el de un timer ya
+     *  reiniciado o detenido
+     *  @param now_us Instante actual
+     */
+    void resolveFilterTick(uint32_t now_us);
+
+	/** resolveHoldTick
+     *  Procesa en el hilo propio el vencimiento senalizado del timer de eventos hold y programa el siguiente desde
+     *  el vencimiento nominal, descartando el de un timer ya detenido o reiniciado
+     *  @param now_us Instante actual
+     */
+    void resolveHoldTick(uint32_t now_us);
+
+	/** notifyHold
+     *  Notifica un evento hold
+     */
+    void notifyHold();
+
+	/** startFilterTimer
+     *  Inicia el timer del filtro anti-glitch, propio o en la rueda del gestor
+     */
+    void startFilterTimer();
+
+	/** startHoldTimer
+     *  Inicia el timer periodico de eventos hold, propio o en la rueda del gestor
+     *  @param delay_us Retardo del primer evento hold
+     *  @param period_us Periodo de los eventos hold
+     */
+    void startHoldTimer(uint32_t delay_us, uint32_t period_us);
+
+	/** setHoldPeriod
+     *  Aplica un nuevo periodo de eventos hold desde el evento en curso. En la rueda del gestor se desplaza el
+     *  siguiente vencimiento sin detener el timer; en bajo consumo y con timer propio se aplica al calcular el
+     *  siguiente vencimiento (ver resolveTimeouts y resolveHoldTick)
+     *  @param period_us Periodo de los eventos hold
+     */
+    void setHoldPeriod(uint32_t period_us);
+
+	/** timerExpired
+     *  Procesa el vencimiento de un timer de la rueda del gestor. Se invoca desde el hilo del gestor
+     *  @param node Timer vencido
+     */
+    void timerExpired(PushButtonTimerWheel::Node* node);
+
 	/** enableRiseFallCallbacks
-     *  Ajsuta las callbacks en funcin del nivel lgico actual
+     *  Habilita las ISR de ambos flancos (o la entrada del muestreador). No modifica el estado del filtrado
      */
     void enableRiseFallCallbacks();
 
+	/** pushEdge
+     *  Registra un flanco con su marca de tiempo. Se invoca desde las ISR
+     *  @param level Nivel del pin tras el flanco
+     */
+    void pushEdge(uint8_t level);
+
+	/** processEdge
+     *  Actualiza el estado con un flanco extraido del buffer, desde el hilo propio o desde el gestor
+     *  @param rec Flanco registrado
+     */
+    void processEdge(const EdgeRecord& rec);
+
+	/** commitEdges
+     *  Inicia el filtrado tras procesar un lote de flancos
+     */
+    void commitEdges();
+
+	/** resolveDebounce
+     *  Evalua el filtro sin timer y notifica el evento si el nivel estable ha cambiado
+     *  @param now_us Instante actual
+     */
+    void resolveDebounce(uint32_t now_us);
+
+	/** isDebouncePending
+     *  Comprueba si el filtro sin timer tiene una rafaga pendiente de resolver
+     *  @return true si hay que volver a evaluar el filtro
+     */
+    bool isDebouncePending();
+
+	/** resolveTimeouts
+     *  Evalua las ventanas vencidas del filtro sin timer y del reconocedor de gestos
+     *  @param now_us Instante actual
+     */
+    void resolveTimeouts(uint32_t now_us);
+
+	/** getWaitTimeout
+     *  Obtiene el timeout de espera del hilo de despacho hasta la siguiente evaluacion del filtro sin timer,
+     *  del reconocedor de gestos o del enmascaramiento por tormenta
+     *  @param now_us Instante actual
+     *  @return Milisegundos hasta la siguiente evaluacion u osWaitForever si no hay ventanas en curso
+     */
+    uint32_t getWaitTimeout(uint32_t now_us);
+
+	/** raiseEvent
+     *  Entrega un evento a las callbacks instaladas, de forma directa o a traves de la cola de eventos
+     *  @param type Tipo de evento
+     *  @param ts_us Instante del primer flanco que lo origino
+     *  @param gesture Gesto reconocido (EventGesture)
+     *  @param clicks Pulsaciones cortas del gesto (EventGesture) o escalon (EventHoldStep)
+     *  @param repeat Numero de evento hold (EventHold)
+     *  @param held_ms Tiempo pulsado (EventHold)
+     */
+    void raiseEvent(EventType type, uint32_t ts_us, uint8_t gesture = 0, uint8_t clicks = 0, uint32_t repeat = 0, uint32_t held_ms = 0);
+
+	/** deliverEvent
+     *  Invoca las callbacks instaladas para un evento
+     *  @param ev Evento
+     */
+    void deliverEvent(const Event& ev);
+
+	/** notifyGestures
+     *  Notifica los gestos reconocidos pendientes
+     */
+    void notifyGestures();
+
+	/** stopHold
+     *  Detiene la generacion de eventos hold en curso
+     */
+    void stopHold();
+
+	/** notifyLevel
+     *  Notifica el evento asociado a un nuevo nivel estable
+     *  @param pin_level Nivel estable
+     *  @param ts_us Instante del primer flanco que lo origino
+     */
+    void notifyLevel(uint8_t pin_level, uint32_t ts_us);
+
 
     /**
      * Hilo de control
@@ -145,6 +844,12 @@ class PushButton {
     void _task();
   
 };
+
+
+/** Almacenamiento de las funciones opcionales de un pulsador (ver PushButton::setExtensionStorage) */
+struct PushButton::ExtensionStorage {
+    uint64_t mem[(sizeof(PushButton::Extension) + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+};
      
 
 
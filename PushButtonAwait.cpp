@@ -0,0 +1,189 @@
+/*
+ * PushButtonAwait.cpp
+ *
+ *  Created on: Oct 2026
+ *      Author: raulMrello
+ */
+
+#include "PushButtonAwait.h"
+
+#if defined(__cpp_impl_coroutine)
+
+
+
+//------------------------------------------------------------------------------------
+//-- FRAME IMPLEMENTATION ------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------------
+void* PushButtonFrame::allocate(size_t size){
+	// la cabecera referencia este objeto, para liberarlo desde operator delete
+	MBED_ASSERT(!_used && Header + size <= _size);
+	_used = true;
+	*static_cast<PushButtonFrame**>(_mem) = this;
+	return static_cast<uint8_t*>(_mem) + Header;
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonFrame::release(void* ptr){
+	PushButtonFrame* frame = *reinterpret_cast<PushButtonFrame**>(static_cast<uint8_t*>(ptr) - Header);
+	frame->_used = false;
+}
+
+
+
+//------------------------------------------------------------------------------------
+//-- AWAITER IMPLEMENTATION ----------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------------
+PushButtonEventSource::Awaiter::~Awaiter(){
+	// corrutina destruida durante la espera
+	core_util_critical_section_enter();
+	if(_src._waiter == this){
+		_src._waiter = NULL;
+	}
+	core_util_critical_section_exit();
+}
+
+
+//------------------------------------------------------------------------------------
+bool PushButtonEventSource::Awaiter::await_ready(){
+	core_util_critical_section_enter();
+	bool ready = _src.take(_mask, _result.event);
+	core_util_critical_section_exit();
+	_result.timeout = !ready;
+	return ready || _timeout_ms == 0;
+}
+
+
+//------------------------------------------------------------------------------------
+bool PushButtonEventSource::Awaiter::await_suspend(std::coroutine_handle<> h){
+	// el timer se inicia antes de publicar la espera, de forma que un evento entregado entretanto desde otro hilo
+	// siempre encuentra el timer en curso para detenerlo
+	_h = h;
+	_start_us = PushButton::getTimeUs();
+	if(_timeout_ms != osWaitForever){
+		_src._tmr->start(_timeout_ms);
+	}
+	core_util_critical_section_enter();
+	bool ready = _src.take(_mask, _result.event);
+	if(!ready){
+		_src._waiter = this;
+	}
+	core_util_critical_section_exit();
+	if(ready){
+		if(_timeout_ms != osWaitForever){
+			_src._tmr->stop();
+		}
+		_result.timeout = false;
+		return false;
+	}
+	return true;
+}
+
+
+
+//------------------------------------------------------------------------------------
+//-- PUBLIC METHODS IMPLEMENTATION ---------------------------------------------------
+//------------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------------
+PushButtonEventSource::PushButtonEventSource(PushButton& btn) : _btn(btn) {
+	_waiter = NULL;
+	#if __MBED__==1
+	_tmr = new RtosTimer(callback(this, &PushButtonEventSource::onTimeout), osTimerOnce);
+	#elif ESP_PLATFORM==1
+	_tmr = new RtosTimer(callback(this, &PushButtonEventSource::onTimeout), osTimerOnce, "BtnTmrAwait");
+	#endif
+	MBED_ASSERT(_tmr);
+	_btn.enableEventCallback(callback(this, &PushButtonEventSource::onEvent));
+}
+
+
+//------------------------------------------------------------------------------------
+PushButtonEventSource::~PushButtonEventSource(){
+	_btn.disableEventCallback();
+	_tmr->stop();
+	delete(_tmr);
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonEventSource::flush(){
+	core_util_critical_section_enter();
+	PushButton::Event ev;
+	while(_pending.pop(ev)){
+	}
+	core_util_critical_section_exit();
+}
+
+
+
+//------------------------------------------------------------------------------------
+//-- PRIVATE METHODS IMPLEMENTATION --------------------------------------------------
+//------------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------------
+bool PushButtonEventSource::take(uint32_t mask, PushButton::Event& ev){
+	while(_pending.pop(ev)){
+		if((mask & (1u << ev.type)) != 0){
+			return true;
+		}
+	}
+	return false;
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonEventSource::onEvent(const PushButton::Event& ev){
+	// con una espera en curso, los eventos no esperados se descartan
+	core_util_critical_section_enter();
+	Awaiter* w = _waiter;
+	if(w == NULL){
+		_pending.push(ev);
+	}
+	else if((w->_mask & (1u << ev.type)) != 0){
+		_waiter = NULL;
+		w->_result.timeout = false;
+		w->_result.event = ev;
+	}
+	else{
+		w = NULL;
+	}
+	core_util_critical_section_exit();
+	if(w == NULL){
+		return;
+	}
+	if(w->_timeout_ms != osWaitForever){
+		_tmr->stop();
+	}
+	// la corrutina continua hasta su siguiente co_await desde el camino de entrega del evento
+	w->_h.resume();
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonEventSource::onTimeout(){
+	// un vencimiento anterior a la espera en curso (timer detenido tras vencer) se descarta
+	core_util_critical_section_enter();
+	Awaiter* w = _waiter;
+	if(w != NULL && (uint32_t)(PushButton::getTimeUs() - w->_start_us) + 1000 >= 1000 * w->_timeout_ms){
+		_waiter = NULL;
+		w->_result.timeout = true;
+	}
+	else{
+		w = NULL;
+	}
+	core_util_critical_section_exit();
+	if(w != NULL){
+		w->_h.resume();
+	}
+}
+
+#endif /* __cpp_impl_coroutine */
@@ -0,0 +1,247 @@
+/*
+ * PushButtonAwait.h
+ *
+ *  Created on: Oct 2026
+ *      Author: raulMrello
+ *
+ *	PushButtonAwait permite escribir flujos de interaccion (menus, secuencias de configuracion) como corrutinas
+ *  C++20 que esperan los eventos de un pulsador con co_await, en lugar de encadenar callbacks y maquinas de
+ *  estados:
+ *
+ *		PushButtonTask menu(PushButtonFrame& frame, PushButtonEventSource& btn){
+ *			for(;;){
+ *				co_await btn.pressed();
+ *				PushButtonEventSource::Result r = co_await btn.nextEvent(2000);
+ *				...
+ *			}
+ *		}
+ *
+ *		static PushButtonFrameStorage<256> frame;
+ *		PushButtonTask task = menu(frame, events);
+ *
+ *  PushButtonEventSource recibe todos los eventos del pulsador (ver PushButton::enableEventCallback) y reanuda la
+ *  corrutina en espera desde el propio camino de entrega de eventos: el hilo de despacho (propio o del gestor)
+ *  o el hilo que ejecute PushButtonEventQueue::dispatch. Por tanto la corrutina no debe
+ *  bloquear entre dos co_await. Los eventos que llegan sin ninguna corrutina en espera se guardan (hasta Depth)
+ *  y se entregan en los siguientes co_await. El timeout de las esperas vence en el servicio de timers, con un
+ *  unico RtosTimer por objeto.
+ *
+ *  Las esperas no reservan memoria: el estado de cada co_await reside en el marco de la corrutina, y el marco se
+ *  construye en memoria reservada por el llamante (PushButtonFrameStorage), que la corrutina PushButtonTask
+ *  recibe como primer parametro. Una corrutina PushButtonTask sin ese parametro no compila.
+ *
+ *  Solo se compila con soporte de corrutinas (__cpp_impl_coroutine, p.ej. -std=c++20).
+ */
+
+#ifndef __PushButtonAwait__H
+#define __PushButtonAwait__H
+
+#if defined(__cpp_impl_coroutine)
+
+#include "mbed.h"
+#include "PushButton.h"
+#include "PushButtonRing.h"
+#include <coroutine>
+#include <cstddef>
+
+
+/** Memoria reservada por el llamante para el marco de una corrutina PushButtonTask */
+class PushButtonFrame {
+  public:
+	static const size_t Header = alignof(std::max_align_t);	/// Cabecera que referencia la memoria propietaria
+
+	/** allocate
+     *  Asigna el marco de una corrutina. Solo admite un marco a la vez
+     *  @param size Tamano del marco
+     *  @return Memoria del marco
+     */
+	void* allocate(size_t size);
+
+	/** release
+     *  Libera un marco asignado con allocate
+     *  @param ptr Memoria del marco
+     */
+	static void release(void* ptr);
+
+	/** isUsed
+     *  Comprueba si el marco esta asignado a una corrutina
+     *  @return true si esta asignado
+     */
+	bool isUsed() { return _used; }
+
+  protected:
+	PushButtonFrame(void* mem, size_t size) : _mem(mem), _size(size), _used(false) {}
+
+  private:
+	void* _mem;								/// Memoria del marco
+	size_t _size;							/// Tamano disponible (incluida la cabecera)
+	bool _used;								/// Marco asignado
+};
+
+
+/** Memoria para el marco de una corrutina de hasta Size bytes. Si no es suficiente, allocate falla con MBED_ASSERT */
+template <size_t Size>
+class PushButtonFrameStorage : public PushButtonFrame {
+  public:
+	PushButtonFrameStorage() : PushButtonFrame(_buf, sizeof(_buf)) {}
+
+  private:
+	alignas(std::max_align_t) uint8_t _buf[Header + Size];
+};
+
+
+/** Corrutina de un flujo de interaccion. Se ejecuta de inmediato hasta el primer co_await y se destruye (liberando
+ *  su marco) al destruir el objeto
+ */
+class PushButtonTask {
+  public:
+	/** Promesa de una corrutina con parametros (PushButtonFrame&, Args...), seleccionada por la especializacion de
+	 *  std::coroutine_traits. El marco se construye en la memoria recibida como primer parametro. Sin ese parametro
+	 *  no existe ninguna promesa aplicable y la corrutina no compila. operator new no es plantilla, de forma que el
+	 *  compilador lo empareja con operator delete (-Wmismatched-new-delete)
+	 */
+	template <typename... Args>
+	struct Promise {
+		PushButtonTask get_return_object() { return PushButtonTask(std::coroutine_handle<Promise>::from_promise(*this)); }
+		std::suspend_never initial_suspend() noexcept { return {}; }
+		std::suspend_always final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { MBED_ASSERT(false); }
+		static void* operator new(size_t size, PushButtonFrame& frame, Args&...) { return frame.allocate(size); }
+		static void operator delete(void* ptr) { PushButtonFrame::release(ptr); }
+	};
+
+	PushButtonTask(PushButtonTask&& other) : _h(other._h) { other._h = nullptr; }
+	~PushButtonTask() {
+		if(_h){
+			_h.destroy();
+		}
+	}
+
+	/** done
+     *  Comprueba si la corrutina ha finalizado
+     *  @return true si ha finalizado
+     */
+	bool done() const { return !_h || _h.done(); }
+
+  private:
+	std::coroutine_handle<> _h;
+
+	explicit PushButtonTask(std::coroutine_handle<> h) : _h(h) {}
+	PushButtonTask(const PushButtonTask&) = delete;
+	PushButtonTask& operator=(const PushButtonTask&) = delete;
+};
+
+
+namespace std {
+template <typename... Args>
+struct coroutine_traits<PushButtonTask, PushButtonFrame&, Args...> {
+	typedef PushButtonTask::Promise<Args...> promise_type;
+};
+}
+
+
+/** Fuente de eventos de un pulsador para su espera con co_await */
+class PushButtonEventSource {
+  public:
+	static const uint32_t Depth = 8;				/// Eventos guardados sin corrutina en espera
+	static const uint32_t AllEvents = 0xFFFFFFFF;	/// Mascara de espera de cualquier evento
+
+	/** Resultado de una espera */
+	struct Result {
+		bool timeout;								/// true si ha vencido el timeout sin recibir el evento
+		PushButton::Event event;					/// Evento recibido
+		explicit operator bool() const { return !timeout; }
+	};
+
+	/** Espera de un evento, construida por nextEvent, pressed, released o held */
+	class Awaiter {
+	  public:
+		~Awaiter();
+		bool await_ready();
+		bool await_suspend(std::coroutine_handle<> h);
+		Result await_resume() { return _result; }
+
+	  private:
+		friend class PushButtonEventSource;
+		PushButtonEventSource& _src;
+		uint32_t _mask;								/// Eventos esperados (bit = PushButton::EventType)
+		uint32_t _timeout_ms;						/// Timeout de la espera (osWaitForever: sin timeout)
+		uint32_t _start_us;							/// Inicio de la espera
+		std::coroutine_handle<> _h;					/// Corrutina en espera
+		Result _result;
+
+		Awaiter(PushButtonEventSource& src, uint32_t mask, uint32_t timeout_ms) : _src(src), _mask(mask), _timeout_ms(timeout_ms), _start_us(0) {}
+		Awaiter(const Awaiter&) = delete;
+		Awaiter& operator=(const Awaiter&) = delete;
+	};
+
+
+	/** Constructor. Recibe todos los eventos del pulsador, que no debe tener otra callback de eventos instalada
+	 *  @param btn Pulsador
+	 */
+	PushButtonEventSource(PushButton& btn);
+	~PushButtonEventSource();
+
+
+	/** nextEvent
+     *  Espera el siguiente evento de los indicados
+     *  @param timeout_ms Timeout de la espera (osWaitForever: sin timeout, 0: solo eventos guardados)
+     *  @param mask Eventos esperados (bit = PushButton::EventType). Los demas se descartan
+     *  @return Espera para co_await
+     */
+	Awaiter nextEvent(uint32_t timeout_ms = osWaitForever, uint32_t mask = AllEvents) { return Awaiter(*this, mask, timeout_ms); }
+
+	/** pressed, released, held
+     *  Espera el siguiente evento press, release o hold, descartando los demas
+     *  @param timeout_ms Timeout de la espera
+     *  @return Espera para co_await
+     */
+	Awaiter pressed(uint32_t timeout_ms = osWaitForever) { return Awaiter(*this, (1u << PushButton::EventPress), timeout_ms); }
+	Awaiter released(uint32_t timeout_ms = osWaitForever) { return Awaiter(*this, (1u << PushButton::EventRelease), timeout_ms); }
+	Awaiter held(uint32_t timeout_ms = osWaitForever) { return Awaiter(*this, (1u << PushButton::EventHold), timeout_ms); }
+
+
+	/** flush
+     *  Descarta los eventos guardados
+     */
+	void flush();
+
+
+	/** getOverflowCount
+     *  Obtiene el numero de eventos descartados por no caber en la reserva de eventos guardados
+     *  @return Eventos descartados
+     */
+	uint32_t getOverflowCount() { return _pending.getOverflowCount(); }
+
+  private:
+	PushButton& _btn;
+	PushButtonRing<PushButton::Event, Depth> _pending;	/// Eventos recibidos sin corrutina en espera
+	Awaiter* _waiter;								/// Espera en curso (NULL si no hay corrutina en espera)
+	RtosTimer* _tmr;								/// Timer de las esperas con timeout
+
+	/** take
+     *  Extrae el primer evento guardado de los indicados, descartando los anteriores. Se invoca en seccion critica
+     *  @param mask Eventos esperados
+     *  @param ev Recibe el evento
+     *  @return true si existe
+     */
+	bool take(uint32_t mask, PushButton::Event& ev);
+
+	/** onEvent
+     *  Callback de eventos del pulsador: reanuda la corrutina en espera o guarda el evento
+     *  @param ev Evento
+     */
+	void onEvent(const PushButton::Event& ev);
+
+	/** onTimeout
+     *  Callback del timer de las esperas: reanuda la corrutina en espera sin evento
+     */
+	void onTimeout();
+};
+
+#endif /* __cpp_impl_coroutine */
+
+#endif /*__PushButtonAwait__H */
+
+/**** END OF FILE ****/
@@ -0,0 +1,138 @@
+/*
+ * PushButtonBank.h
+ *
+ *  Created on: Oct 2026
+ *      Author: raulMrello
+ *
+ *	PushButtonBank es el motor de filtrado anti-rebotes para bancos de entradas muestreadas de forma periodica
+ *  (lectura de un puerto GPIO completo, cadenas de registros de desplazamiento, etc). Recibe una instantanea de
+ *  32 o 64 bits con el nivel de todas las entradas y filtra todos los pulsadores a la vez mediante contadores
+ *  verticales: el bit i de _cnt0 y _cnt1 forma un contador de 2 bits para la entrada i, de modo que cada muestra
+ *  se procesa con un numero fijo de operaciones bit a bit independientemente del numero de pulsadores.
+ *
+ *  Una entrada cambia de estado tras 4 muestras consecutivas distintas de su estado filtrado (ventana de filtrado
+ *  = 4 periodos de muestreo). Cualquier muestra igual al estado filtrado reinicia su contador.
+ *
+ *  Las mascaras de flancos resultantes se traducen a los identificadores de cada pulsador (base_id + bit) con
+ *  nextEvent(), para invocar las mismas callbacks por _id que PushButton. No depende del HAL.
+ */
+
+#ifndef __PushButtonBank__H
+#define __PushButtonBank__H
+
+#include <stdint.h>
+
+
+template <typename Word>
+class PushButtonBank {
+	static_assert(sizeof(Word) == 4 || sizeof(Word) == 8, "PushButtonBank: Word debe ser de 32 o 64 bits");
+
+  public:
+
+	/** Numero de entradas del banco */
+	static const uint32_t Width = 8 * sizeof(Word);
+
+	/** Numero de muestras consecutivas para validar un cambio de estado */
+	static const uint32_t Samples = 4;
+
+
+	/** Constructor
+	 *  @param base_id Identificador del pulsador asociado al bit 0
+	 *  @param active_low Mascara de entradas activas a nivel bajo (pulsadas con el bit a 0)
+	 *  @param enabled Mascara de entradas utilizadas
+	 */
+	PushButtonBank(uint32_t base_id = 0, Word active_low = ~(Word)0, Word enabled = ~(Word)0) {
+		_base_id = base_id;
+		_active_low = active_low;
+		_enabled = enabled;
+		reset(0);
+	}
+
+
+	/** reset
+     *  Fija el estado filtrado de todas las entradas, descartando los contadores y flancos pendientes
+     *  @param pressed Mascara de entradas pulsadas
+     */
+	void reset(Word pressed){
+		_state = pressed & _enabled;
+		_cnt0 = ~(Word)0;
+		_cnt1 = ~(Word)0;
+		_pressed = 0;
+		_released = 0;
+	}
+
+
+	/** update
+     *  Procesa una instantanea de las entradas
+     *  @param raw Nivel de todas las entradas (bit i = entrada i)
+     *  @return Mascara de entradas que han cambiado de estado en esta muestra
+     */
+	Word update(Word raw){
+		Word diff = ((raw ^ _active_low) ^ _state) & _enabled;
+		// contador vertical de 2 bits: se reinicia si la muestra coincide con el estado, desborda tras 4 muestras
+		_cnt0 = ~(_cnt0 & diff);
+		_cnt1 = _cnt0 ^ (_cnt1 & diff);
+		Word toggle = diff & _cnt0 & _cnt1;
+		_state ^= toggle;
+		_pressed |= toggle & _state;
+		_released |= toggle & ~_state;
+		return toggle;
+	}
+
+
+	/** nextEvent
+     *  Extrae el siguiente flanco pendiente (primero pulsaciones, despues liberaciones)
+     *  @param id Recibe el identificador del pulsador (base_id + bit)
+     *  @param pressed Recibe true si es una pulsacion, false si es una liberacion
+     *  @return true si habia un flanco pendiente
+     */
+	bool nextEvent(uint32_t& id, bool& pressed){
+		Word* mask = (_pressed != 0)? &_pressed : &_released;
+		if(*mask == 0){
+			return false;
+		}
+		pressed = (mask == &_pressed);
+		id = _base_id + (uint32_t)__builtin_ctzll((uint64_t)*mask);
+		*mask &= (*mask - 1);
+		return true;
+	}
+
+
+	/** getState
+     *  Obtiene el estado filtrado
+     *  @return Mascara de entradas pulsadas
+     */
+	Word getState() { return _state; }
+
+
+	/** getPressed / getReleased
+     *  Obtienen los flancos pendientes de extraer con nextEvent
+     *  @return Mascara de entradas
+     */
+	Word getPressed() { return _pressed; }
+	Word getReleased() { return _released; }
+
+
+	/** clearEvents
+     *  Descarta los flancos pendientes (p.ej. si se han procesado directamente las mascaras)
+     */
+	void clearEvents(){
+		_pressed = 0;
+		_released = 0;
+	}
+
+  private:
+	uint32_t _base_id;						/// Identificador del bit 0
+	Word _active_low;						/// Entradas activas a nivel bajo
+	Word _enabled;							/// Entradas utilizadas
+	Word _state;							/// Estado filtrado (1: pulsado)
+	Word _cnt0;								/// Bit 0 de los contadores verticales
+	Word _cnt1;								/// Bit 1 de los contadores verticales
+	Word _pressed;							/// Pulsaciones pendientes de notificar
+	Word _released;							/// Liberaciones pendientes de notificar
+};
+
+
+#endif /*__PushButtonBank__H */
+
+/**** END OF FILE ****/
@@ -0,0 +1,182 @@
+/*
+ * PushButtonBounceEstimator.h
+ *
+ *  Created on: Oct 2026
+ *      Author: raulMrello
+ *
+ *	PushButtonBounceEstimator aprende el rebote real de un contacto a partir de las marcas de tiempo de los flancos
+ *  y obtiene la ventana de filtrado minima segura para el filtro de tiempo estable (ver PushButton::FilterAdaptive).
+ *
+ *  El filtro de tiempo estable resuelve una rafaga cuando transcurre la ventana sin flancos, por lo que la ventana
+ *  solo debe superar el mayor intervalo entre dos flancos consecutivos de un mismo rebote, no la duracion total
+ *  del rebote. El estimador mide ese intervalo en cada rafaga y mantiene su maximo reciente, que solo decrece
+ *  lentamente (1/32 de la diferencia por rafaga). La ventana resultante es ese maximo mas un margen configurable,
+ *  acotada entre un minimo (que protege frente a glitches electricos) y la ventana configurada en el pulsador, que
+ *  se aplica tambien durante el aprendizaje inicial.
+ *
+ *  Si la ventana resulta corta, el rebote continua tras resolver la rafaga y genera una nueva rafaga que vuelve al
+ *  nivel estable sin notificar eventos. El intervalo que la separa de la anterior se toma como muestra, por lo que
+ *  la ventana crece de inmediato. Un error de ruido (flanco perdido) duplica la ventana.
+ *
+ *  No depende del HAL, por lo que puede utilizarse y verificarse en el host. Todos los instantes son contadores
+ *  de 32 bits en microsegundos y se comparan por diferencia, tolerando el desbordamiento del contador.
+ */
+
+#ifndef __PushButtonBounceEstimator__H
+#define __PushButtonBounceEstimator__H
+
+#include <stdint.h>
+
+
+class PushButtonBounceEstimator {
+  public:
+
+    /** Parametros del aprendizaje */
+    struct Config{
+        uint32_t margin_pct;                /// Margen sobre el mayor intervalo entre flancos de un rebote (%)
+        uint32_t min_us;                    /// Ventana minima
+        uint32_t learn_bursts;              /// Rafagas con la ventana maxima antes de aplicar la aprendida
+        Config() : margin_pct(50), min_us(2000), learn_bursts(8) {}
+    };
+
+    /** Estadisticas del aprendizaje */
+    struct Stats{
+        uint32_t window_us;                 /// Ventana de filtrado aplicada
+        uint32_t gap_us;                    /// Mayor intervalo reciente entre flancos de un rebote
+        uint32_t last_bounce_us;            /// Duracion del ultimo rebote (primer a ultimo flanco)
+        uint32_t max_bounce_us;             /// Duracion maxima de un rebote
+        uint32_t bursts;                    /// Rafagas medidas
+        uint32_t late_bounces;              /// Rebotes que continuaron tras resolver la rafaga
+        uint32_t noise_errors;              /// Errores de ruido notificados
+    };
+
+
+	/** Constructor
+	 *  @param max_us Ventana maxima (configurada en el pulsador)
+	 */
+	PushButtonBounceEstimator(uint32_t max_us = 20000) {
+		setup(Config(), max_us);
+	}
+
+
+	/** setup
+     *  Configura el aprendizaje y lo reinicia
+     *  @param cfg Parametros del aprendizaje
+     *  @param max_us Ventana maxima (configurada en el pulsador)
+     */
+	void setup(const Config& cfg, uint32_t max_us){
+		_cfg = cfg;
+		_max_us = (max_us > 0)? max_us : 1;
+		_cfg.min_us = (_cfg.min_us < _max_us)? _cfg.min_us : _max_us;
+		_gap_us = 0;
+		_in_burst = false;
+		_has_prev = false;
+		_window_us = _max_us;
+		_stats.last_bounce_us = 0;
+		_stats.max_bounce_us = 0;
+		_stats.bursts = 0;
+		_stats.late_bounces = 0;
+		_stats.noise_errors = 0;
+	}
+
+
+	/** edge
+     *  Registra un flanco
+     *  @param ts_us Instante del flanco
+     */
+	void edge(uint32_t ts_us){
+		if(!_in_burst){
+			_in_burst = true;
+			_first_us = ts_us;
+			_burst_gap_us = 0;
+			// una rafaga poco despues de la anterior puede ser la continuacion de su rebote
+			_late_gap_us = (_has_prev && (uint32_t)(ts_us - _last_us) < 2 * _window_us)? (ts_us - _last_us) : 0;
+		}
+		else if((uint32_t)(ts_us - _last_us) > _burst_gap_us){
+			_burst_gap_us = ts_us - _last_us;
+		}
+		_last_us = ts_us;
+	}
+
+
+	/** resolve
+     *  Finaliza la rafaga en curso y actualiza la ventana
+     *  @param changed true si la rafaga ha cambiado el nivel estable
+     */
+	void resolve(bool changed){
+		if(!_in_burst){
+			return;
+		}
+		_in_burst = false;
+		_has_prev = true;
+		uint32_t sample = _burst_gap_us;
+		if(!changed && _late_gap_us > 0){
+			// la rafaga vuelve al nivel estable: es un rebote que la ventana no llego a cubrir
+			sample = (_late_gap_us > sample)? _late_gap_us : sample;
+			_stats.late_bounces++;
+		}
+		_stats.last_bounce_us = _last_us - _first_us;
+		_stats.max_bounce_us = (_stats.last_bounce_us > _stats.max_bounce_us)? _stats.last_bounce_us : _stats.max_bounce_us;
+		_stats.bursts++;
+		_gap_us = (sample >= _gap_us)? sample : (_gap_us - ((_gap_us - sample) >> 5));
+		update();
+	}
+
+
+	/** noise
+     *  Notifica un error de ruido (nivel del pin distinto del filtrado), duplicando la ventana
+     */
+	void noise(){
+		_stats.noise_errors++;
+		_gap_us = (_gap_us > _max_us / 2)? _max_us : ((_gap_us > 0)? (2 * _gap_us) : _cfg.min_us);
+		update();
+	}
+
+
+	/** getWindow
+     *  Obtiene la ventana de filtrado a aplicar
+     *  @return Microsegundos
+     */
+	uint32_t getWindow() { return _window_us; }
+
+
+	/** getStats
+     *  Obtiene las estadisticas del aprendizaje
+     *  @param stats Recibe las estadisticas
+     */
+	void getStats(Stats& stats){
+		stats = _stats;
+		stats.window_us = _window_us;
+		stats.gap_us = _gap_us;
+	}
+
+  private:
+	Config _cfg;							/// Parametros del aprendizaje
+	Stats _stats;							/// Estadisticas
+	uint32_t _max_us;						/// Ventana maxima
+	uint32_t _window_us;					/// Ventana aplicada
+	uint32_t _gap_us;						/// Mayor intervalo reciente entre flancos de un rebote
+	uint32_t _first_us;						/// Instante del primer flanco de la rafaga
+	uint32_t _last_us;						/// Instante del ultimo flanco
+	uint32_t _burst_gap_us;					/// Mayor intervalo entre flancos de la rafaga en curso
+	uint32_t _late_gap_us;					/// Intervalo desde la rafaga anterior (0 si no es continuacion)
+	bool _in_burst;							/// Rafaga en curso
+	bool _has_prev;							/// Existe una rafaga anterior
+
+	/** update
+     *  Recalcula la ventana a partir del intervalo aprendido
+     */
+	void update(){
+		if(_stats.bursts < _cfg.learn_bursts){
+			_window_us = _max_us;
+			return;
+		}
+		uint64_t w = (uint64_t)_gap_us * (100 + _cfg.margin_pct) / 100;
+		_window_us = (w < _cfg.min_us)? _cfg.min_us : ((w > _max_us)? _max_us : (uint32_t)w);
+	}
+};
+
+
+#endif /*__PushButtonBounceEstimator__H */
+
+/**** END OF FILE ****/
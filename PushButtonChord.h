@@ -0,0 +1,281 @@
+/*
+ * PushButtonChord.h
+ *
+ *  Created on: Oct 2026
+ *      Author: raulMrello
+ *
+ *	PushButtonChord es el detector de combinaciones de pulsadores (p.ej. "A+B mantenidos 3s"). Recibe los eventos
+ *  press/release ya filtrados de varios pulsadores, identificados por su posicion (0..31), y mantiene el conjunto de
+ *  pulsadores activos como una mascara de bits.
+ *
+ *  Los pulsadores que forman parte de alguna combinacion se asignan a una de las MaxInputs entradas del detector, y
+ *  la tabla _table, indexada directamente por la mascara de entradas pulsadas, se precalcula al registrar cada
+ *  combinacion. Por tanto, cada evento se resuelve con una unica lectura de la tabla independientemente del numero
+ *  de combinaciones registradas.
+ *
+ *  Una combinacion se activa (EventPress) cuando el conjunto de entradas pulsadas coincide con ella y todas sus
+ *  entradas se han pulsado dentro de la ventana de tolerancia desde la primera. Si se configura un tiempo de
+ *  mantenimiento, genera EventHold una vez transcurrido. Finaliza (EventRelease) al liberar o anadir cualquier
+ *  entrada. Tras liberar una entrada no se reconoce ninguna combinacion hasta que se liberan todas.
+ *
+ *  Cada llamada a press, release o update registra como maximo MaxPending eventos, que se extraen con poll. El
+ *  llamante debe extraerlos tras cada llamada: los que no caben se descartan y se contabilizan (ver getDropCount).
+ *
+ *  No utiliza temporizadores (ver getRemaining) y no depende del HAL.
+ */
+
+#ifndef __PushButtonChord__H
+#define __PushButtonChord__H
+
+#include <stdint.h>
+
+
+class PushButtonChord {
+  public:
+	static const uint32_t MaxKeys = 32;					/// Posiciones de pulsador admitidas
+	static const uint32_t MaxInputs = 8;				/// Pulsadores distintos en el conjunto de combinaciones
+	static const uint32_t MaxChords = 16;				/// Numero maximo de combinaciones
+	static const uint32_t MaxPending = 2;				/// Eventos pendientes de extraer (maximo por llamada)
+
+    enum Event{
+        EventPress,                         /// Combinacion completada
+        EventHold,                          /// Combinacion mantenida durante el tiempo configurado
+        EventRelease                        /// Combinacion finalizada
+    };
+
+	/** Constructor
+	 *  @param tolerance_us Tiempo maximo entre la primera y la ultima pulsacion de una combinacion
+	 */
+	PushButtonChord(uint32_t tolerance_us = 150000) {
+		_tolerance_us = tolerance_us;
+		_num_inputs = 0;
+		_num_chords = 0;
+		for(uint32_t i = 0; i < MaxKeys; i++){
+			_input[i] = -1;
+		}
+		for(uint32_t i = 0; i < (1u << MaxInputs); i++){
+			_table[i] = 0;
+		}
+		_drops = 0;
+		reset();
+	}
+
+
+	/** setTolerance
+     *  Configura la ventana de tolerancia
+     *  @param tolerance_us Tiempo maximo entre la primera y la ultima pulsacion de una combinacion
+     */
+	void setTolerance(uint32_t tolerance_us) { _tolerance_us = tolerance_us; }
+
+
+	/** addChord
+     *  Registra una combinacion
+     *  @param chord_id Identificador notificado con los eventos de la combinacion
+     *  @param keys Mascara de posiciones de los pulsadores que la forman
+     *  @param hold_us Tiempo de mantenimiento para generar EventHold (0: sin evento hold)
+     *  @return true si se registra, false si no quedan combinaciones o entradas libres o ya existe
+     */
+	bool addChord(uint32_t chord_id, uint32_t keys, uint32_t hold_us = 0){
+		if(keys == 0 || _num_chords >= MaxChords){
+			return false;
+		}
+		// comprueba que hay entradas suficientes antes de asignarlas
+		uint32_t needed = 0;
+		for(uint32_t m = keys; m != 0; m &= (m - 1)){
+			needed += (_input[__builtin_ctz(m)] < 0)? 1 : 0;
+		}
+		if(_num_inputs + needed > MaxInputs){
+			return false;
+		}
+		uint32_t inputs = 0;
+		for(uint32_t m = keys; m != 0; m &= (m - 1)){
+			uint32_t key = __builtin_ctz(m);
+			if(_input[key] < 0){
+				_input[key] = (int8_t)_num_inputs++;
+			}
+			inputs |= (1u << _input[key]);
+		}
+		if(_table[inputs] != 0){
+			return false;
+		}
+		_chord_id[_num_chords] = chord_id;
+		_hold_us[_num_chords] = hold_us;
+		_num_chords++;
+		_table[inputs] = (uint8_t)_num_chords;
+		return true;
+	}
+
+
+	/** reset
+     *  Descarta el conjunto de pulsadores activos y los eventos pendientes
+     */
+	void reset(){
+		_pressed = 0;
+		_active = 0;
+		_locked = false;
+		_held = false;
+		_first_us = 0;
+		_match_us = 0;
+		_count = 0;
+	}
+
+
+	/** press
+     *  Registra la pulsacion de un pulsador
+     *  @param key Posicion del pulsador
+     *  @param ts_us Instante de la pulsacion
+     */
+	void press(uint8_t key, uint32_t ts_us){
+		if(key >= MaxKeys || _input[key] < 0){
+			return;
+		}
+		if(_pressed == 0){
+			_first_us = ts_us;
+			_locked = false;
+		}
+		_pressed |= (uint8_t)(1u << _input[key]);
+		// una entrada adicional finaliza la combinacion activa, aunque puede completar otra mayor
+		if(_active){
+			emit(EventRelease, _active - 1);
+			_active = 0;
+		}
+		uint8_t chord = _table[_pressed];
+		if(!_locked && chord != 0 && (uint32_t)(ts_us - _first_us) <= _tolerance_us){
+			_active = chord;
+			_held = false;
+			_match_us = ts_us;
+			emit(EventPress, chord - 1);
+		}
+	}
+
+
+	/** release
+     *  Registra la liberacion de un pulsador
+     *  @param key Posicion del pulsador
+     *  @param ts_us Instante de la liberacion
+     */
+	void release(uint8_t key, uint32_t ts_us){
+		if(key >= MaxKeys || _input[key] < 0){
+			return;
+		}
+		update(ts_us);
+		_pressed &= (uint8_t)~(1u << _input[key]);
+		if(_active){
+			emit(EventRelease, _active - 1);
+			_active = 0;
+		}
+		_locked = (_pressed != 0);
+	}
+
+
+	/** update
+     *  Evalua el tiempo de mantenimiento de la combinacion activa
+     *  @param now_us Instante actual
+     */
+	void update(uint32_t now_us){
+		if(isPending() && (uint32_t)(now_us - _match_us) >= _hold_us[_active - 1]){
+			_held = true;
+			emit(EventHold, _active - 1);
+		}
+	}
+
+
+	/** getRemaining
+     *  Obtiene el tiempo que falta para el evento hold de la combinacion activa
+     *  @param now_us Instante actual
+     *  @return Microsegundos restantes, o NoDeadline si no hay ninguno en curso
+     */
+	uint32_t getRemaining(uint32_t now_us){
+		if(!isPending()){
+			return NoDeadline;
+		}
+		uint32_t elapsed = now_us - _match_us;
+		return (elapsed >= _hold_us[_active - 1])? 0 : (_hold_us[_active - 1] - elapsed);
+	}
+
+
+	/** isPending
+     *  Comprueba si hay un evento hold en curso
+     *  @return true si hay que volver a evaluar la combinacion activa
+     */
+	bool isPending() { return (_active != 0 && !_held && _hold_us[_active - 1] > 0); }
+
+
+	/** getPressedInputs
+     *  Obtiene el conjunto de entradas pulsadas
+     *  @return Mascara de entradas
+     */
+	uint8_t getPressedInputs() { return _pressed; }
+
+
+	/** getDropCount
+     *  Obtiene el numero de eventos descartados por no extraerse con poll tras cada llamada
+     *  @return Eventos descartados
+     */
+	uint32_t getDropCount() { return _drops; }
+
+
+	/** poll
+     *  Extrae el evento mas antiguo. Debe invocarse hasta vaciar los eventos tras cada press, release o update
+     *  @param event Recibe el evento
+     *  @param chord_id Recibe el identificador de la combinacion
+     *  @return true si habia algun evento pendiente
+     */
+	bool poll(Event& event, uint32_t& chord_id){
+		if(_count == 0){
+			return false;
+		}
+		event = (Event)_out[0].event;
+		chord_id = _chord_id[_out[0].chord];
+		for(uint32_t i = 1; i < _count; i++){
+			_out[i - 1] = _out[i];
+		}
+		_count--;
+		return true;
+	}
+
+	/** Valor de getRemaining sin eventos en curso */
+	static const uint32_t NoDeadline = 0xFFFFFFFF;
+
+  private:
+
+    struct Output{
+        uint8_t event;
+        uint8_t chord;
+    };
+
+	uint32_t _tolerance_us;					/// Ventana de tolerancia
+	int8_t _input[MaxKeys];					/// Entrada asignada a cada posicion (-1: ninguna)
+	uint8_t _table[1u << MaxInputs];		/// Combinacion (indice + 1) por mascara de entradas pulsadas
+	uint32_t _chord_id[MaxChords];			/// Identificador de cada combinacion
+	uint32_t _hold_us[MaxChords];			/// Tiempo de mantenimiento de cada combinacion
+	uint8_t _num_inputs;
+	uint8_t _num_chords;
+	uint8_t _pressed;						/// Entradas pulsadas
+	uint8_t _active;						/// Combinacion activa (indice + 1, 0: ninguna)
+	bool _locked;							/// Combinaciones bloqueadas hasta liberar todas las entradas
+	bool _held;								/// Evento hold de la combinacion activa notificado
+	uint32_t _first_us;						/// Instante de la primera pulsacion del conjunto
+	uint32_t _match_us;						/// Instante de activacion de la combinacion
+	uint8_t _count;							/// Eventos pendientes de extraer
+	Output _out[MaxPending];				/// Eventos pendientes de extraer
+	uint32_t _drops;						/// Eventos descartados con el buffer lleno
+
+	/** emit
+     *  Registra un evento, o lo contabiliza como descartado si el llamante no ha extraido los anteriores
+     */
+	void emit(Event event, uint8_t chord){
+		if(_count >= MaxPending){
+			_drops++;
+			return;
+		}
+		_out[_count].event = (uint8_t)event;
+		_out[_count].chord = chord;
+		_count++;
+	}
+};
+
+
+#endif /*__PushButtonChord__H */
+
+/**** END OF FILE ****/
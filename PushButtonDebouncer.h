@@ -0,0 +1,195 @@
+/*
+ * PushButtonDebouncer.h
+ *
+ *  Created on: Oct 2026
+ *      Author: raulMrello
+ *
+ *	PushButtonDebouncer es el motor de filtrado anti-rebotes basado en las marcas de tiempo de los flancos.
+ *  A diferencia del filtrado por temporizador, no necesita reiniciar un timer en cada flanco: el nivel estable
+ *  se deduce del historico de flancos y el hilo de despacho solo necesita despertar en el instante devuelto por
+ *  getRemaining(), que se reprograma una vez por lote de flancos como timeout de su espera.
+ *
+ *  Dispone de dos politicas:
+ *  - StableTime: el nivel es estable cuando se mantiene sin flancos durante la ventana configurada.
+ *  - Integrator: integra el tiempo en nivel alto (suma) y bajo (resta) saturando en [0, ventana]. La salida
+ *    cambia al alcanzar uno de los extremos, por lo que tolera rebotes que no llegan a cesar por completo.
+ *
+ *  No depende del HAL, por lo que puede utilizarse y verificarse en el host. Todos los instantes son contadores
+ *  de 32 bits en microsegundos y se comparan por diferencia, tolerando el desbordamiento del contador.
+ */
+
+#ifndef __PushButtonDebouncer__H
+#define __PushButtonDebouncer__H
+
+#include <stdint.h>
+
+
+class PushButtonDebouncer {
+  public:
+
+    enum Mode{
+        StableTime,
+        Integrator
+    };
+
+	/** Constructor
+	 *  @param mode Politica de filtrado
+	 *  @param window_us Ventana de filtrado en microsegundos
+	 */
+	PushButtonDebouncer(Mode mode = StableTime, uint32_t window_us = 20000) {
+		setup(mode, window_us);
+		reset(0, 0);
+	}
+
+
+	/** setup
+     *  Configura la politica y la ventana de filtrado
+     *  @param mode Politica de filtrado
+     *  @param window_us Ventana de filtrado en microsegundos
+     */
+	void setup(Mode mode, uint32_t window_us){
+		_mode = mode;
+		_window_us = (window_us > 0)? window_us : 1;
+	}
+
+
+	/** reset
+     *  Fija el nivel actual como estable, descartando cualquier rafaga en curso
+     *  @param level Nivel actual del pin
+     *  @param now_us Instante actual
+     */
+	void reset(uint8_t level, uint32_t now_us){
+		_raw = level;
+		_stable = level;
+		_changed = false;
+		_pending = false;
+		_last_us = now_us;
+		_burst_us = now_us;
+		_integ_us = (level)? _window_us : 0;
+	}
+
+
+	/** edge
+     *  Registra un flanco
+     *  @param level Nivel del pin tras el flanco
+     *  @param ts_us Instante del flanco
+     */
+	void edge(uint8_t level, uint32_t ts_us){
+		if(_mode == Integrator){
+			integrate(ts_us);
+		}
+		if(!_pending){
+			_pending = true;
+			_burst_us = ts_us;
+		}
+		_raw = level;
+		_last_us = ts_us;
+	}
+
+
+	/** update
+     *  Evalua el filtro en el instante actual
+     *  @param now_us Instante actual
+     *  @return true si el nivel estable ha cambiado desde la ultima llamada
+     */
+	bool update(uint32_t now_us){
+		if(_pending){
+			if(_mode == Integrator){
+				integrate(now_us);
+				if(_integ_us == 0 || _integ_us == _window_us){
+					_pending = (_raw != _stable);
+				}
+			}
+			else if((uint32_t)(now_us - _last_us) >= _window_us){
+				_changed |= (_raw != _stable);
+				_stable = _raw;
+				_pending = false;
+			}
+		}
+		bool changed = _changed;
+		_changed = false;
+		return changed;
+	}
+
+
+	/** getRemaining
+     *  Obtiene el tiempo que falta para poder resolver la rafaga en curso
+     *  @param now_us Instante actual
+     *  @return Microsegundos restantes (0 si ya puede resolverse)
+     */
+	uint32_t getRemaining(uint32_t now_us){
+		uint32_t elapsed = now_us - _last_us;
+		if(_mode == Integrator){
+			uint32_t left = (_raw)? (_window_us - _integ_us) : _integ_us;
+			return (elapsed >= left)? 0 : (left - elapsed);
+		}
+		return (elapsed >= _window_us)? 0 : (_window_us - elapsed);
+	}
+
+
+	/** isPending
+     *  Comprueba si hay una rafaga de flancos sin resolver
+     *  @return true si hay que volver a evaluar el filtro
+     */
+	bool isPending() { return _pending; }
+
+
+	/** getStable
+     *  Obtiene el ultimo nivel estable
+     *  @return Nivel estable
+     */
+	uint8_t getStable() { return _stable; }
+
+
+	/** getRaw
+     *  Obtiene el nivel tras el ultimo flanco registrado
+     *  @return Nivel sin filtrar
+     */
+	uint8_t getRaw() { return _raw; }
+
+
+	/** getBurstStart
+     *  Obtiene el instante del primer flanco de la ultima rafaga
+     *  @return Instante en microsegundos
+     */
+	uint32_t getBurstStart() { return _burst_us; }
+
+  private:
+	Mode _mode;								/// Politica de filtrado
+	uint32_t _window_us;					/// Ventana de filtrado
+	uint32_t _last_us;						/// Instante del ultimo flanco o integracion
+	uint32_t _burst_us;						/// Instante del primer flanco de la rafaga
+	uint32_t _integ_us;						/// Valor del integrador [0, _window_us]
+	uint8_t _raw;							/// Nivel tras el ultimo flanco
+	uint8_t _stable;						/// Nivel estable
+	bool _pending;							/// Rafaga sin resolver
+	bool _changed;							/// Cambio de nivel estable pendiente de notificar
+
+	/** integrate
+     *  Avanza el integrador hasta el instante indicado con el nivel actual
+     *  @param now_us Instante hasta el que integrar
+     */
+	void integrate(uint32_t now_us){
+		uint32_t dt = now_us - _last_us;
+		_last_us = now_us;
+		if(_raw){
+			_integ_us = (dt >= (_window_us - _integ_us))? _window_us : (_integ_us + dt);
+			if(_integ_us == _window_us && _stable == 0){
+				_stable = 1;
+				_changed = true;
+			}
+		}
+		else{
+			_integ_us = (dt >= _integ_us)? 0 : (_integ_us - dt);
+			if(_integ_us == 0 && _stable == 1){
+				_stable = 0;
+				_changed = true;
+			}
+		}
+	}
+};
+
+
+#endif /*__PushButtonDebouncer__H */
+
+/**** END OF FILE ****/
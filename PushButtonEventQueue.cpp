@@ -0,0 +1,88 @@
+/*
+ * PushButtonEventQueue.cpp
+ *
+ *  Created on: Oct 2026
+ *      Author: raulMrello
+ */
+
+#include "PushButtonEventQueue.h"
+
+
+
+//------------------------------------------------------------------------------------
+//-- PUBLIC METHODS IMPLEMENTATION ---------------------------------------------------
+//------------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------------
+PushButtonEventQueue::PushButtonEventQueue(PushButton::Event* buf, uint32_t size) {
+	MBED_ASSERT(buf && size > 0 && (size & (size - 1)) == 0);
+	_buf = buf;
+	_size = size;
+	_head = 0;
+	_tail = 0;
+	_overflows = 0;
+	_max_usage = 0;
+	_notifyCb = (Callback<void()>) NULL;
+}
+
+
+//------------------------------------------------------------------------------------
+bool PushButtonEventQueue::post(const PushButton::Event& ev){
+	core_util_critical_section_enter();
+	uint32_t used = _head - _tail;
+	if(used >= _size){
+		_overflows++;
+		core_util_critical_section_exit();
+		return false;
+	}
+	_buf[_head & (_size - 1)] = ev;
+	_head++;
+	_max_usage = (used + 1 > _max_usage)? (used + 1) : _max_usage;
+	core_util_critical_section_exit();
+
+	// solo notifica al consumidor si no tenia eventos pendientes
+	if(used == 0 && _notifyCb){
+		_notifyCb.call();
+	}
+	return true;
+}
+
+
+//------------------------------------------------------------------------------------
+bool PushButtonEventQueue::pop(PushButton::Event& ev){
+	core_util_critical_section_enter();
+	bool result = (_tail != _head);
+	if(result){
+		ev = _buf[_tail & (_size - 1)];
+		_tail++;
+	}
+	core_util_critical_section_exit();
+	return result;
+}
+
+
+//------------------------------------------------------------------------------------
+uint32_t PushButtonEventQueue::dispatch(uint32_t max){
+	uint32_t count = 0;
+	PushButton::Event ev;
+	while(count < max && pop(ev)){
+		if(ev.btn){
+			ev.btn->deliverEvent(ev);
+		}
+		count++;
+	}
+	return count;
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonEventQueue::purge(PushButton* btn){
+	core_util_critical_section_enter();
+	for(uint32_t i = _tail; i != _head; i++){
+		if(_buf[i & (_size - 1)].btn == btn){
+			_buf[i & (_size - 1)].btn = NULL;
+		}
+	}
+	core_util_critical_section_exit();
+}
@@ -0,0 +1,111 @@
+/*
+ * PushButtonEventQueue.h
+ *
+ *  Created on: Oct 2026
+ *      Author: raulMrello
+ *
+ *	PushButtonEventQueue es la cola de entrega diferida de eventos de PushButton. Los pulsadores asociados con
+ *  PushButton::setEventQueue insertan un registro compacto por evento (press, hold, release o gesto) en lugar de
+ *  invocar sus callbacks, y la aplicacion los consume por lotes desde su propio hilo con dispatch(), que invoca las
+ *  callbacks instaladas en cada pulsador, o con pop() para procesar directamente los registros.
+ *
+ *  No reserva memoria: el almacenamiento lo proporciona el llamante. Admite varios productores (hilos de los
+ *  pulsadores y gestores) y un unico consumidor. La insercion se realiza en una seccion critica
+ *  de pocas instrucciones. Si la cola esta llena, el evento se descarta y se incrementa el contador de
+ *  desbordamientos.
+ *
+ *  La callback instalada con attach() se invoca desde el productor cuando la cola pasa de vacia a no vacia, para
+ *  despertar al consumidor (p.ej. Thread::signal_set o EventQueue::call del hilo de la aplicacion).
+ */
+
+#ifndef __PushButtonEventQueue__H
+#define __PushButtonEventQueue__H
+
+#include "mbed.h"
+#include "PushButton.h"
+#include <atomic>
+
+
+class PushButtonEventQueue {
+  public:
+
+	/** Constructor
+	 *  @param buf Almacenamiento de los registros
+	 *  @param size Numero de registros del almacenamiento (potencia de 2)
+	 */
+	PushButtonEventQueue(PushButton::Event* buf, uint32_t size);
+
+
+	/** attach
+     *  Instala la callback de notificacion de eventos pendientes
+     *  @param notifyCb Callback a instalar (se ejecuta en el contexto del productor)
+     */
+	void attach(Callback<void()> notifyCb) { _notifyCb = notifyCb; }
+
+
+	/** post
+     *  Inserta un evento. Puede invocarse desde cualquier hilo
+     *  @param ev Evento
+     *  @return true si se inserta, false si la cola esta llena
+     */
+	bool post(const PushButton::Event& ev);
+
+
+	/** pop
+     *  Extrae el evento mas antiguo. Solo puede invocarse desde el consumidor
+     *  @param ev Recibe el evento
+     *  @return true si se extrae, false si la cola esta vacia
+     */
+	bool pop(PushButton::Event& ev);
+
+
+	/** dispatch
+     *  Extrae los eventos pendientes e invoca las callbacks del pulsador que los genero. Solo puede invocarse
+     *  desde el consumidor
+     *  @param max Numero maximo de eventos a procesar
+     *  @return Numero de eventos procesados
+     */
+	uint32_t dispatch(uint32_t max = 0xFFFFFFFF);
+
+
+	/** purge
+     *  Descarta los eventos pendientes de un pulsador (invocado desde su destructor)
+     *  @param btn Pulsador
+     */
+	void purge(PushButton* btn);
+
+
+	/** size
+     *  Obtiene el numero de eventos pendientes
+     *  @return Eventos pendientes
+     */
+	uint32_t size() { return _head - _tail; }
+
+
+	/** getOverflowCount
+     *  Obtiene el numero de eventos descartados por desbordamiento
+     *  @return Eventos descartados
+     */
+	uint32_t getOverflowCount() { return _overflows; }
+
+
+	/** getMaxUsage
+     *  Obtiene la ocupacion maxima alcanzada, para dimensionar el almacenamiento
+     *  @return Eventos
+     */
+	uint32_t getMaxUsage() { return _max_usage; }
+
+  private:
+	PushButton::Event* _buf;				/// Almacenamiento
+	uint32_t _size;							/// Numero de registros (potencia de 2)
+	std::atomic<uint32_t> _head;			/// Contador libre de inserciones
+	std::atomic<uint32_t> _tail;			/// Contador libre de extracciones
+	std::atomic<uint32_t> _overflows;		/// Eventos descartados
+	uint32_t _max_usage;					/// Ocupacion maxima
+	Callback<void()> _notifyCb;				/// Notificacion de eventos pendientes
+};
+
+
+#endif /*__PushButtonEventQueue__H */
+
+/**** END OF FILE ****/
@@ -0,0 +1,226 @@
+/*
+ * PushButtonGesture.h
+ *
+ *  Created on: Oct 2026
+ *      Author: raulMrello
+ *
+ *	PushButtonGesture es el reconocedor de gestos construido sobre los eventos press/release ya filtrados de un
+ *  pulsador. Reconoce secuencias de pulsaciones cortas (Click, DoubleClick, TripleClick y MultiClick con su numero
+ *  de pulsaciones), pulsaciones largas (LongPress al superar el umbral, sin esperar a la liberacion) y la liberacion
+ *  posterior (LongRelease).
+ *
+ *  No utiliza temporizadores: las duraciones se obtienen de las marcas de tiempo de los eventos y el hilo de
+ *  despacho solo necesita invocar update() en el instante devuelto por getRemaining(), igual que con
+ *  PushButtonDebouncer. El estado por pulsador ocupa unos pocos bytes. No depende del HAL.
+ *
+ *  Los gestos reconocidos se acumulan (como maximo 2 por evento, p.ej. Click y LongPress si tras una pulsacion corta
+ *  se realiza una larga) y se extraen con poll().
+ */
+
+#ifndef __PushButtonGesture__H
+#define __PushButtonGesture__H
+
+#include <stdint.h>
+
+
+class PushButtonGesture {
+  public:
+
+    enum Gesture{
+        GestureClick,                       /// Una pulsacion corta
+        GestureDoubleClick,                 /// Dos pulsaciones cortas
+        GestureTripleClick,                 /// Tres pulsaciones cortas
+        GestureMultiClick,                  /// Mas de tres pulsaciones cortas (ver numero de pulsaciones)
+        GestureLongPress,                   /// Pulsacion mantenida durante el umbral configurado
+        GestureLongRelease                  /// Liberacion tras una pulsacion larga
+    };
+
+    /** Ventanas de reconocimiento */
+    struct Config{
+        uint32_t click_gap_us;              /// Tiempo maximo desde una liberacion hasta la siguiente pulsacion de la secuencia
+        uint32_t long_press_us;             /// Duracion minima de una pulsacion larga
+        uint8_t max_clicks;                 /// Pulsaciones tras las que se notifica sin esperar (0: sin limite)
+
+        Config(uint32_t gap_us = 300000, uint32_t long_us = 800000, uint8_t max = 3)
+        	: click_gap_us(gap_us), long_press_us(long_us), max_clicks(max) {}
+    };
+
+	/** Constructor
+	 *  @param cfg Ventanas de reconocimiento
+	 */
+	PushButtonGesture(const Config& cfg = Config()) {
+		setup(cfg);
+	}
+
+
+	/** setup
+     *  Configura las ventanas de reconocimiento y descarta la secuencia en curso
+     *  @param cfg Ventanas de reconocimiento
+     */
+	void setup(const Config& cfg){
+		_cfg = cfg;
+		_cfg.long_press_us = (_cfg.long_press_us > 0)? _cfg.long_press_us : 1;
+		reset();
+	}
+
+
+	/** reset
+     *  Descarta la secuencia en curso y los gestos pendientes de extraer
+     */
+	void reset(){
+		_state = StIdle;
+		_clicks = 0;
+		_count = 0;
+		_t_us = 0;
+	}
+
+
+	/** press
+     *  Registra una pulsacion
+     *  @param ts_us Instante de la pulsacion
+     */
+	void press(uint32_t ts_us){
+		update(ts_us);
+		if(_state == StIdle){
+			_clicks = 0;
+		}
+		_state = StDown;
+		_t_us = ts_us;
+	}
+
+
+	/** release
+     *  Registra una liberacion
+     *  @param ts_us Instante de la liberacion
+     */
+	void release(uint32_t ts_us){
+		update(ts_us);
+		if(_state == StLongDown){
+			emit(GestureLongRelease, 0);
+			_state = StIdle;
+			return;
+		}
+		if(_state != StDown){
+			return;
+		}
+		_clicks = (_clicks < 0xFF)? (_clicks + 1) : _clicks;
+		_t_us = ts_us;
+		if(_cfg.max_clicks != 0 && _clicks >= _cfg.max_clicks){
+			emitClicks();
+			_state = StIdle;
+			return;
+		}
+		_state = StUp;
+	}
+
+
+	/** update
+     *  Evalua las ventanas en el instante actual
+     *  @param now_us Instante actual
+     */
+	void update(uint32_t now_us){
+		uint32_t elapsed = now_us - _t_us;
+		if(_state == StDown && elapsed >= _cfg.long_press_us){
+			// las pulsaciones cortas previas se notifican antes que la pulsacion larga
+			emitClicks();
+			emit(GestureLongPress, 0);
+			_state = StLongDown;
+		}
+		else if(_state == StUp && elapsed > _cfg.click_gap_us){
+			emitClicks();
+			_state = StIdle;
+		}
+	}
+
+
+	/** getRemaining
+     *  Obtiene el tiempo que falta para la siguiente evaluacion de las ventanas
+     *  @param now_us Instante actual
+     *  @return Microsegundos restantes, o NoDeadline si no hay ninguna ventana en curso
+     */
+	uint32_t getRemaining(uint32_t now_us){
+		uint32_t elapsed = now_us - _t_us;
+		if(_state == StDown){
+			return (elapsed >= _cfg.long_press_us)? 0 : (_cfg.long_press_us - elapsed);
+		}
+		if(_state == StUp){
+			return (elapsed > _cfg.click_gap_us)? 0 : (_cfg.click_gap_us - elapsed + 1);
+		}
+		return NoDeadline;
+	}
+
+
+	/** isPending
+     *  Comprueba si hay alguna ventana en curso
+     *  @return true si hay que volver a evaluar las ventanas
+     */
+	bool isPending() { return (_state == StDown || _state == StUp); }
+
+
+	/** poll
+     *  Extrae el gesto reconocido mas antiguo
+     *  @param gesture Recibe el gesto
+     *  @param clicks Recibe el numero de pulsaciones cortas (0 en los gestos de pulsacion larga)
+     *  @return true si habia algun gesto pendiente
+     */
+	bool poll(Gesture& gesture, uint8_t& clicks){
+		if(_count == 0){
+			return false;
+		}
+		gesture = (Gesture)_out[0].gesture;
+		clicks = _out[0].clicks;
+		_out[0] = _out[1];
+		_count--;
+		return true;
+	}
+
+	/** Valor de getRemaining sin ventanas en curso */
+	static const uint32_t NoDeadline = 0xFFFFFFFF;
+
+  private:
+
+    enum State{
+        StIdle,                             /// Sin secuencia en curso
+        StDown,                             /// Pulsado, antes del umbral de pulsacion larga
+        StUp,                               /// Liberado, esperando la siguiente pulsacion de la secuencia
+        StLongDown                          /// Pulsacion larga notificada, esperando la liberacion
+    };
+
+    struct Output{
+        uint8_t gesture;
+        uint8_t clicks;
+    };
+
+	Config _cfg;							/// Ventanas de reconocimiento
+	uint32_t _t_us;							/// Instante de la ultima pulsacion o liberacion
+	uint8_t _state;							/// Estado de la secuencia
+	uint8_t _clicks;						/// Pulsaciones cortas de la secuencia en curso
+	uint8_t _count;							/// Gestos pendientes de extraer
+	Output _out[2];							/// Gestos pendientes de extraer
+
+	/** emit
+     *  Registra un gesto reconocido
+     */
+	void emit(Gesture gesture, uint8_t clicks){
+		if(_count < 2){
+			_out[_count].gesture = (uint8_t)gesture;
+			_out[_count].clicks = clicks;
+			_count++;
+		}
+	}
+
+	/** emitClicks
+     *  Registra el gesto correspondiente a las pulsaciones cortas acumuladas
+     */
+	void emitClicks(){
+		if(_clicks > 0){
+			emit((_clicks >= 4)? GestureMultiClick : (Gesture)(GestureClick + _clicks - 1), _clicks);
+			_clicks = 0;
+		}
+	}
+};
+
+
+#endif /*__PushButtonGesture__H */
+
+/**** END OF FILE ****/
@@ -0,0 +1,124 @@
+/*
+ * PushButtonLatch.h
+ *
+ *  Created on: Oct 2026
+ *      Author: raulMrello
+ *
+ *	PushButtonLatch publica una configuracion (p.ej. el conjunto de callbacks de un pulsador) de forma que los
+ *  lectores (hilo de despacho, servicio de timers) nunca observan una configuracion a medio actualizar, sin
+ *  bloqueos ni secciones criticas en el camino de lectura.
+ *
+ *  Cada configuracion publicada es inmutable. El escritor prepara la nueva configuracion en una posicion libre
+ *  (edit) y la publica con una unica escritura atomica del indice (publish). Cada lector marca la posicion que
+ *  utiliza con un contador de referencias y comprueba que sigue publicada tras marcarla, de forma que el escritor
+ *  nunca reutiliza una posicion en uso. El escritor solo espera si lectores concurrentes retienen todas las
+ *  posiciones libres.
+ *
+ *  Con Slots = 2 (una copia publicada y otra en edicion) los lectores no deben retener la configuracion mientras
+ *  ejecutan codigo que pueda publicar otra, p.ej. copiando la callback antes de invocarla: en caso contrario dos
+ *  publicaciones consecutivas desde ese codigo esperarian indefinidamente. Con Slots >= 3, un lector puede
+ *  retenerla mientras reconfigura desde su propia callback.
+ *
+ *  Los lectores no esperan nunca al escritor. Los escritores deben serializarse externamente (p.ej. Mutex).
+ */
+
+#ifndef __PushButtonLatch__H
+#define __PushButtonLatch__H
+
+#include "mbed.h"
+#include <stdint.h>
+#include <atomic>
+
+
+template <typename T, uint32_t Slots = 3>
+class PushButtonLatch {
+	static_assert(Slots >= 2, "PushButtonLatch: se requieren al menos 2 posiciones");
+
+  public:
+
+	/** Acceso de lectura a la configuracion publicada, que se mantiene valida mientras exista el objeto */
+	class Reader {
+	  public:
+		Reader(PushButtonLatch& latch) : _latch(latch), _slot(latch.acquire()) {}
+		~Reader() { _latch.release(_slot); }
+		const T& operator*() const { return _latch._buf[_slot]; }
+		const T* operator->() const { return &_latch._buf[_slot]; }
+
+	  private:
+		PushButtonLatch& _latch;
+		uint32_t _slot;
+		Reader(const Reader&);
+		Reader& operator=(const Reader&);
+	};
+
+
+	/** Constructor por defecto. Publica una configuracion construida por defecto */
+	PushButtonLatch() : _cur(0), _next(0) {
+		for(uint32_t i = 0; i < Slots; i++){
+			_refs[i].store(0, std::memory_order_relaxed);
+		}
+	}
+
+
+	/** edit
+     *  Obtiene una copia editable de la configuracion publicada. Solo puede invocarse desde el escritor
+     *  @return Configuracion a modificar antes de publish()
+     */
+	T& edit(){
+		uint32_t cur = _cur.load();
+		for(;;){
+			for(uint32_t i = 0; i < Slots; i++){
+				if(i != cur && _refs[i].load() == 0){
+					_next = i;
+					_buf[i] = _buf[cur];
+					return _buf[i];
+				}
+			}
+			// todas las posiciones libres estan retenidas por lectores concurrentes, que pueden ser de menor prioridad
+			Thread::wait(1);
+		}
+	}
+
+
+	/** publish
+     *  Publica la configuracion obtenida con edit(). Solo puede invocarse desde el escritor
+     */
+	void publish(){
+		_cur.store(_next);
+	}
+
+  private:
+	T _buf[Slots];							/// Configuraciones
+	std::atomic<uint32_t> _refs[Slots];		/// Lectores de cada configuracion
+	std::atomic<uint32_t> _cur;				/// Configuracion publicada
+	uint32_t _next;							/// Configuracion en edicion (escritor)
+
+	/** acquire
+     *  Marca la configuracion publicada como en uso
+     *  @return Posicion marcada
+     */
+	uint32_t acquire(){
+		for(;;){
+			uint32_t i = _cur.load();
+			_refs[i].fetch_add(1);
+			// si se ha publicado otra entretanto, la posicion puede estar en edicion
+			if(_cur.load() == i){
+				return i;
+			}
+			_refs[i].fetch_sub(1);
+		}
+	}
+
+	/** release
+     *  Libera una configuracion marcada con acquire
+     *  @param i Posicion marcada
+     */
+	void release(uint32_t i){
+		_refs[i].fetch_sub(1);
+	}
+};
+
+
+#endif /*__PushButtonLatch__H */
+
+/**** END OF FILE ****/
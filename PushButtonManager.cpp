@@ -0,0 +1,407 @@
+/*
+ * PushButtonManager.cpp
+ *
+ *  Created on: Oct 2026
+ *      Author: raulMrello
+ */
+
+#include "PushButtonManager.h"
+
+
+
+//------------------------------------------------------------------------------------
+//--- PRIVATE TYPES ------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+/** Macro para imprimir trazas de depuracion, siempre que se haya configurado un objeto
+ *	Logger valido (ej: _debug)
+ */
+static const char* _MODULE_ = "[PushBtnMgr]....";
+#define _EXPR_	(_defdbg && !IS_ISR())
+
+
+//------------------------------------------------------------------------------------
+//-- PUBLIC METHODS IMPLEMENTATION ---------------------------------------------------
+//------------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------------
+PushButtonManager::PushButtonManager(uint32_t stack_size, osPriority priority, bool defdbg) : _defdbg(defdbg) {
+	init(NULL, stack_size, priority);
+}
+
+
+//------------------------------------------------------------------------------------
+PushButtonManager::PushButtonManager(unsigned char* stack_mem, uint32_t stack_size, osPriority priority, bool defdbg) : _defdbg(defdbg) {
+	MBED_ASSERT(stack_mem);
+	init(stack_mem, stack_size, priority);
+}
+
+
+//------------------------------------------------------------------------------------
+PushButtonManager::~PushButtonManager() {
+	MBED_ASSERT(_used == 0);
+	_th->~Thread();
+}
+
+
+//------------------------------------------------------------------------------------
+uint32_t PushButtonManager::getButtonCount(){
+	uint32_t count = 0;
+	for(uint32_t used = _used; used != 0; used &= (used - 1)){
+		count++;
+	}
+	return count;
+}
+
+
+//------------------------------------------------------------------------------------
+bool PushButtonManager::getButtonId(uint8_t slot, uint32_t& id){
+	bool result = false;
+	_mtx.lock();
+	if(slot < MaxButtons && _btn[slot]){
+		id = _btn[slot]->_id;
+		result = true;
+	}
+	_mtx.unlock();
+	return result;
+}
+
+
+//------------------------------------------------------------------------------------
+bool PushButtonManager::addChord(uint32_t chord_id, const uint32_t* ids, uint8_t count, uint32_t hold_ms){
+	uint32_t keys = 0;
+	_mtx.lock();
+	for(uint8_t i = 0; i < count; i++){
+		uint32_t key = 0;
+		for(uint32_t used = _used; used != 0; used &= (used - 1)){
+			uint32_t slot = __builtin_ctz(used);
+			if(_btn[slot]->_id == ids[i]){
+				key = (1u << slot);
+				break;
+			}
+		}
+		if(key == 0){
+			_mtx.unlock();
+			DEBUG_TRACE_W(_EXPR_, _MODULE_, "ERR_CHORD_ID %d", ids[i]);
+			return false;
+		}
+		keys |= key;
+	}
+	_mtx.unlock();
+	_chord_mtx.lock();
+	bool result = _chord.addChord(chord_id, keys, 1000 * hold_ms);
+	_chord_mtx.unlock();
+	return result;
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonManager::enableChordEvents(Callback<void(uint32_t, PushButtonChord::Event)>chordCb, uint32_t tolerance_ms){
+	_chord_mtx.lock();
+	_chord.setTolerance(1000 * tolerance_ms);
+	_chord.reset();
+	_chordCb = chordCb;
+	_chord_mtx.unlock();
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonManager::disableChordEvents(){
+	_chord_mtx.lock();
+	_chordCb = (Callback<void(uint32_t, PushButtonChord::Event)>) NULL;
+	_chord.reset();
+	_chord_mtx.unlock();
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonManager::enableBatchEvents(Callback<void(const Batch&)> batchCb){
+	_batch_mtx.lock();
+	_batchCb = batchCb;
+	_batch_mtx.unlock();
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonManager::disableBatchEvents(){
+	_batch_mtx.lock();
+	_batchCb = (Callback<void(const Batch&)>) NULL;
+	_batch_mtx.unlock();
+}
+
+
+//------------------------------------------------------------------------------------
+//-- PRIVATE METHODS IMPLEMENTATION --------------------------------------------------
+//------------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------------
+void PushButtonManager::init(unsigned char* stack_mem, uint32_t stack_size, osPriority priority){
+	DEBUG_TRACE_I(_EXPR_, _MODULE_, "Creando gestor de pulsadores");
+	for(uint32_t i = 0; i < MaxButtons; i++){
+		_btn[i] = NULL;
+	}
+	_used = 0;
+	_pressed = 0;
+	_held = 0;
+	_requests = 0;
+	_wakeups = 0;
+	_dispatching = false;
+	_wheel = PushButtonTimerWheel(1000, PushButton::getTimeUs());
+	_chordCb = (Callback<void(uint32_t, PushButtonChord::Event)>) NULL;
+	memset(&_batch, 0, sizeof(Batch));
+	_batchCb = (Callback<void(const Batch&)>) NULL;
+
+	// Crea el hilo de despacho compartido
+    sprintf(_th_name,"pushbm_%x", (uint32_t)(uintptr_t)this);
+    _th = new(_th_mem) Thread(priority, stack_size, stack_mem, _th_name);
+    _th->start(callback(this, &PushButtonManager::_task));
+}
+
+
+//------------------------------------------------------------------------------------
+int PushButtonManager::attach(PushButton* btn){
+	int slot = -1;
+	_mtx.lock();
+	for(uint32_t i = 0; i < MaxButtons; i++){
+		if((_used & (1u << i)) == 0){
+			_btn[i] = btn;
+			_used |= (1u << i);
+			slot = (int)i;
+			break;
+		}
+	}
+	_mtx.unlock();
+	if(slot < 0){
+		DEBUG_TRACE_W(_EXPR_, _MODULE_, "ERR_FULL");
+	}
+	return slot;
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonManager::detach(uint8_t slot){
+	_mtx.lock();
+	_btn[slot] = NULL;
+	_used &= ~(1u << slot);
+	_pressed &= ~(1u << slot);
+	_held &= ~(1u << slot);
+	_mtx.unlock();
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonManager::notifyEdge(const PushButton::EdgeRecord& rec){
+	// solo despierta al hilo si no tenia flancos pendientes
+	bool idle = _edges.empty();
+	if(_edges.push(rec) && idle){
+		_th->signal_set(EvPending);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonManager::notifyButton(uint8_t slot, bool pressed, uint32_t ts_us){
+	addToBatch((pressed)? _batch.pressed : _batch.released, slot, ts_us);
+	_chord_mtx.lock();
+	if(pressed){
+		_pressed |= (1u << slot);
+	}
+	else{
+		_pressed &= ~(1u << slot);
+	}
+	_held &= ~(1u << slot);
+	if(_chordCb){
+		if(pressed){
+			_chord.press(slot, ts_us);
+		}
+		else{
+			_chord.release(slot, ts_us);
+		}
+		notifyChords();
+	}
+	_chord_mtx.unlock();
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonManager::notifyHold(uint8_t slot, uint32_t ts_us){
+	addToBatch(_batch.held, slot, ts_us);
+	_held |= (1u << slot);
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonManager::addToBatch(uint32_t& mask, uint8_t slot, uint32_t ts_us){
+	// el lote solo se modifica desde el hilo de despacho
+	if((_batch.pressed | _batch.held | _batch.released) == 0){
+		_batch.ts_us = ts_us;
+	}
+	mask |= (1u << slot);
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonManager::notifyBatch(){
+	if((_batch.pressed | _batch.held | _batch.released) == 0){
+		return;
+	}
+	_batch.state = _pressed;
+	DEBUG_TRACE_D(_EXPR_, _MODULE_, "EV_BATCH p=%x h=%x r=%x", _batch.pressed, _batch.held, _batch.released);
+	_batch_mtx.lock();
+	if(_batchCb){
+		_batchCb.call(_batch);
+	}
+	_batch_mtx.unlock();
+	memset(&_batch, 0, sizeof(Batch));
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonManager::notifyChords(){
+	PushButtonChord::Event event;
+	uint32_t chord_id;
+	while(_chord.poll(event, chord_id)){
+		DEBUG_TRACE_D(_EXPR_, _MODULE_, "EV_CHORD %d %d", chord_id, event);
+		if(_chordCb){
+			_chordCb.call(chord_id, event);
+		}
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonManager::wakeup(){
+	_th->signal_set(EvPending);
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonManager::postRequest(uint8_t slot){
+	_requests |= (1u << slot);
+	_th->signal_set(EvPending);
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonManager::startTimer(PushButtonTimerWheel::Node* node, uint32_t delay_us, uint32_t period_us){
+	_wheel_mtx.lock();
+	_wheel.start(node, delay_us, period_us, PushButton::getTimeUs());
+	// fuera del despacho, el hilo debe recalcular su espera
+	bool idle = !_dispatching;
+	_wheel_mtx.unlock();
+	if(idle){
+		wakeup();
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonManager::setTimerPeriod(PushButtonTimerWheel::Node* node, uint32_t period_us){
+	_wheel_mtx.lock();
+	_wheel.setPeriod(node, period_us);
+	bool idle = !_dispatching;
+	_wheel_mtx.unlock();
+	if(idle){
+		wakeup();
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonManager::stopTimer(PushButtonTimerWheel::Node* node){
+	_wheel_mtx.lock();
+	_wheel.stop(node);
+	_wheel_mtx.unlock();
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonManager::processTimers(uint32_t now_us){
+	_wheel_mtx.lock();
+	_wheel.advance(now_us);
+	PushButtonTimerWheel::Node* node;
+	while((node = _wheel.popExpired()) != NULL){
+		// la callback puede reprogramar sus timers
+		_wheel_mtx.unlock();
+		static_cast<PushButton*>(node->ctx)->timerExpired(node);
+		_wheel_mtx.lock();
+	}
+	_wheel_mtx.unlock();
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonManager::_task(){
+	uint32_t timeout = osWaitForever;
+	for(;;){
+		// la espera finaliza con nuevos flancos o al vencer la ventana (timers, filtrado sin timer o gestos) mas proxima
+		_th->signal_wait(EvPending, timeout);
+		_wakeups++;
+		_wheel_mtx.lock();
+		_dispatching = true;
+		_wheel_mtx.unlock();
+
+		// aplica los cambios de configuracion solicitados desde otros hilos antes de procesar los flancos
+		_mtx.lock();
+		for(uint32_t req = _requests.exchange(0) & _used; req != 0; req &= (req - 1)){
+			_btn[__builtin_ctz(req)]->applyRequests(PushButton::getTimeUs());
+		}
+
+		// demultiplexa el lote de flancos pendientes hacia cada pulsador
+		uint32_t touched = 0;
+		PushButton::EdgeRecord rec;
+		while(_edges.pop(rec)){
+			if(rec.slot < MaxButtons && _btn[rec.slot]){
+				_btn[rec.slot]->processEdge(rec);
+				touched |= (1u << rec.slot);
+			}
+		}
+
+		// timers vencidos de filtrado y hold
+		processTimers(PushButton::getTimeUs());
+
+		// inicia el filtrado una sola vez por pulsador y resuelve en todos ellos los vencimientos sin timer
+		// (filtrado, gestos, hold) del ciclo, tambien en los que han recibido flancos, y calcula la siguiente espera
+		uint32_t now = PushButton::getTimeUs();
+		timeout = osWaitForever;
+		for(uint32_t used = _used; used != 0; used &= (used - 1)){
+			uint32_t slot = __builtin_ctz(used);
+			PushButton* btn = _btn[slot];
+			if((touched & (1u << slot)) != 0){
+				btn->commitEdges();
+			}
+			btn->resolveTimeouts(now);
+			uint32_t t = btn->getWaitTimeout(now);
+			timeout = (t < timeout)? t : timeout;
+		}
+		_mtx.unlock();
+
+		// evento hold de la combinacion activa
+		_chord_mtx.lock();
+		if(_chordCb && _chord.isPending()){
+			_chord.update(now);
+			notifyChords();
+			uint32_t remaining = _chord.getRemaining(now);
+			if(remaining != PushButtonChord::NoDeadline){
+				uint32_t t = (remaining + 999) / 1000;
+				timeout = (t < timeout)? t : timeout;
+			}
+		}
+		_chord_mtx.unlock();
+
+		// lote de eventos del ciclo
+		notifyBatch();
+
+		// siguiente vencimiento de la rueda. Los timers iniciados desde otros hilos a partir de este punto
+		// despiertan al hilo
+		_wheel_mtx.lock();
+		_dispatching = false;
+		uint32_t remaining = _wheel.getRemaining(PushButton::getTimeUs());
+		_wheel_mtx.unlock();
+		if(remaining != PushButtonTimerWheel::NoDeadline){
+			uint32_t t = (remaining + 999) / 1000;
+			timeout = (t < timeout)? t : timeout;
+		}
+	}
+}
@@ -0,0 +1,299 @@
+/*
+ * PushButtonManager.h
+ *
+ *  Created on: Oct 2026
+ *      Author: raulMrello
+ *
+ *	PushButtonManager es el modulo que permite agrupar varios PushButton para que compartan un unico hilo de
+ *  ejecucion. Cada pulsador registrado recibe una posicion (slot) dentro del gestor y sus ISRs, en lugar de
+ *  despertar un hilo propio, insertan el flanco (slot, nivel, instante) en un buffer sin bloqueos del gestor.
+ *  El hilo del gestor se despierta una sola vez por cada rafaga de flancos y los demultiplexa hacia cada pulsador.
+ *  De esta forma, el coste en RAM de cada pulsador adicional se reduce al del propio objeto PushButton.
+ *
+ *  El buffer de flancos es de tipo productor unico: todas las ISRs de los pulsadores de un mismo gestor
+ *  deben ejecutarse con la misma prioridad (valor por defecto en mbed y en el servicio GPIO de ESP-IDF),
+ *  de forma que no puedan anidarse entre si.
+ *
+ *  Al compartir el hilo, el gestor dispone de la vista global de los pulsadores activos (getPressedMask), sobre la
+ *  que detecta combinaciones de pulsadores (ver PushButtonChord) sin condiciones de carrera entre pulsadores.
+ *
+ *  Los timers de filtrado y de eventos hold de los pulsadores del grupo no utilizan RtosTimer: se programan en una
+ *  rueda de temporizadores compartida (ver PushButtonTimerWheel) con inicio y cancelacion O(1), cuyo siguiente
+ *  vencimiento es el timeout de espera del hilo del gestor. Un grupo de 32 pulsadores no crea ningun timer del
+ *  sistema operativo.
+ *
+ *  Opcionalmente, el gestor entrega los eventos de todo el grupo agrupados en un unico lote por ciclo de despacho
+ *  (ver enableBatchEvents), con las mascaras de pulsadores pulsados, mantenidos y liberados en el ciclo. Un cambio
+ *  simultaneo de varios pulsadores (arranque, reconexion, pulsacion conjunta) se notifica con una sola callback.
+ */
+
+#ifndef __PushButtonManager__H
+#define __PushButtonManager__H
+
+#include "mbed.h"
+#include "PushButton.h"
+#include "PushButtonChord.h"
+#include "PushButtonTimerWheel.h"
+#include <atomic>
+
+
+class PushButtonManager {
+  public:
+	static const uint32_t MaxButtons = 32;					/// Numero maximo de pulsadores (uno por bit de las mascaras de eventos)
+	static const uint32_t EdgeQueueSize = 64;				/// Capacidad del buffer de flancos compartido
+
+	/** Lote de eventos de un ciclo de despacho. Las mascaras se indexan por slot (ver getButtonId). Un mismo
+	 *  pulsador puede figurar en varias mascaras si genera varios eventos en el ciclo; state refleja el estado final
+	 */
+	struct Batch {
+		uint32_t pressed;									/// Slots con evento press
+		uint32_t held;										/// Slots con evento hold
+		uint32_t released;									/// Slots con evento release
+		uint32_t state;										/// Slots pulsados al finalizar el ciclo
+		uint32_t ts_us;										/// Instante del primer evento del lote
+	};
+
+	/** Constructor y Destructor
+	 *  @param stack_size Tamanio de la pila del hilo de despacho
+	 *  @param priority Prioridad del hilo de despacho
+	 *  @param defdbg Flag para activar las trazas de depuracion por defecto
+	 */
+    PushButtonManager(uint32_t stack_size = OS_STACK_SIZE, osPriority priority = osPriorityNormal, bool defdbg = false);
+    ~PushButtonManager();
+
+
+	/** Constructor sin memoria dinamica. La pila del hilo de despacho la proporciona el llamante
+	 *  @param stack_mem Pila del hilo de despacho (alineada a 8 bytes)
+	 *  @param stack_size Tamanio de la pila
+	 *  @param priority Prioridad del hilo de despacho
+	 *  @param defdbg Flag para activar las trazas de depuracion por defecto
+	 */
+    PushButtonManager(unsigned char* stack_mem, uint32_t stack_size, osPriority priority = osPriorityNormal, bool defdbg = false);
+
+
+	/** getButtonCount
+     *  Obtiene el numero de pulsadores registrados
+     *  @return Numero de pulsadores
+     */
+    uint32_t getButtonCount();
+
+
+	/** getEdgeOverflowCount
+     *  Obtiene el numero de flancos descartados por desbordamiento del buffer compartido
+     *  @return Flancos descartados
+     */
+    uint32_t getEdgeOverflowCount() { return _edges.getOverflowCount(); }
+
+
+	/** getWakeupCount
+     *  Obtiene el numero de activaciones del hilo de despacho compartido
+     *  @return Activaciones
+     */
+    uint32_t getWakeupCount() { return _wakeups; }
+
+
+	/** getPressedMask
+     *  Obtiene el conjunto de pulsadores pulsados
+     *  @return Mascara de slots pulsados
+     */
+    uint32_t getPressedMask() { return _pressed; }
+
+
+	/** getHeldMask
+     *  Obtiene el conjunto de pulsadores pulsados que han generado algun evento hold desde su pulsacion
+     *  @return Mascara de slots
+     */
+    uint32_t getHeldMask() { return _held; }
+
+
+	/** getButtonId
+     *  Obtiene el identificador del pulsador registrado en un slot
+     *  @param slot Slot del pulsador
+     *  @param id Recibe el identificador
+     *  @return true si el slot esta ocupado, false en caso contrario
+     */
+    bool getButtonId(uint8_t slot, uint32_t& id);
+
+
+	/** getTimerCount
+     *  Obtiene el numero de timers de filtrado y hold programados en la rueda compartida
+     *  @return Timers activos
+     */
+    uint32_t getTimerCount() { return _wheel.getCount(); }
+
+
+	/** addChord
+     *  Registra una combinacion de pulsadores. Los pulsadores deben estar registrados en el gestor
+     *  @param chord_id Identificador notificado con los eventos de la combinacion
+     *  @param ids Identificadores de los pulsadores que la forman
+     *  @param count Numero de pulsadores
+     *  @param hold_ms Tiempo de mantenimiento para el evento hold (0: sin evento hold)
+     *  @return true si se registra, false en caso de error
+     */
+    bool addChord(uint32_t chord_id, const uint32_t* ids, uint8_t count, uint32_t hold_ms = 0);
+
+
+	/** Instala callback para procesar los eventos de las combinaciones. La callback se ejecutara
+	 *  en contexto de tarea y recibe el identificador de la combinacion y el evento
+     *  @param chordCb Callback a instalar
+     *  @param tolerance_ms Tiempo maximo entre la primera y la ultima pulsacion de una combinacion
+     */
+    void enableChordEvents(Callback<void(uint32_t, PushButtonChord::Event)>chordCb, uint32_t tolerance_ms = 150);
+
+
+	/** disableChordEvents
+     *  Desinstala callback para procesar los eventos de las combinaciones
+     */
+    void disableChordEvents();
+
+
+	/** Instala callback para procesar los eventos del grupo por lotes. La callback se ejecutara en contexto de
+	 *  tarea, una sola vez por ciclo de despacho con eventos, tras las callbacks individuales de los pulsadores
+     *  @param batchCb Callback a instalar
+     */
+    void enableBatchEvents(Callback<void(const Batch&)> batchCb);
+
+
+	/** disableBatchEvents
+     *  Desinstala callback para procesar los eventos por lotes
+     */
+    void disableBatchEvents();
+
+
+  private:
+    friend class PushButton;
+
+    /** Eventos del hilo de despacho */
+    static const uint32_t EvPending = (1<<0);
+
+    PushButton* _btn[MaxButtons];			/// Pulsadores registrados, indexados por slot
+    uint32_t _used;							/// Mascara de slots ocupados
+    PushButtonRing<PushButton::EdgeRecord, EdgeQueueSize> _edges;	/// Flancos pendientes de todos los pulsadores
+    Mutex _mtx;								/// Protege el registro frente al despacho en curso
+    std::atomic<uint32_t> _pressed;			/// Mascara de slots pulsados
+    std::atomic<uint32_t> _held;			/// Mascara de slots pulsados con eventos hold
+    std::atomic<uint32_t> _requests;		/// Mascara de slots con cambios de configuracion pendientes de aplicar
+    uint32_t _wakeups;						/// Activaciones del hilo de despacho
+    PushButtonChord _chord;					/// Detector de combinaciones
+    Callback<void(uint32_t, PushButtonChord::Event)> _chordCb;	/// Callback para notificar combinaciones
+    Mutex _chord_mtx;						/// Protege el detector frente a la configuracion desde otros hilos
+    Batch _batch;							/// Lote de eventos del ciclo de despacho en curso
+    Callback<void(const Batch&)> _batchCb;	/// Callback para notificar lotes de eventos
+    Mutex _batch_mtx;						/// Protege la callback de lotes frente a la configuracion desde otros hilos
+    PushButtonTimerWheel _wheel;			/// Timers de filtrado y hold de todos los pulsadores
+    Mutex _wheel_mtx;						/// Protege la rueda frente a la configuracion desde otros hilos
+    bool _dispatching;						/// Despacho en curso (la espera se recalcula al finalizar)
+    bool _defdbg;							/// Flag para activar las trazas de depuracion por defecto
+    Thread* _th;							/// Hilo de despacho compartido (construido en _th_mem)
+    uint64_t _th_mem[(sizeof(Thread) + sizeof(uint64_t) - 1) / sizeof(uint64_t)];	/// Almacenamiento de _th
+    char _th_name[24];
+
+	/** init
+     *  Inicializa el gestor e inicia el hilo de despacho, comun a ambos constructores
+     *  @param stack_mem Pila del hilo (NULL: la reserva el sistema operativo)
+     *  @param stack_size Tamanio de la pila
+     *  @param priority Prioridad del hilo
+     */
+    void init(unsigned char* stack_mem, uint32_t stack_size, osPriority priority);
+
+	/** attach
+     *  Registra un pulsador en el gestor
+     *  @param btn Pulsador a registrar
+     *  @return Slot asignado o -1 si no quedan slots libres
+     */
+    int attach(PushButton* btn);
+
+	/** detach
+     *  Elimina un pulsador del gestor
+     *  @param slot Slot asignado al pulsador
+     */
+    void detach(uint8_t slot);
+
+	/** notifyEdge
+     *  Inserta un flanco pendiente. Se invoca desde la ISR del pulsador
+     *  @param rec Flanco registrado
+     */
+    void notifyEdge(const PushButton::EdgeRecord& rec);
+
+	/** notifyButton
+     *  Actualiza el conjunto de pulsadores pulsados y el detector de combinaciones
+     *  @param slot Slot del pulsador
+     *  @param pressed true si es una pulsacion, false si es una liberacion
+     *  @param ts_us Instante del evento
+     */
+    void notifyButton(uint8_t slot, bool pressed, uint32_t ts_us);
+
+	/** notifyHold
+     *  Registra un evento hold en el lote en curso
+     *  @param slot Slot del pulsador
+     *  @param ts_us Instante del evento
+     */
+    void notifyHold(uint8_t slot, uint32_t ts_us);
+
+	/** addToBatch
+     *  Registra un evento en una mascara del lote en curso
+     *  @param mask Mascara del lote
+     *  @param slot Slot del pulsador
+     *  @param ts_us Instante del evento
+     */
+    void addToBatch(uint32_t& mask, uint8_t slot, uint32_t ts_us);
+
+	/** notifyBatch
+     *  Notifica el lote del ciclo de despacho, si contiene eventos, y lo reinicia
+     */
+    void notifyBatch();
+
+	/** notifyChords
+     *  Notifica los eventos de combinaciones pendientes
+     */
+    void notifyChords();
+
+	/** wakeup
+     *  Despierta al hilo de despacho para que recalcule su espera
+     */
+    void wakeup();
+
+	/** postRequest
+     *  Solicita aplicar en el hilo de despacho los cambios de configuracion pendientes de un pulsador (ver
+     *  PushButton::applyRequests)
+     *  @param slot Slot del pulsador
+     */
+    void postRequest(uint8_t slot);
+
+	/** startTimer
+     *  Inicia (o reinicia) un timer de un pulsador en la rueda compartida
+     *  @param node Timer del pulsador
+     *  @param delay_us Tiempo hasta el vencimiento
+     *  @param period_us Periodo de repeticion (0: una sola vez)
+     */
+    void startTimer(PushButtonTimerWheel::Node* node, uint32_t delay_us, uint32_t period_us);
+
+	/** setTimerPeriod
+     *  Modifica el periodo de un timer periodico de un pulsador en la rueda compartida, sin detenerlo
+     *  @param node Timer del pulsador
+     *  @param period_us Nuevo periodo de repeticion
+     */
+    void setTimerPeriod(PushButtonTimerWheel::Node* node, uint32_t period_us);
+
+	/** stopTimer
+     *  Detiene un timer de un pulsador en la rueda compartida
+     *  @param node Timer del pulsador
+     */
+    void stopTimer(PushButtonTimerWheel::Node* node);
+
+	/** processTimers
+     *  Atiende los timers vencidos de la rueda compartida. Se invoca desde el hilo de despacho
+     *  @param now_us Instante actual
+     */
+    void processTimers(uint32_t now_us);
+
+    /**
+     * Hilo de despacho
+     */
+    void _task();
+};
+
+
+#endif /*__PushButtonManager__H */
+
+/**** END OF FILE ****/
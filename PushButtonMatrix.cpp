@@ -0,0 +1,231 @@
+/*
+ * PushButtonMatrix.cpp
+ *
+ *  Created on: Oct 2026
+ *      Author: raulMrello
+ */
+
+#include "PushButtonMatrix.h"
+
+
+
+//------------------------------------------------------------------------------------
+//--- PRIVATE TYPES ------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+/** Macro para imprimir trazas de depuracion, siempre que se haya configurado un objeto
+ *	Logger valido (ej: _debug)
+ */
+static const char* _MODULE_ = "[PushBtnMtx]....";
+#define _EXPR_	(_defdbg && !IS_ISR())
+
+
+//------------------------------------------------------------------------------------
+//-- PUBLIC METHODS IMPLEMENTATION ---------------------------------------------------
+//------------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------------
+PushButtonMatrix::PushButtonMatrix(const PinName32* rows, uint8_t num_rows, const PinName32* cols, uint8_t num_cols, uint32_t base_id,
+								   uint32_t scan_ms, uint8_t debounce_scans, bool defdbg) : _defdbg(defdbg) {
+	MBED_ASSERT(num_rows > 0 && num_rows <= MaxLines && num_cols > 0 && num_cols <= MaxLines);
+	MBED_ASSERT((uint32_t)num_rows * num_cols <= MaxKeys);
+	MBED_ASSERT(debounce_scans > 0 && debounce_scans <= MaxDebounceScans);
+	DEBUG_TRACE_I(_EXPR_, _MODULE_, "Creando PushButtonMatrix %dx%d", num_rows, num_cols);
+	_num_rows = num_rows;
+	_num_cols = num_cols;
+	_base_id = base_id;
+	_scan_ms = (scan_ms > 0)? scan_ms : 1;
+	_debounce_scans = debounce_scans;
+	_hist_idx = 0;
+	_state = 0;
+	_hold_scans = 0;
+	for(uint32_t i = 0; i < MaxDebounceScans; i++){
+		_hist[i] = 0;
+	}
+	for(uint32_t i = 0; i < MaxKeys; i++){
+		_hold_cnt[i] = 0;
+	}
+	_pressCb = (Callback<void(uint32_t)>) NULL;
+	_holdCb = (Callback<void(uint32_t)>) NULL;
+	_releaseCb = (Callback<void(uint32_t)>) NULL;
+	_scan_stats.scans = 0;
+	_scan_stats.wakeups = 0;
+	_scan_stats.last_us = 0;
+	_scan_stats.max_us = 0;
+
+	// Crea las lineas de fila y columna
+	for(uint8_t r = 0; r < _num_rows; r++){
+		_rows[r] = new DigitalOut((PinName)rows[r], 0);
+		MBED_ASSERT(_rows[r]);
+	}
+	for(uint8_t c = 0; c < _num_cols; c++){
+		_cols[c] = new InterruptIn((PinName)cols[c]);
+		MBED_ASSERT(_cols[c]);
+		_cols[c]->mode(PullUp);
+		_cols[c]->rise(NULL);
+		_cols[c]->fall(NULL);
+	}
+
+	// Crea el hilo del teclado
+    sprintf(_th_name,"pushbx_%x", (uint32_t)(uintptr_t)this);
+    _th = new Thread(osPriorityNormal, OS_STACK_SIZE, NULL, _th_name);
+    MBED_ASSERT(_th);
+    _th->start(callback(this, &PushButtonMatrix::_task));
+}
+
+
+//------------------------------------------------------------------------------------
+PushButtonMatrix::~PushButtonMatrix() {
+	for(uint8_t c = 0; c < _num_cols; c++){
+		_cols[c]->fall(NULL);
+	}
+	delete(_th);
+	for(uint8_t c = 0; c < _num_cols; c++){
+		delete(_cols[c]);
+	}
+	for(uint8_t r = 0; r < _num_rows; r++){
+		delete(_rows[r]);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonMatrix::enableHoldEvents(Callback<void(uint32_t)>holdCb, uint32_t millis){
+	if(!holdCb || millis == 0){
+		disableHoldEvents();
+		return;
+	}
+	_holdCb = holdCb;
+	_hold_scans = (millis + _scan_ms - 1) / _scan_ms;
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonMatrix::disableHoldEvents(){
+	_hold_scans = 0;
+	_holdCb = (Callback<void(uint32_t)>) NULL;
+}
+
+
+//------------------------------------------------------------------------------------
+//-- PRIVATE METHODS IMPLEMENTATION --------------------------------------------------
+//------------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------------
+void PushButtonMatrix::_task(){
+	for(;;){
+		// en reposo, espera sin coste a la pulsacion de cualquier tecla
+		if(enterIdle()){
+			_th->signal_wait(EvWakeup, osWaitForever);
+			_scan_stats.wakeups++;
+		}
+		// barrido periodico hasta que todas las teclas quedan liberadas de forma estable
+		while(!scan()){
+			_th->signal_wait(EvWakeup, _scan_ms);
+		}
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonMatrix::isrColumnCallback(){
+	for(uint8_t c = 0; c < _num_cols; c++){
+		_cols[c]->fall(NULL);
+	}
+	_th->signal_set(EvWakeup);
+}
+
+
+//------------------------------------------------------------------------------------
+bool PushButtonMatrix::enterIdle(){
+	for(uint8_t r = 0; r < _num_rows; r++){
+		_rows[r]->write(0);
+	}
+	for(uint8_t c = 0; c < _num_cols; c++){
+		_cols[c]->fall(callback(this, &PushButtonMatrix::isrColumnCallback));
+	}
+	// si alguna tecla se ha pulsado antes de habilitar las interrupciones, no habra flanco
+	for(uint8_t c = 0; c < _num_cols; c++){
+		if(_cols[c]->read() == 0){
+			for(uint8_t i = 0; i < _num_cols; i++){
+				_cols[i]->fall(NULL);
+			}
+			return false;
+		}
+	}
+	DEBUG_TRACE_D(_EXPR_, _MODULE_, "EV_IDLE");
+	return true;
+}
+
+
+//------------------------------------------------------------------------------------
+bool PushButtonMatrix::scan(){
+	uint32_t t0 = PushButton::getTimeUs();
+
+	// lectura de la matriz fila a fila
+	for(uint8_t r = 0; r < _num_rows; r++){
+		_rows[r]->write(1);
+	}
+	uint64_t sample = 0;
+	for(uint8_t r = 0; r < _num_rows; r++){
+		_rows[r]->write(0);
+		for(uint8_t c = 0; c < _num_cols; c++){
+			if(_cols[c]->read() == 0){
+				sample |= ((uint64_t)1 << (r * _num_cols + c));
+			}
+		}
+		_rows[r]->write(1);
+	}
+
+	// filtrado de todas las teclas en paralelo: cambian las que coinciden en todas las muestras
+	_hist[_hist_idx] = sample;
+	_hist_idx = (_hist_idx + 1) % _debounce_scans;
+	uint64_t all_on = ~(uint64_t)0;
+	uint64_t any_on = 0;
+	for(uint8_t i = 0; i < _debounce_scans; i++){
+		all_on &= _hist[i];
+		any_on |= _hist[i];
+	}
+	uint64_t state = (_state & any_on) | all_on;
+	uint64_t pressed = state & ~_state;
+	uint64_t released = _state & ~state;
+	_state = state;
+
+	// eventos hold de las teclas mantenidas
+	uint64_t hold = 0;
+	for(uint64_t m = pressed; m != 0; m &= (m - 1)){
+		_hold_cnt[__builtin_ctzll(m)] = 0;
+	}
+	if(_hold_scans > 0){
+		for(uint64_t m = (_state & ~pressed); m != 0; m &= (m - 1)){
+			uint32_t key = __builtin_ctzll(m);
+			if(++_hold_cnt[key] >= _hold_scans){
+				_hold_cnt[key] = 0;
+				hold |= ((uint64_t)1 << key);
+			}
+		}
+	}
+
+	uint32_t elapsed = PushButton::getTimeUs() - t0;
+	_scan_stats.scans++;
+	_scan_stats.last_us = elapsed;
+	_scan_stats.max_us = (elapsed > _scan_stats.max_us)? elapsed : _scan_stats.max_us;
+
+	notify(pressed, _pressCb);
+	notify(hold, _holdCb);
+	notify(released, _releaseCb);
+	return (_state == 0 && any_on == 0);
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonMatrix::notify(uint64_t mask, Callback<void(uint32_t)>& cb){
+	for(; mask != 0; mask &= (mask - 1)){
+		uint32_t key = __builtin_ctzll(mask);
+		DEBUG_TRACE_D(_EXPR_, _MODULE_, "EV_KEY %d", key);
+		if(cb){
+			cb.call(_base_id + key);
+		}
+	}
+}
@@ -0,0 +1,157 @@
+/*
+ * PushButtonMatrix.h
+ *
+ *  Created on: Oct 2026
+ *      Author: raulMrello
+ *
+ *	PushButtonMatrix es el modulo encargado de gestionar un teclado matricial (p.ej. 4x4 u 8x8) con el mismo modelo
+ *  de eventos que PushButton: "Press", "Hold" y "Release", notificados con el identificador de cada tecla
+ *  (base_id + fila * columnas + columna).
+ *
+ *  Las filas son salidas activas a nivel bajo y las columnas entradas con pull-up. En reposo todas las filas quedan
+ *  activas y las columnas con interrupcion por flanco de bajada, de forma que el hilo del teclado permanece
+ *  bloqueado sin coste hasta que se pulsa cualquier tecla. A partir de ese momento se realiza un barrido completo
+ *  cada scan_ms, hasta que todas las teclas vuelven a estar liberadas de forma estable.
+ *
+ *  El estado de la matriz se mantiene en mascaras de 64 bits y el filtrado anti-rebotes de todas las teclas se
+ *  realiza en paralelo con operaciones bit a bit: una tecla cambia de estado cuando sus ultimas debounce_scans
+ *  muestras coinciden. Sin diodos en las teclas, pulsaciones simultaneas en rectangulo pueden generar teclas fantasma.
+ */
+
+#ifndef __PushButtonMatrix__H
+#define __PushButtonMatrix__H
+
+#include "mbed.h"
+#include "PushButton.h"
+
+
+class PushButtonMatrix {
+  public:
+	static const uint32_t MaxLines = 16;					/// Numero maximo de filas o de columnas
+	static const uint32_t MaxKeys = 64;						/// Numero maximo de teclas (bits del estado)
+	static const uint32_t MaxDebounceScans = 8;				/// Numero maximo de muestras para el filtrado
+
+	/** Coste de los barridos realizados */
+	struct ScanStats {
+		uint32_t scans;										/// Barridos realizados
+		uint32_t wakeups;									/// Activaciones desde reposo por interrupcion
+		uint32_t last_us;									/// Duracion del ultimo barrido (lectura + filtrado)
+		uint32_t max_us;									/// Duracion maxima de un barrido
+	};
+
+	/** Constructor y Destructor
+	 *  @param rows Pines de las filas
+	 *  @param num_rows Numero de filas
+	 *  @param cols Pines de las columnas
+	 *  @param num_cols Numero de columnas
+	 *  @param base_id Identificador de la tecla (0, 0)
+	 *  @param scan_ms Periodo de barrido mientras hay teclas activas
+	 *  @param debounce_scans Muestras consecutivas iguales para validar un cambio de estado
+	 *  @param defdbg Flag para activar las trazas de depuracion por defecto
+	 */
+    PushButtonMatrix(const PinName32* rows, uint8_t num_rows, const PinName32* cols, uint8_t num_cols, uint32_t base_id = 0,
+    				 uint32_t scan_ms = 5, uint8_t debounce_scans = 4, bool defdbg = false);
+    ~PushButtonMatrix();
+
+
+	/** Instala callback para procesar los eventos de pulsacion. La callback
+	 *  se ejecutara en contexto de tarea
+     *  @param pressCb Callback a instalar
+     */
+    void enablePressEvents(Callback<void(uint32_t)>pressCb) { _pressCb = pressCb; }
+
+
+	/** Instala callback para procesar los eventos de mantenimiento. La callback
+	 *  se ejecutara en contexto de tarea
+     *  @param holdCb Callback a instalar
+     *  @param millis Milisegundos tras los que se genera el evento periodico
+     */
+    void enableHoldEvents(Callback<void(uint32_t)>holdCb, uint32_t millis);
+
+
+	/** Instala callback para procesar los eventos de liberacion. La callback
+	 *  se ejecutara en contexto de tarea
+     *  @param releaseCb Callback a instalar
+     */
+    void enableReleaseEvents(Callback<void(uint32_t)>releaseCb) { _releaseCb = releaseCb; }
+
+
+	/** Desinstala las callbacks de cada tipo de evento */
+    void disablePressEvents() { _pressCb = (Callback<void(uint32_t)>) NULL; }
+    void disableHoldEvents();
+    void disableReleaseEvents() { _releaseCb = (Callback<void(uint32_t)>) NULL; }
+
+
+	/** getState
+     *  Obtiene el estado filtrado de todas las teclas
+     *  @return Mascara de teclas pulsadas (bit fila * columnas + columna)
+     */
+    uint64_t getState() { return _state; }
+
+
+	/** getScanStats
+     *  Obtiene el coste de los barridos realizados
+     *  @param stats Recibe las estadisticas
+     */
+    void getScanStats(ScanStats& stats) { stats = _scan_stats; }
+
+
+  private:
+
+    /** Eventos del hilo del teclado */
+    static const uint32_t EvWakeup = (1<<0);
+
+    DigitalOut* _rows[MaxLines];			/// Salidas de fila
+    InterruptIn* _cols[MaxLines];			/// Entradas de columna
+    uint8_t _num_rows;
+    uint8_t _num_cols;
+    uint32_t _base_id;						/// Identificador de la tecla (0, 0)
+    uint32_t _scan_ms;						/// Periodo de barrido
+    uint8_t _debounce_scans;				/// Muestras para validar un cambio
+    uint8_t _hist_idx;						/// Posicion de la siguiente muestra
+    uint64_t _hist[MaxDebounceScans];		/// Ultimas muestras sin filtrar
+    uint64_t _state;						/// Estado filtrado
+    uint32_t _hold_scans;					/// Barridos entre eventos hold (0: desactivados)
+    uint16_t _hold_cnt[MaxKeys];			/// Barridos desde la pulsacion de cada tecla
+    Callback<void(uint32_t)> _pressCb;      /// Callback para notificar eventos de pulsacion
+    Callback<void(uint32_t)> _holdCb;       /// Callback para notificar eventos de mantenimiento
+    Callback<void(uint32_t)> _releaseCb;    /// Callback para notificar eventos de liberacion
+    ScanStats _scan_stats;					/// Coste de los barridos
+    bool _defdbg;							/// Flag para activar las trazas de depuracion por defecto
+    Thread* _th;							/// Hilo del teclado
+    char _th_name[24];
+
+	/** isrColumnCallback
+     *  ISR de activacion desde reposo
+     */
+    void isrColumnCallback();
+
+	/** enterIdle
+     *  Activa todas las filas y las interrupciones de columna
+     *  @return true si queda en reposo, false si alguna tecla ya esta pulsada
+     */
+    bool enterIdle();
+
+	/** scan
+     *  Realiza un barrido completo, filtra y notifica los eventos
+     *  @return true si todas las teclas estan liberadas de forma estable
+     */
+    bool scan();
+
+	/** notify
+     *  Notifica los eventos de las teclas indicadas
+     *  @param mask Teclas
+     *  @param cb Callback a invocar
+     */
+    void notify(uint64_t mask, Callback<void(uint32_t)>& cb);
+
+    /**
+     * Hilo de control
+     */
+    void _task();
+};
+
+
+#endif /*__PushButtonMatrix__H */
+
+/**** END OF FILE ****/
@@ -0,0 +1,170 @@
+/*
+ * PushButtonPool.h
+ *
+ *  Created on: Oct 2026
+ *      Author: raulMrello
+ *
+ *	PushButtonPool es el contenedor estatico de un grupo de pulsadores. Reserva en el propio objeto el
+ *  almacenamiento de N pulsadores, de su PushButtonManager y de la pila del hilo de despacho, de forma que,
+ *  declarado como objeto global o estatico, la memoria total del driver (sizeof(PushButtonPool<N, StackSize>))
+ *  queda fijada en tiempo de enlazado y ni la creacion ni la destruccion de pulsadores utilizan memoria dinamica.
+ *
+ *  Los pulsadores se crean en modo grupo, que no reserva timers ni buffers propios (ver PushButtonManager). La
+ *  creacion tiene un coste acotado y, en lugar de detenerse en un MBED_ASSERT, devuelve NULL si no quedan
+ *  posiciones libres, por lo que las posiciones de un pulsador destruido pueden reutilizarse indefinidamente
+ *  sin fragmentar el heap.
+ *
+ *  Las funciones opcionales de los pulsadores (callbacks void, gestos, tormentas, filtrado adaptativo, trazas...)
+ *  no forman parte del objeto PushButton (ver PushButton::setExtensionStorage). El contenedor reserva E de ellas,
+ *  que se asignan a los pulsadores creados con 'extended', de forma que los pulsadores basicos no pagan su
+ *  tamanio y los que las utilizan tampoco requieren memoria dinamica.
+ *
+ *  Ejemplo:
+ *
+ *	static PushButtonPool<4, OS_STACK_SIZE, 1> pool;
+ *	PushButton* btn = pool.create(PA_0, 1, PushButton::PressIsLowLevel, PullUp, 20000);
+ *	PushButton* ext = pool.create(PA_1, 2, PushButton::PressIsLowLevel, PullUp, 20000, true);
+ */
+
+#ifndef __PushButtonPool__H
+#define __PushButtonPool__H
+
+#include "mbed.h"
+#include "PushButton.h"
+#include "PushButtonManager.h"
+#include <new>
+#include <atomic>
+
+
+template <uint32_t N, uint32_t StackSize = OS_STACK_SIZE, uint32_t E = 0>
+class PushButtonPool {
+	static_assert(N > 0 && N <= PushButtonManager::MaxButtons, "PushButtonPool: N fuera de rango");
+	static_assert((StackSize % sizeof(uint64_t)) == 0, "PushButtonPool: StackSize debe ser multiplo de 8");
+	static_assert(E <= N, "PushButtonPool: E fuera de rango");
+
+  public:
+	static const uint32_t Capacity = N;				/// Numero maximo de pulsadores
+	static const uint32_t ExtCapacity = E;			/// Numero maximo de pulsadores con funciones opcionales
+
+	/** Constructor y Destructor. El destructor elimina los pulsadores que no se hayan destruido
+	 *  @param priority Prioridad del hilo de despacho
+	 *  @param defdbg Flag para activar las trazas de depuracion por defecto
+	 */
+	PushButtonPool(osPriority priority = osPriorityNormal, bool defdbg = false)
+		: _mgr((unsigned char*)_stack, StackSize, priority, defdbg), _used(0), _ext_used(0), _defdbg(defdbg) {}
+
+	~PushButtonPool(){
+		for(uint32_t i = 0; i < N; i++){
+			if((_used & (1u << i)) != 0){
+				destroy(button(i));
+			}
+		}
+	}
+
+
+	/** create
+     *  Crea un pulsador en una posicion libre del contenedor
+     *  @param btn Pin del pulsador
+     *  @param id Identificador del pulsador
+     *  @param level Nivel logico de la pulsacion
+     *  @param mode Modo del pin
+     *  @param filter_us Tiempo del filtro anti-glitch
+     *  @param extended Flag para asignarle almacenamiento de funciones opcionales
+     *  @return Pulsador o NULL si no quedan posiciones libres
+     */
+	PushButton* create(PinName32 btn, uint32_t id, PushButton::LogicLevel level, PinMode mode, uint32_t filter_us = PushButton::GlitchFilterTimeoutUs,
+					   bool extended = false){
+		core_util_critical_section_enter();
+		uint32_t free = ~_used & ((N < 32)? ((1u << N) - 1) : 0xFFFFFFFF);
+		uint32_t ext_free = ~_ext_used & ((E < 32)? ((1u << E) - 1) : 0xFFFFFFFF);
+		if(free == 0 || (extended && ext_free == 0)){
+			core_util_critical_section_exit();
+			return NULL;
+		}
+		uint32_t i = __builtin_ctz(free);
+		_used |= (1u << i);
+		_ext_of[i] = E;
+		if(extended){
+			_ext_of[i] = __builtin_ctz(ext_free);
+			_ext_used |= (1u << _ext_of[i]);
+		}
+		core_util_critical_section_exit();
+		PushButton* b = new(_mem[i]) PushButton(&_mgr, btn, id, level, mode, filter_us, _defdbg);
+		if(extended){
+			b->setExtensionStorage(&_ext[_ext_of[i]]);
+		}
+		return b;
+	}
+
+
+	/** destroy
+     *  Destruye un pulsador creado con create() y libera su posicion
+     *  @param btn Pulsador
+     */
+	void destroy(PushButton* btn){
+		uint32_t i = index(btn);
+		MBED_ASSERT(i < N && (_used & (1u << i)) != 0);
+		btn->~PushButton();
+		core_util_critical_section_enter();
+		_used &= ~(1u << i);
+		if(_ext_of[i] < E){
+			_ext_used &= ~(1u << _ext_of[i]);
+		}
+		core_util_critical_section_exit();
+	}
+
+
+	/** getManager
+     *  Obtiene el gestor del grupo (combinaciones, contadores)
+     *  @return Gestor
+     */
+	PushButtonManager& getManager() { return _mgr; }
+
+
+	/** getFreeCount
+     *  Obtiene el numero de posiciones libres
+     *  @return Posiciones libres
+     */
+	uint32_t getFreeCount() { return N - (uint32_t)__builtin_popcount(_used); }
+
+
+	/** getExtFreeCount
+     *  Obtiene el numero de almacenamientos de funciones opcionales libres
+     *  @return Almacenamientos libres
+     */
+	uint32_t getExtFreeCount() { return E - (uint32_t)__builtin_popcount(_ext_used); }
+
+  private:
+	static const uint32_t Words = (sizeof(PushButton) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+	uint64_t _stack[StackSize / sizeof(uint64_t)];	/// Pila del hilo de despacho
+	uint64_t _mem[N][Words];					/// Almacenamiento de los pulsadores
+	PushButton::ExtensionStorage _ext[(E > 0)? E : 1];	/// Almacenamiento de las funciones opcionales
+	uint8_t _ext_of[N];							/// Funciones opcionales asignadas a cada posicion (E: ninguna)
+	PushButtonManager _mgr;						/// Gestor del grupo
+	std::atomic<uint32_t> _used;				/// Mascara de posiciones ocupadas
+	std::atomic<uint32_t> _ext_used;			/// Mascara de funciones opcionales asignadas
+	bool _defdbg;								/// Flag para activar las trazas de depuracion por defecto
+
+	/** button
+     *  Obtiene el pulsador de una posicion
+     */
+	PushButton* button(uint32_t i) { return reinterpret_cast<PushButton*>(_mem[i]); }
+
+	/** index
+     *  Obtiene la posicion de un pulsador (N si no pertenece al contenedor)
+     */
+	uint32_t index(PushButton* btn){
+		for(uint32_t i = 0; i < N; i++){
+			if(button(i) == btn){
+				return i;
+			}
+		}
+		return N;
+	}
+};
+
+
+#endif /*__PushButtonPool__H */
+
+/**** END OF FILE ****/
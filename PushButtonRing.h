@@ -0,0 +1,109 @@
+/*
+ * PushButtonRing.h
+ *
+ *  Created on: Oct 2026
+ *      Author: raulMrello
+ *
+ *	PushButtonRing es un buffer circular sin bloqueos para un unico productor y un unico consumidor (SPSC).
+ *  Se utiliza para trasladar registros desde las ISRs (productor) hasta el hilo de despacho (consumidor) sin
+ *  secciones criticas ni llamadas al sistema operativo. Los indices son contadores libres de 32 bits, de forma
+ *  que el buffer puede llenarse por completo sin necesidad de reservar una posicion vacia.
+ *  Si el buffer esta lleno, el registro se descarta y se incrementa el contador de desbordamientos.
+ */
+
+#ifndef __PushButtonRing__H
+#define __PushButtonRing__H
+
+#include <stdint.h>
+#include <atomic>
+
+
+template <typename T, uint32_t N>
+class PushButtonRing {
+	static_assert(N > 0 && (N & (N - 1)) == 0, "PushButtonRing: N debe ser potencia de 2");
+
+  public:
+
+	/** Constructor por defecto */
+	PushButtonRing() : _head(0), _tail(0), _overflows(0) {}
+
+
+	/** push
+     *  Inserta un registro. Solo puede invocarse desde el productor
+     *  @param item Registro a insertar
+     *  @return true si se inserta, false si el buffer esta lleno
+     */
+	bool push(const T& item){
+		uint32_t head = _head.load(std::memory_order_relaxed);
+		if(head - _tail.load() >= N){
+			_overflows.store(_overflows.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			return false;
+		}
+		_buf[head & (N - 1)] = item;
+		_head.store(head + 1);
+		return true;
+	}
+
+
+	/** pop
+     *  Extrae el registro mas antiguo. Solo puede invocarse desde el consumidor
+     *  @param item Recibe el registro extraido
+     *  @return true si se extrae, false si el buffer esta vacio
+     */
+	bool pop(T& item){
+		uint32_t tail = _tail.load(std::memory_order_relaxed);
+		if(tail == _head.load()){
+			return false;
+		}
+		item = _buf[tail & (N - 1)];
+		_tail.store(tail + 1);
+		return true;
+	}
+
+
+	/** empty
+     *  Comprueba si el buffer esta vacio. Puede invocarse desde ambos extremos
+     *  @return true si no hay registros pendientes
+     */
+	bool empty(){
+		return (_head.load() == _tail.load());
+	}
+
+
+	/** size
+     *  Obtiene el numero de registros pendientes
+     *  @return Registros pendientes
+     */
+	uint32_t size(){
+		return (_head.load() - _tail.load());
+	}
+
+
+	/** capacity
+     *  Obtiene la capacidad del buffer
+     *  @return Capacidad en registros
+     */
+	static uint32_t capacity(){
+		return N;
+	}
+
+
+	/** getOverflowCount
+     *  Obtiene el numero de registros descartados por falta de espacio
+     *  @return Registros descartados
+     */
+	uint32_t getOverflowCount(){
+		return _overflows.load(std::memory_order_relaxed);
+	}
+
+  private:
+	T _buf[N];								/// Registros
+	std::atomic<uint32_t> _head;			/// Indice de escritura (productor)
+	std::atomic<uint32_t> _tail;			/// Indice de lectura (consumidor)
+	std::atomic<uint32_t> _overflows;		/// Registros descartados (productor)
+};
+
+
+#endif /*__PushButtonRing__H */
+
+/**** END OF FILE ****/
@@ -0,0 +1,170 @@
+/*
+ * PushButtonSampler.cpp
+ *
+ *  Created on: Oct 2026
+ *      Author: raulMrello
+ */
+
+#include "PushButtonSampler.h"
+#include "PushButton.h"
+
+
+
+//------------------------------------------------------------------------------------
+//--- PRIVATE TYPES ------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+/** Macro para imprimir trazas de depuracion, siempre que se haya configurado un objeto
+ *	Logger valido (ej: _debug)
+ */
+static const char* _MODULE_ = "[PushBtnSmp]....";
+#define _EXPR_	(_defdbg && !IS_ISR())
+
+
+//------------------------------------------------------------------------------------
+//-- PUBLIC METHODS IMPLEMENTATION ---------------------------------------------------
+//------------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------------
+PushButtonSampler::PushButtonSampler(Callback<bool(uint32_t&)> read, uint32_t period_ms, bool defdbg) : _defdbg(defdbg) {
+	MBED_ASSERT(read);
+	_read = read;
+	init(period_ms);
+}
+
+
+//------------------------------------------------------------------------------------
+PushButtonSampler::PushButtonSampler(uint32_t period_ms, bool defdbg) : _defdbg(defdbg) {
+	_read = (Callback<bool(uint32_t&)>) NULL;
+	init(period_ms);
+}
+
+
+//------------------------------------------------------------------------------------
+PushButtonSampler::~PushButtonSampler() {
+	delete(_th);
+	for(uint32_t i = 0; i < MaxInputs; i++){
+		delete(_pins[i]);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonSampler::addPin(uint8_t input, PinName32 pin, PinMode mode){
+	MBED_ASSERT(!_read && input < MaxInputs && !_pins[input]);
+	DigitalIn* din = new DigitalIn((PinName)pin, mode);
+	MBED_ASSERT(din);
+	_mtx.lock();
+	_pins[input] = din;
+	// el nivel inicial queda disponible para el pulsador asociado antes de la siguiente muestra
+	_level = (din->read())? (_level | (1u << input)) : (_level & ~(1u << input));
+	_mtx.unlock();
+}
+
+
+//------------------------------------------------------------------------------------
+//-- PRIVATE METHODS IMPLEMENTATION --------------------------------------------------
+//------------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------------
+void PushButtonSampler::init(uint32_t period_ms){
+	DEBUG_TRACE_I(_EXPR_, _MODULE_, "Creando PushButtonSampler cada %dms", period_ms);
+	_period_ms = (period_ms > 0)? period_ms : 1;
+	_attached = 0;
+	_level = 0;
+	for(uint32_t i = 0; i < MaxInputs; i++){
+		_pins[i] = NULL;
+		_btn[i] = NULL;
+	}
+	_stats.samples = 0;
+	_stats.edges = 0;
+	_stats.read_errors = 0;
+	_stats.last_us = 0;
+	_stats.max_us = 0;
+
+	// nivel inicial de las entradas, para los pulsadores que se asocien antes de la primera muestra
+	uint32_t raw;
+	if(_read && _read(raw)){
+		_level = raw;
+	}
+
+	// Crea el hilo del muestreador
+    sprintf(_th_name,"pushbs_%x", (uint32_t)(uintptr_t)this);
+    _th = new Thread(osPriorityNormal, OS_STACK_SIZE, NULL, _th_name);
+    MBED_ASSERT(_th);
+    _th->start(callback(this, &PushButtonSampler::_task));
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonSampler::attach(PushButton* btn, uint8_t input){
+	MBED_ASSERT(input < MaxInputs && (!_btn[input] || _btn[input] == btn));
+	_mtx.lock();
+	_btn[input] = btn;
+	_attached |= (1u << input);
+	_mtx.unlock();
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonSampler::detach(uint8_t input){
+	_mtx.lock();
+	_btn[input] = NULL;
+	_attached &= ~(1u << input);
+	_mtx.unlock();
+}
+
+
+//------------------------------------------------------------------------------------
+bool PushButtonSampler::readInputs(uint32_t& raw){
+	if(_read){
+		return _read(raw);
+	}
+	raw = 0;
+	for(uint32_t i = 0; i < MaxInputs; i++){
+		if(_pins[i] && _pins[i]->read()){
+			raw |= (1u << i);
+		}
+	}
+	return true;
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonSampler::sample(){
+	uint32_t t0 = PushButton::getTimeUs();
+	uint32_t raw;
+	if(!readInputs(raw)){
+		DEBUG_TRACE_W(_EXPR_, _MODULE_, "ERR_READ");
+		_stats.read_errors++;
+		return;
+	}
+	_mtx.lock();
+	uint32_t changed = (raw ^ _level) & _attached;
+	_level = raw;
+	// los flancos se entregan como desde una ISR: el buffer de flancos del pulsador o del gestor solo admite
+	// un productor a la vez
+	for(; changed != 0; changed &= (changed - 1)){
+		uint32_t input = __builtin_ctz(changed);
+		core_util_critical_section_enter();
+		_btn[input]->pushEdge((uint8_t)((raw >> input) & 1));
+		core_util_critical_section_exit();
+		_stats.edges++;
+	}
+	_mtx.unlock();
+
+	uint32_t elapsed = PushButton::getTimeUs() - t0;
+	_stats.samples++;
+	_stats.last_us = elapsed;
+	_stats.max_us = (elapsed > _stats.max_us)? elapsed : _stats.max_us;
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonSampler::_task(){
+	for(;;){
+		Thread::wait(_period_ms);
+		sample();
+	}
+}
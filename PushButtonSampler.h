@@ -0,0 +1,135 @@
+/*
+ * PushButtonSampler.h
+ *
+ *  Created on: Oct 2026
+ *      Author: raulMrello
+ *
+ *	PushButtonSampler es el muestreador compartido de entradas para pulsadores sin interrupcion por flanco: pines
+ *  sin capacidad de interrupcion o entradas de un expansor GPIO (I2C, SPI). Un unico hilo lee todas las entradas
+ *  (hasta 32, un bit por entrada) cada period_ms, mediante una funcion de lectura (p.ej. el registro de entradas
+ *  del expansor) o leyendo los pines registrados con addPin, y entrega cada cambio de nivel al pulsador asociado
+ *  como un flanco marcado en el instante de la muestra (ver PushButton(PushButtonSampler*, ...)). A partir de ese
+ *  punto el pulsador aplica el mismo filtrado y genera los mismos eventos que con InterruptIn.
+ *
+ *  El coste depende solo del periodo de muestreo: cada muestra es una lectura y una comparacion de 32 bits, y se
+ *  entrega como maximo un flanco por entrada y muestra, por lo que un contacto ruidoso no genera mas carga. Los
+ *  rebotes mas rapidos que el periodo de muestreo no llegan a observarse; la ventana de filtrado del pulsador debe
+ *  cubrir varias muestras.
+ */
+
+#ifndef __PushButtonSampler__H
+#define __PushButtonSampler__H
+
+#include "mbed.h"
+
+
+class PushButton;
+
+class PushButtonSampler {
+  public:
+	static const uint32_t MaxInputs = 32;				/// Numero maximo de entradas (bits de la muestra)
+
+	/** Coste del muestreo */
+	struct Stats {
+		uint32_t samples;								/// Muestras realizadas
+		uint32_t edges;									/// Flancos entregados a los pulsadores
+		uint32_t read_errors;							/// Lecturas fallidas (muestras descartadas)
+		uint32_t last_us;								/// Duracion de la ultima muestra (lectura + entrega)
+		uint32_t max_us;								/// Duracion maxima de una muestra
+	};
+
+	/** Constructor para entradas leidas con una funcion (p.ej. registro de entradas de un expansor)
+	 *  @param read Funcion de lectura, invocada desde el hilo del muestreador. Recibe el nivel de todas las
+	 *  entradas (bit i = entrada i) y devuelve false si la lectura ha fallado
+	 *  @param period_ms Periodo de muestreo
+	 *  @param defdbg Flag para activar las trazas de depuracion por defecto
+	 */
+	PushButtonSampler(Callback<bool(uint32_t&)> read, uint32_t period_ms = 5, bool defdbg = false);
+
+	/** Constructor para pines sin interrupcion, registrados con addPin
+	 *  @param period_ms Periodo de muestreo
+	 *  @param defdbg Flag para activar las trazas de depuracion por defecto
+	 */
+	PushButtonSampler(uint32_t period_ms = 5, bool defdbg = false);
+	~PushButtonSampler();
+
+
+	/** addPin
+     *  Registra un pin como entrada del muestreador (solo sin funcion de lectura)
+     *  @param input Entrada asociada (bit de la muestra)
+     *  @param pin Pin
+     *  @param mode Configuracion del pin
+     */
+	void addPin(uint8_t input, PinName32 pin, PinMode mode);
+
+
+	/** getLevel
+     *  Obtiene el nivel de una entrada en la ultima muestra, sin acceder al hardware
+     *  @param input Entrada
+     *  @return Nivel
+     */
+	uint8_t getLevel(uint8_t input) { return (uint8_t)((_level >> input) & 1); }
+
+
+	/** getStats
+     *  Obtiene el coste del muestreo
+     *  @param stats Recibe las estadisticas
+     */
+	void getStats(Stats& stats) { stats = _stats; }
+
+  private:
+	friend class PushButton;
+
+	Callback<bool(uint32_t&)> _read;					/// Funcion de lectura (NULL: pines registrados)
+	DigitalIn* _pins[MaxInputs];						/// Pines registrados
+	PushButton* _btn[MaxInputs];						/// Pulsador asociado a cada entrada
+	uint32_t _attached;									/// Entradas con pulsador asociado
+	volatile uint32_t _level;							/// Ultima muestra
+	uint32_t _period_ms;								/// Periodo de muestreo
+	Stats _stats;										/// Coste del muestreo
+	Mutex _mtx;											/// Protege las asociaciones durante la entrega
+	bool _defdbg;										/// Flag para activar las trazas de depuracion por defecto
+	Thread* _th;										/// Hilo del muestreador
+	char _th_name[24];
+
+	/** init
+     *  Inicializa el muestreador, comun a ambos constructores
+     *  @param period_ms Periodo de muestreo
+     */
+	void init(uint32_t period_ms);
+
+	/** attach
+     *  Asocia un pulsador a una entrada (invocado desde el constructor del pulsador)
+     *  @param btn Pulsador
+     *  @param input Entrada
+     */
+	void attach(PushButton* btn, uint8_t input);
+
+	/** detach
+     *  Libera la entrada de un pulsador (invocado desde el destructor del pulsador)
+     *  @param input Entrada
+     */
+	void detach(uint8_t input);
+
+	/** readInputs
+     *  Lee todas las entradas
+     *  @param raw Recibe el nivel de las entradas
+     *  @return true si la lectura es valida
+     */
+	bool readInputs(uint32_t& raw);
+
+	/** sample
+     *  Realiza una muestra y entrega los cambios de nivel a los pulsadores
+     */
+	void sample();
+
+    /**
+     * Hilo de control
+     */
+    void _task();
+};
+
+
+#endif /*__PushButtonSampler__H */
+
+/**** END OF FILE ****/
@@ -0,0 +1,96 @@
+/*
+ * PushButtonSeqLock.h
+ *
+ *  Created on: Oct 2026
+ *      Author: raulMrello
+ *
+ *	PushButtonSeqLock publica un estado de pequeno tamano (p.ej. el estado de un pulsador) para su consulta desde
+ *  otros hilos sin bloqueos ni callbacks: los lectores nunca bloquean al escritor ni entre ellos.
+ *
+ *  Es un seqlock: el escritor incrementa un contador de secuencia (impar durante la escritura), copia el estado y
+ *  lo vuelve a incrementar (par). El lector copia el estado entre dos lecturas del contador y repite la copia si
+ *  el contador era impar o ha cambiado entretanto. El estado se almacena en palabras atomicas de 32 bits con
+ *  acceso relajado, ordenadas por las barreras del contador, por lo que T debe poder copiarse con memcpy.
+ *
+ *  Un lector de mayor prioridad que interrumpe una escritura repetiria la copia indefinidamente en un sistema de
+ *  un solo nucleo, por lo que la escritura debe ser breve y no expulsable (p.ej. en seccion critica). Los
+ *  escritores deben serializarse externamente.
+ */
+
+#ifndef __PushButtonSeqLock__H
+#define __PushButtonSeqLock__H
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+
+
+template <typename T>
+class PushButtonSeqLock {
+  public:
+
+	/** Constructor por defecto. Publica un estado construido por defecto */
+	PushButtonSeqLock() : _seq(0) {
+		write(T());
+	}
+
+
+	/** write
+     *  Publica un nuevo estado. Solo puede invocarse desde el escritor
+     *  @param value Estado
+     */
+	void write(const T& value){
+		uint32_t words[Words];
+		words[Words - 1] = 0;
+		memcpy(words, &value, sizeof(T));
+		uint32_t seq = _seq.load(std::memory_order_relaxed);
+		_seq.store(seq + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		for(uint32_t i = 0; i < Words; i++){
+			_data[i].store(words[i], std::memory_order_relaxed);
+		}
+		_seq.store(seq + 2, std::memory_order_release);
+	}
+
+
+	/** read
+     *  Obtiene una copia coherente del estado publicado, desde cualquier hilo
+     *  @param value Recibe el estado
+     */
+	void read(T& value) const {
+		uint32_t words[Words];
+		for(;;){
+			uint32_t seq = _seq.load(std::memory_order_acquire);
+			if((seq & 1) != 0){
+				continue;
+			}
+			for(uint32_t i = 0; i < Words; i++){
+				words[i] = _data[i].load(std::memory_order_relaxed);
+			}
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if(_seq.load(std::memory_order_relaxed) == seq){
+				break;
+			}
+		}
+		memcpy(&value, words, sizeof(T));
+	}
+
+
+	/** getSequence
+     *  Obtiene el contador de secuencia, que se incrementa en 2 con cada publicacion. Permite detectar cambios
+     *  sin copiar el estado
+     *  @return Contador de secuencia
+     */
+	uint32_t getSequence() const { return _seq.load(std::memory_order_acquire); }
+
+  private:
+	static const uint32_t Words = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+	std::atomic<uint32_t> _seq;					/// Contador de secuencia (impar durante la escritura)
+	std::atomic<uint32_t> _data[Words];			/// Estado publicado
+};
+
+
+#endif /*__PushButtonSeqLock__H */
+
+/**** END OF FILE ****/
@@ -0,0 +1,177 @@
+/*
+ * PushButtonStats.h
+ *
+ *  Created on: Oct 2026
+ *      Author: raulMrello
+ *
+ *	PushButtonStats es la instrumentacion opcional de latencias y errores de PushButton. Solo se compila si se
+ *  define ENABLE_PUSHBUTTON_STATS; en caso contrario la macro PUSHBUTTON_STATS() no genera codigo y PushButton no
+ *  reserva memoria para ella, por lo que puede mantenerse en compilaciones de produccion sin coste.
+ *
+ *  Las latencias se acumulan en histogramas de tamanio fijo con un bucket por potencia de 2 (1us .. 2^31us).
+ *  Los percentiles se interpolan dentro del bucket, acotados por el minimo y maximo exactos. Cuando un bucket
+ *  satura, todos se dividen a la mitad, de forma que la distribucion se mantiene sin desbordamientos.
+ *  Los valores se actualizan desde el hilo de despacho y el de timers sin sincronizacion, por lo que una
+ *  instantanea tomada en paralelo puede ser ligeramente inconsistente.
+ */
+
+#ifndef __PushButtonStats__H
+#define __PushButtonStats__H
+
+#include <stdint.h>
+
+#if defined(ENABLE_PUSHBUTTON_STATS)
+#define PUSHBUTTON_STATS(expr)	expr
+#else
+#define PUSHBUTTON_STATS(expr)
+#endif
+
+
+class PushButtonHistogram {
+  public:
+	static const uint32_t NumBuckets = 32;
+
+	/** Resumen de la distribucion */
+	struct Summary {
+		uint32_t count;						/// Numero de muestras
+		uint32_t min_us;					/// Latencia minima
+		uint32_t max_us;					/// Latencia maxima
+		uint32_t p50_us;					/// Mediana
+		uint32_t p99_us;					/// Percentil 99
+	};
+
+	PushButtonHistogram() { reset(); }
+
+
+	/** reset
+     *  Descarta todas las muestras
+     */
+	void reset(){
+		for(uint32_t i = 0; i < NumBuckets; i++){
+			_buckets[i] = 0;
+		}
+		_count = 0;
+		_min_us = 0xFFFFFFFF;
+		_max_us = 0;
+	}
+
+
+	/** add
+     *  Registra una muestra
+     *  @param us Latencia en microsegundos
+     */
+	void add(uint32_t us){
+		uint32_t b = bucketOf(us);
+		if(_buckets[b] == 0xFFFF){
+			for(uint32_t i = 0; i < NumBuckets; i++){
+				_buckets[i] >>= 1;
+			}
+		}
+		_buckets[b]++;
+		_count++;
+		_min_us = (us < _min_us)? us : _min_us;
+		_max_us = (us > _max_us)? us : _max_us;
+	}
+
+
+	/** percentile
+     *  Estima un percentil de la distribucion
+     *  @param pct Percentil (0..100)
+     *  @return Latencia estimada en microsegundos
+     */
+	uint32_t percentile(uint32_t pct){
+		uint32_t total = 0;
+		for(uint32_t i = 0; i < NumBuckets; i++){
+			total += _buckets[i];
+		}
+		if(total == 0){
+			return 0;
+		}
+		uint32_t target = (total * pct + 99) / 100;
+		target = (target == 0)? 1 : target;
+		uint32_t acc = 0;
+		for(uint32_t i = 0; i < NumBuckets; i++){
+			if(acc + _buckets[i] >= target){
+				// interpolacion lineal dentro del bucket [lo, hi]
+				uint32_t lo = (i == 0)? 0 : (1u << (i - 1));
+				uint32_t hi = (i == 0)? 0 : ((i == NumBuckets - 1)? 0xFFFFFFFF : ((1u << i) - 1));
+				uint32_t value = lo + (uint32_t)(((uint64_t)(hi - lo) * (target - acc)) / _buckets[i]);
+				value = (value < _min_us)? _min_us : value;
+				return (value > _max_us)? _max_us : value;
+			}
+			acc += _buckets[i];
+		}
+		return _max_us;
+	}
+
+
+	/** getSummary
+     *  Obtiene el resumen de la distribucion
+     *  @param summary Recibe el resumen
+     */
+	void getSummary(Summary& summary){
+		summary.count = _count;
+		summary.min_us = (_count > 0)? _min_us : 0;
+		summary.max_us = _max_us;
+		summary.p50_us = percentile(50);
+		summary.p99_us = percentile(99);
+	}
+
+  private:
+	uint16_t _buckets[NumBuckets];			/// Bucket i: [2^(i-1), 2^i - 1] us (bucket 0: 0 us)
+	uint32_t _count;						/// Muestras registradas
+	uint32_t _min_us;						/// Latencia minima
+	uint32_t _max_us;						/// Latencia maxima
+
+	/** bucketOf
+     *  Obtiene el bucket asociado a una latencia
+     */
+	static uint32_t bucketOf(uint32_t us){
+		if(us == 0){
+			return 0;
+		}
+		uint32_t b = 32 - __builtin_clz(us);
+		return (b >= NumBuckets)? (NumBuckets - 1) : b;
+	}
+};
+
+
+struct PushButtonStats {
+	/** Instantanea de la instrumentacion */
+	struct Snapshot {
+		PushButtonHistogram::Summary dispatch;	/// Desde la ISR del flanco hasta su proceso en el hilo de despacho
+		PushButtonHistogram::Summary callback;	/// Desde la invocacion de la callback hasta su retorno
+		uint32_t noise_errors;				/// Eventos ERR_NOISE
+		uint32_t level_errors;				/// Eventos ERR_LEVEL
+		uint32_t hold_ticks;				/// Eventos hold generados
+	};
+
+	PushButtonHistogram dispatch;
+	PushButtonHistogram callback;
+	uint32_t noise_errors;
+	uint32_t level_errors;
+	uint32_t hold_ticks;
+
+	PushButtonStats() { reset(); }
+
+	void reset(){
+		dispatch.reset();
+		callback.reset();
+		noise_errors = 0;
+		level_errors = 0;
+		hold_ticks = 0;
+	}
+
+	void getSnapshot(Snapshot& snap){
+		dispatch.getSummary(snap.dispatch);
+		callback.getSummary(snap.callback);
+		snap.noise_errors = noise_errors;
+		snap.level_errors = level_errors;
+		snap.hold_ticks = hold_ticks;
+	}
+};
+
+
+#endif /*__PushButtonStats__H */
+
+/**** END OF FILE ****/
@@ -0,0 +1,275 @@
+/*
+ * PushButtonT.h
+ *
+ *  Created on: Oct 2026
+ *      Author: raulMrello
+ *
+ *	PushButtonT es la variante de PushButton configurada en tiempo de compilacion. El nivel activo (Level), el
+ *  conjunto de eventos habilitados (Events, mascara de PushButtonEvents), la ventana de filtrado (FilterUs) y el
+ *  periodo de los eventos hold (HoldMs) son parametros de la plantilla, de forma que:
+ *  - Solo se reserva la callback de los eventos habilitados: los eventos deshabilitados no ocupan memoria
+ *    (clases base vacias) y sus ramas desaparecen del codigo generado.
+ *  - El filtro anti-rebotes es el de tiempo estable (ver PushButtonDebouncer) con la ventana como constante, y
+ *    con FilterUs = 0 se elimina por completo.
+ *  - No utiliza memoria dinamica, timers ni hilo propio: el InterruptIn y el buffer de flancos residen en el
+ *    propio objeto, y el hilo propietario (p.ej. el bucle de eventos de la aplicacion) lo atiende con process(),
+ *    que devuelve el timeout de su siguiente espera. La callback instalada con attach() se invoca desde la ISR
+ *    cuando llega un flanco con el buffer vacio, para despertar a dicho hilo.
+ *
+ *  Las callbacks se ejecutan en el contexto del hilo que invoca process().
+ *
+ *  Ejemplo:
+ *
+ *	static PushButtonT<PushButton::PressIsLowLevel, PushButtonEvents::Press, 20000> btn(PA_0, 1, PullUp);
+ *	btn.enablePressEvents(callback(onPress));
+ *	btn.attach(callback(wakeup));
+ *	for(;;){
+ *		th.signal_wait(EvButton, btn.process());
+ *	}
+ */
+
+#ifndef __PushButtonT__H
+#define __PushButtonT__H
+
+#include "mbed.h"
+#include "PushButton.h"
+#include "PushButtonRing.h"
+
+
+/** Eventos configurables de PushButtonT */
+struct PushButtonEvents {
+	enum {
+		Press	= (1 << 0),
+		Hold	= (1 << 1),
+		Release	= (1 << 2)
+	};
+};
+
+
+/** Callback de un evento (vacia si el evento no esta habilitado) */
+template <uint32_t Event, bool Enabled>
+struct PushButtonTSlot {
+	void set(Callback<void(uint32_t)>) {}
+	void call(uint32_t) {}
+};
+
+template <uint32_t Event>
+struct PushButtonTSlot<Event, true> {
+	Callback<void(uint32_t)> _cb;
+	void set(Callback<void(uint32_t)> cb) { _cb = cb; }
+	void call(uint32_t id) {
+		if(_cb){
+			_cb.call(id);
+		}
+	}
+};
+
+
+/** Estado de los eventos hold (vacio si no estan habilitados) */
+template <uint32_t HoldUs, bool Enabled>
+struct PushButtonTHold {
+	void arm(uint32_t) {}
+	void disarm() {}
+	bool poll(uint32_t) { return false; }
+	uint32_t getRemaining(uint32_t) { return osWaitForever; }
+};
+
+template <uint32_t HoldUs>
+struct PushButtonTHold<HoldUs, true> {
+	uint32_t _next_us;
+	bool _armed;
+	PushButtonTHold() : _next_us(0), _armed(false) {}
+	void arm(uint32_t ts_us) { _next_us = ts_us + HoldUs; _armed = true; }
+	void disarm() { _armed = false; }
+	bool poll(uint32_t now_us) {
+		if(!_armed || (int32_t)(now_us - _next_us) < 0){
+			return false;
+		}
+		_next_us += HoldUs;
+		return true;
+	}
+	uint32_t getRemaining(uint32_t now_us) {
+		if(!_armed){
+			return osWaitForever;
+		}
+		return ((int32_t)(_next_us - now_us) > 0)? (_next_us - now_us + 999) / 1000 : 0;
+	}
+};
+
+
+template <PushButton::LogicLevel Level, uint32_t Events, uint32_t FilterUs = 20000, uint32_t HoldMs = 0, uint32_t EdgeQueueSize = 8>
+class PushButtonT :
+		private PushButtonTSlot<PushButtonEvents::Press, (Events & PushButtonEvents::Press) != 0>,
+		private PushButtonTSlot<PushButtonEvents::Hold, (Events & PushButtonEvents::Hold) != 0>,
+		private PushButtonTSlot<PushButtonEvents::Release, (Events & PushButtonEvents::Release) != 0>,
+		private PushButtonTHold<1000 * HoldMs, (Events & PushButtonEvents::Hold) != 0> {
+
+	static_assert((Events & ~(PushButtonEvents::Press | PushButtonEvents::Hold | PushButtonEvents::Release)) == 0, "PushButtonT: evento desconocido");
+	static_assert((Events & PushButtonEvents::Hold) == 0 || HoldMs > 0, "PushButtonT: eventos hold requieren HoldMs");
+
+	typedef PushButtonTSlot<PushButtonEvents::Press, (Events & PushButtonEvents::Press) != 0> PressSlot;
+	typedef PushButtonTSlot<PushButtonEvents::Hold, (Events & PushButtonEvents::Hold) != 0> HoldSlot;
+	typedef PushButtonTSlot<PushButtonEvents::Release, (Events & PushButtonEvents::Release) != 0> ReleaseSlot;
+	typedef PushButtonTHold<1000 * HoldMs, (Events & PushButtonEvents::Hold) != 0> HoldState;
+
+	/** Nivel del pin en la pulsacion */
+	static const uint8_t PressLevel = (Level == PushButton::PressIsLowLevel)? 0 : 1;
+
+  public:
+
+	/** Constructor y Destructor
+	 *  @param btn Pin del pulsador
+	 *  @param id Identificador notificado en las callbacks
+	 *  @param mode Modo del pin
+	 */
+	PushButtonT(PinName32 btn, uint32_t id, PinMode mode) : _iin((PinName)btn) {
+		_iin.mode(mode);
+		_id = id;
+		_notifyCb = (Callback<void()>) NULL;
+		_raw = (uint8_t)_iin.read();
+		_stable = _raw;
+		_pending = false;
+		_burst_us = 0;
+		_last_us = 0;
+		_iin.rise(callback(this, &PushButtonT::isrRiseCallback));
+		_iin.fall(callback(this, &PushButtonT::isrFallCallback));
+	}
+
+	~PushButtonT() {
+		_iin.rise(NULL);
+		_iin.fall(NULL);
+	}
+
+
+	/** attach
+     *  Instala la callback que despierta al hilo propietario cuando hay flancos pendientes
+     *  @param notifyCb Callback a instalar (se ejecuta en contexto de ISR)
+     */
+	void attach(Callback<void()> notifyCb) { _notifyCb = notifyCb; }
+
+
+	/** Instalan las callbacks de los eventos habilitados en la plantilla
+     *  @param cb Callback a instalar
+     */
+	void enablePressEvents(Callback<void(uint32_t)> cb) {
+		static_assert((Events & PushButtonEvents::Press) != 0, "PushButtonT: evento Press no habilitado");
+		PressSlot::set(cb);
+	}
+	void enableHoldEvents(Callback<void(uint32_t)> cb) {
+		static_assert((Events & PushButtonEvents::Hold) != 0, "PushButtonT: evento Hold no habilitado");
+		HoldSlot::set(cb);
+	}
+	void enableReleaseEvents(Callback<void(uint32_t)> cb) {
+		static_assert((Events & PushButtonEvents::Release) != 0, "PushButtonT: evento Release no habilitado");
+		ReleaseSlot::set(cb);
+	}
+
+
+	/** process
+     *  Procesa los flancos pendientes, resuelve el filtro y los eventos hold vencidos e invoca las callbacks
+     *  @return Milisegundos hasta la siguiente invocacion necesaria u osWaitForever si no hay ninguna en curso
+     */
+	uint32_t process(){
+		PushButton::EdgeRecord rec;
+		while(_edges.pop(rec)){
+			if(!_pending){
+				_pending = true;
+				_burst_us = rec.ts_us;
+			}
+			_raw = rec.level;
+			_last_us = rec.ts_us;
+		}
+		uint32_t now = PushButton::getTimeUs();
+		uint32_t timeout = osWaitForever;
+		if(_pending){
+			uint32_t elapsed = now - _last_us;
+			if(FilterUs == 0 || elapsed >= FilterUs){
+				_pending = false;
+				notifyLevel(_raw, _burst_us);
+				// una vez resuelta la rafaga, verifica que no se haya perdido ningun flanco por desbordamiento: si
+				// el pin no coincide, se inicia una nueva rafaga con el nivel leido
+				uint8_t pin_level = (uint8_t)_iin.read();
+				if(pin_level != _raw){
+					_raw = pin_level;
+					_pending = true;
+					_burst_us = now;
+					_last_us = now;
+					timeout = (FilterUs == 0)? 0 : (FilterUs + 999) / 1000;
+				}
+			}
+			else{
+				timeout = (FilterUs - elapsed + 999) / 1000;
+			}
+		}
+		while(HoldState::poll(now)){
+			HoldSlot::call(_id);
+		}
+		uint32_t t = HoldState::getRemaining(now);
+		return (t < timeout)? t : timeout;
+	}
+
+
+	/** isPressed
+     *  Comprueba si el pulsador esta pulsado (nivel estable)
+     *  @return true si esta pulsado
+     */
+	bool isPressed() { return (_stable == PressLevel); }
+
+
+	/** getEdgeOverflowCount
+     *  Obtiene el numero de flancos descartados por desbordamiento del buffer de flancos
+     *  @return Flancos descartados
+     */
+	uint32_t getEdgeOverflowCount() { return _edges.getOverflowCount(); }
+
+  private:
+	InterruptIn _iin;						/// InterruptIn asociada
+	PushButtonRing<PushButton::EdgeRecord, EdgeQueueSize> _edges;	/// Flancos pendientes
+	Callback<void()> _notifyCb;				/// Notificacion de flancos pendientes
+	uint32_t _id;							/// Identificador del pulsador
+	uint32_t _burst_us;						/// Instante del primer flanco de la rafaga en curso
+	uint32_t _last_us;						/// Instante del ultimo flanco
+	uint8_t _raw;							/// Nivel tras el ultimo flanco
+	uint8_t _stable;						/// Ultimo nivel estable notificado
+	bool _pending;							/// Rafaga sin resolver
+
+	/** pushEdge
+     *  Registra un flanco con su marca de tiempo. Se invoca desde las ISR
+     */
+	void pushEdge(uint8_t level){
+		PushButton::EdgeRecord rec;
+		rec.ts_us = PushButton::getTimeUs();
+		rec.slot = 0;
+		rec.level = level;
+		bool idle = _edges.empty();
+		if(_edges.push(rec) && idle && _notifyCb){
+			_notifyCb.call();
+		}
+	}
+
+	void isrRiseCallback() { pushEdge(1); }
+	void isrFallCallback() { pushEdge(0); }
+
+	/** notifyLevel
+     *  Notifica el evento asociado a un nuevo nivel estable
+     */
+	void notifyLevel(uint8_t level, uint32_t ts_us){
+		if(level == _stable){
+			return;
+		}
+		_stable = level;
+		if(level == PressLevel){
+			HoldState::arm(ts_us);
+			PressSlot::call(_id);
+		}
+		else{
+			HoldState::disarm();
+			ReleaseSlot::call(_id);
+		}
+	}
+};
+
+
+#endif /*__PushButtonT__H */
+
+/**** END OF FILE ****/
@@ -0,0 +1,404 @@
+/*
+ * PushButtonTimerWheel.h
+ *
+ *  Created on: Oct 2026
+ *      Author: raulMrello
+ *
+ *	PushButtonTimerWheel es el planificador de vencimientos compartido por los temporizadores de filtrado y hold de
+ *  todos los pulsadores de un PushButtonManager, de forma que un grupo de pulsadores no necesita ningun RtosTimer:
+ *  todos los vencimientos se atienden desde el timeout de espera del hilo del gestor.
+ *
+ *  Es una rueda jerarquica de Levels niveles de Slots posiciones (resolucion tick_us en el nivel 0, Slots veces
+ *  mayor en cada nivel siguiente). Los temporizadores (Node) se reservan dentro del propio objeto propietario y se
+ *  enlazan en listas doblemente enlazadas, por lo que start() y stop() son O(1) y no reservan memoria. Cada nivel
+ *  dispone de una mascara de posiciones ocupadas, con la que getRemaining() y advance() localizan el siguiente
+ *  vencimiento o redistribucion (cascade) con una rotacion y un ctz por nivel, sin recorrer posiciones vacias.
+ *  getRemaining() devuelve el vencimiento exacto (no la siguiente redistribucion), de forma que el hilo que
+ *  atiende la rueda solo se despierta cuando vence algun temporizador.
+ *
+ *  Los instantes son contadores de 32 bits en microsegundos y se comparan por diferencia, tolerando el
+ *  desbordamiento. No depende del HAL y no es reentrante: el llamante debe serializar el acceso.
+ */
+
+#ifndef __PushButtonTimerWheel__H
+#define __PushButtonTimerWheel__H
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+class PushButtonTimerWheel {
+  public:
+	static const uint32_t SlotBits = 6;
+	static const uint32_t Slots = (1u << SlotBits);		/// Posiciones por nivel
+	static const uint32_t Levels = 3;					/// Niveles (alcance Slots^Levels ticks)
+
+	/** Temporizador. Se reserva en el objeto propietario */
+	struct Node {
+		Node* next;
+		Node* prev;
+		uint32_t expires;						/// Tick de vencimiento
+		uint32_t period_ticks;					/// Periodo en ticks (0: una sola vez)
+		uint8_t level;							/// Nivel en el que esta enlazado (Levels: lista de vencidos)
+		uint8_t slot;							/// Posicion en la que esta enlazado
+		bool armed;								/// Enlazado en la rueda o en la lista de vencidos
+		void* ctx;								/// Propietario
+
+		Node(void* owner = NULL) : next(NULL), prev(NULL), expires(0), period_ticks(0), level(0), slot(0), armed(false), ctx(owner) {}
+	};
+
+	/** Valor de getRemaining sin temporizadores activos */
+	static const uint32_t NoDeadline = 0xFFFFFFFF;
+
+
+	/** Constructor
+	 *  @param tick_us Resolucion de la rueda en microsegundos
+	 *  @param now_us Instante actual
+	 */
+	PushButtonTimerWheel(uint32_t tick_us = 1000, uint32_t now_us = 0) {
+		_tick_us = (tick_us > 0)? tick_us : 1;
+		for(uint32_t l = 0; l < Levels; l++){
+			_bitmap[l] = 0;
+			for(uint32_t s = 0; s < Slots; s++){
+				_slot[l][s] = NULL;
+			}
+		}
+		_expired = NULL;
+		_expired_tail = NULL;
+		_cur = 0;
+		_last_us = now_us;
+		_count = 0;
+	}
+
+
+	/** start
+     *  Arranca (o reinicia) un temporizador. O(1)
+     *  @param n Temporizador
+     *  @param delay_us Tiempo hasta el vencimiento
+     *  @param period_us Periodo de repeticion (0: una sola vez)
+     *  @param now_us Instante actual
+     */
+	void start(Node* n, uint32_t delay_us, uint32_t period_us, uint32_t now_us){
+		stop(n);
+		// el retardo se cuenta desde el instante actual, no desde el ultimo tick procesado
+		uint32_t ticks = (delay_us + (now_us - _last_us) + _tick_us - 1) / _tick_us;
+		n->expires = _cur + ((ticks > 0)? ticks : 1);
+		n->period_ticks = (period_us + _tick_us - 1) / _tick_us;
+		n->armed = true;
+		_count++;
+		link(n);
+	}
+
+
+	/** stop
+     *  Detiene un temporizador. O(1)
+     *  @param n Temporizador
+     */
+	void stop(Node* n){
+		if(!n->armed){
+			return;
+		}
+		unlink(n);
+		n->armed = false;
+		_count--;
+	}
+
+
+	/** setPeriod
+     *  Modifica el periodo de un temporizador periodico en curso sin detenerlo. Invocado al atender su
+     *  vencimiento, el siguiente vencimiento se desplaza para aplicar ya el nuevo periodo. O(1)
+     *  @param n Temporizador
+     *  @param period_us Nuevo periodo de repeticion
+     */
+	void setPeriod(Node* n, uint32_t period_us){
+		uint32_t ticks = (period_us + _tick_us - 1) / _tick_us;
+		if(!n->armed || n->period_ticks == 0 || ticks == 0 || ticks == n->period_ticks){
+			return;
+		}
+		unlink(n);
+		n->expires += ticks - n->period_ticks;
+		n->period_ticks = ticks;
+		if((int32_t)(n->expires - _cur) <= 0){
+			appendExpired(n);
+		}
+		else{
+			link(n);
+		}
+	}
+
+
+	/** advance
+     *  Avanza la rueda hasta el instante actual, trasladando los temporizadores vencidos a la lista de
+     *  vencidos, que se extraen con popExpired()
+     *  @param now_us Instante actual
+     */
+	void advance(uint32_t now_us){
+		uint32_t target = _cur + (now_us - _last_us) / _tick_us;
+		_last_us += (target - _cur) * _tick_us;
+		while(_count > 0){
+			uint32_t next = nextTick();
+			if((int32_t)(next - target) > 0){
+				break;
+			}
+			_cur = next;
+			processTick();
+		}
+		_cur = target;
+	}
+
+
+	/** popExpired
+     *  Extrae un temporizador vencido. Los periodicos se vuelven a programar con su periodo, sin acumular el
+     *  retraso de la activacion, y se extraen tantas veces como periodos hayan vencido
+     *  @return Temporizador vencido o NULL si no hay mas
+     */
+	Node* popExpired(){
+		Node* n = _expired;
+		if(n == NULL){
+			return NULL;
+		}
+		unlink(n);
+		if(n->period_ticks > 0){
+			// los periodos ya vencidos se extraen de nuevo a continuacion
+			n->expires += n->period_ticks;
+			if((int32_t)(n->expires - _cur) <= 0){
+				appendExpired(n);
+			}
+			else{
+				link(n);
+			}
+		}
+		else{
+			n->armed = false;
+			_count--;
+		}
+		return n;
+	}
+
+
+	/** getRemaining
+     *  Obtiene el tiempo hasta el siguiente vencimiento
+     *  @param now_us Instante actual
+     *  @return Microsegundos restantes (0 si hay temporizadores vencidos) o NoDeadline
+     */
+	uint32_t getRemaining(uint32_t now_us){
+		if(_expired){
+			return 0;
+		}
+		if(_count == 0){
+			return NoDeadline;
+		}
+		uint32_t at_us = _last_us + (nextExpiry() - _cur) * _tick_us;
+		return ((int32_t)(at_us - now_us) > 0)? (at_us - now_us) : 0;
+	}
+
+
+	/** getCount
+     *  Obtiene el numero de temporizadores activos
+     *  @return Temporizadores
+     */
+	uint32_t getCount() { return _count; }
+
+  private:
+	uint32_t _tick_us;						/// Resolucion del nivel 0
+	uint32_t _cur;							/// Ultimo tick procesado
+	uint32_t _last_us;						/// Instante correspondiente a _cur
+	uint32_t _count;						/// Temporizadores activos (incluidos los vencidos)
+	uint64_t _bitmap[Levels];				/// Posiciones ocupadas de cada nivel
+	Node* _slot[Levels][Slots];				/// Listas de temporizadores de cada posicion
+	Node* _expired;							/// Lista de temporizadores vencidos
+	Node* _expired_tail;
+
+	/** rotr
+     *  Rotacion a la derecha de una mascara de posiciones
+     */
+	static uint64_t rotr(uint64_t v, uint32_t r){
+		r &= (Slots - 1);
+		return (r == 0)? v : ((v >> r) | (v << (Slots - r)));
+	}
+
+	/** link
+     *  Enlaza un temporizador en la posicion correspondiente a su vencimiento
+     */
+	void link(Node* n){
+		uint32_t delta = n->expires - _cur;
+		uint32_t level = 0;
+		while(level < Levels - 1 && delta >= (1u << (SlotBits * (level + 1)))){
+			level++;
+		}
+		// fuera de alcance: se enlaza en la ultima posicion del ultimo nivel y se redistribuye al llegar a ella
+		uint32_t expires = n->expires;
+		if(delta >= (1u << (SlotBits * Levels))){
+			expires = _cur + (1u << (SlotBits * Levels)) - 1;
+		}
+		uint32_t slot = (expires >> (SlotBits * level)) & (Slots - 1);
+		n->level = (uint8_t)level;
+		n->slot = (uint8_t)slot;
+		n->prev = NULL;
+		n->next = _slot[level][slot];
+		if(n->next){
+			n->next->prev = n;
+		}
+		_slot[level][slot] = n;
+		_bitmap[level] |= ((uint64_t)1 << slot);
+	}
+
+	/** unlink
+     *  Desenlaza un temporizador de su posicion o de la lista de vencidos
+     */
+	void unlink(Node* n){
+		if(n->level == Levels){
+			if(n->prev){
+				n->prev->next = n->next;
+			}
+			else{
+				_expired = n->next;
+			}
+			if(n->next){
+				n->next->prev = n->prev;
+			}
+			else{
+				_expired_tail = n->prev;
+			}
+			return;
+		}
+		if(n->prev){
+			n->prev->next = n->next;
+		}
+		else{
+			_slot[n->level][n->slot] = n->next;
+			if(n->next == NULL){
+				_bitmap[n->level] &= ~((uint64_t)1 << n->slot);
+			}
+		}
+		if(n->next){
+			n->next->prev = n->prev;
+		}
+	}
+
+	/** nextTick
+     *  Obtiene el siguiente tick con vencimientos o redistribuciones pendientes
+     */
+	uint32_t nextTick(){
+		uint32_t next = _cur + (1u << (SlotBits * Levels));
+		for(uint32_t l = 0; l < Levels; l++){
+			if(_bitmap[l] == 0){
+				continue;
+			}
+			uint32_t shift = SlotBits * l;
+			uint32_t idx = (_cur >> shift) & (Slots - 1);
+			uint32_t k = __builtin_ctzll(rotr(_bitmap[l], idx + 1)) + 1;
+			uint32_t t = (((_cur >> shift) + k) << shift);
+			next = ((int32_t)(t - next) < 0)? t : next;
+		}
+		return next;
+	}
+
+	/** nextExpiry
+     *  Obtiene el tick del siguiente vencimiento. Los temporizadores de la primera posicion ocupada de cada nivel
+     *  vencen antes que los de cualquier posicion posterior del mismo nivel, por lo que basta con recorrer esas
+     *  posiciones. Los temporizadores fuera de alcance cuentan con el instante de su redistribucion
+     */
+	uint32_t nextExpiry(){
+		uint32_t next = _cur + (1u << (SlotBits * Levels));
+		for(uint32_t l = 0; l < Levels; l++){
+			if(_bitmap[l] == 0){
+				continue;
+			}
+			uint32_t shift = SlotBits * l;
+			uint32_t idx = (_cur >> shift) & (Slots - 1);
+			uint32_t k = __builtin_ctzll(rotr(_bitmap[l], idx + 1)) + 1;
+			uint32_t t = (((_cur >> shift) + k) << shift);
+			for(Node* n = _slot[l][(idx + k) & (Slots - 1)]; n != NULL; n = n->next){
+				uint32_t expires = ((n->expires - t) < (1u << shift))? n->expires : t;
+				next = ((int32_t)(expires - next) < 0)? expires : next;
+			}
+		}
+		return next;
+	}
+
+	/** processTick
+     *  Redistribuye los niveles superiores que correspondan al tick actual y traslada los vencidos
+     */
+	void processTick(){
+		for(uint32_t l = Levels - 1; l > 0; l--){
+			uint32_t shift = SlotBits * l;
+			if((_cur & ((1u << shift) - 1)) == 0){
+				cascade(l, (_cur >> shift) & (Slots - 1));
+			}
+		}
+		uint32_t slot = _cur & (Slots - 1);
+		Node* n = _slot[0][slot];
+		_slot[0][slot] = NULL;
+		_bitmap[0] &= ~((uint64_t)1 << slot);
+		while(n){
+			Node* next = n->next;
+			if((int32_t)(n->expires - _cur) > 0){
+				link(n);
+			}
+			else{
+				appendExpired(n);
+			}
+			n = next;
+		}
+	}
+
+	/** appendExpired
+     *  Enlaza un temporizador al final de la lista de vencidos
+     */
+	void appendExpired(Node* n){
+		n->level = Levels;
+		n->prev = _expired_tail;
+		n->next = NULL;
+		if(_expired_tail){
+			_expired_tail->next = n;
+		}
+		else{
+			_expired = n;
+		}
+		_expired_tail = n;
+	}
+
+	/** cascade
+     *  Redistribuye una posicion de un nivel superior hacia los niveles inferiores
+     */
+	void cascade(uint32_t level, uint32_t slot){
+		Node* n = _slot[level][slot];
+		_slot[level][slot] = NULL;
+		_bitmap[level] &= ~((uint64_t)1 << slot);
+		while(n){
+			Node* next = n->next;
+			if((int32_t)(n->expires - _cur) <= 0){
+				n->expires = _cur;
+			}
+			linkAt(n);
+			n = next;
+		}
+	}
+
+	/** linkAt
+     *  Enlaza un temporizador redistribuido. Los que vencen en el tick actual pasan al nivel 0 del tick actual,
+     *  que se procesa a continuacion
+     */
+	void linkAt(Node* n){
+		if(n->expires == _cur){
+			uint32_t slot = _cur & (Slots - 1);
+			n->level = 0;
+			n->slot = (uint8_t)slot;
+			n->prev = NULL;
+			n->next = _slot[0][slot];
+			if(n->next){
+				n->next->prev = n;
+			}
+			_slot[0][slot] = n;
+			_bitmap[0] |= ((uint64_t)1 << slot);
+			return;
+		}
+		link(n);
+	}
+};
+
+
+#endif /*__PushButtonTimerWheel__H */
+
+/**** END OF FILE ****/
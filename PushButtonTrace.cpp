@@ -0,0 +1,277 @@
+/*
+ * PushButtonTrace.cpp
+ *
+ *  Created on: Oct 2026
+ *      Author: raulMrello
+ */
+
+#include "PushButtonTrace.h"
+#include <string.h>
+
+
+
+//------------------------------------------------------------------------------------
+//--- PRIVATE TYPES ------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+/** Identificador y version del formato de la traza exportada */
+static const uint8_t TraceMagic[4] = { 'P', 'B', 'T', 1 };
+
+/** Bits del tipo de registro */
+static const uint32_t KindBits = 3;
+
+/** Registros recorridos y bytes copiados por seccion critica al exportar la traza (ver snapshot) */
+static const uint32_t SnapshotChunk = 16;
+
+/** Intentos de exportacion si los productores descartan los registros en curso de exportar */
+static const uint32_t SnapshotRetries = 4;
+
+
+//------------------------------------------------------------------------------------
+static void putU32(uint8_t* p, uint32_t v){
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+	p[2] = (uint8_t)(v >> 16);
+	p[3] = (uint8_t)(v >> 24);
+}
+
+
+//------------------------------------------------------------------------------------
+static uint32_t getU32(const uint8_t* p){
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+
+//------------------------------------------------------------------------------------
+//-- PUBLIC METHODS IMPLEMENTATION ---------------------------------------------------
+//------------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------------
+PushButtonTrace::PushButtonTrace(uint8_t* buf, uint32_t size) {
+	MBED_ASSERT(buf && size >= 16 && (size & (size - 1)) == 0);
+	_buf = buf;
+	_size = size;
+	_dropped = 0;
+	_pin_level = 0;
+	memset(&_cfg, 0, sizeof(Header));
+	clear();
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonTrace::setup(PushButton::LogicLevel level, PushButton::FilterMode filt_mode, uint32_t filter_us, uint32_t hold_us, uint8_t pin_level,
+		uint8_t flags){
+	core_util_critical_section_enter();
+	_cfg.flags = flags;
+	_cfg.level = (uint8_t)level;
+	_cfg.filt_mode = (uint8_t)filt_mode;
+	_cfg.filter_us = filter_us;
+	_cfg.hold_us = hold_us;
+	_pin_level = pin_level;
+	core_util_critical_section_exit();
+	clear();
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonTrace::record(Kind kind, uint32_t value){
+	core_util_critical_section_enter();
+	// el instante se toma dentro de la seccion critica para que los registros de varios productores sean monotonos
+	uint32_t now = PushButton::getTimeUs();
+	uint64_t v = ((uint64_t)(now - _last_ts_us) << KindBits) | (uint32_t)kind;
+	// un registro ocupa como maximo 5 bytes (35 bits) mas 5 del dato adicional
+	uint32_t need = 10;
+	while(_size - (_head - _tail) < need){
+		dropOldest();
+	}
+	put(v);
+	if(kind == KindGesture){
+		put(value);
+	}
+	else if(kind == KindRise || kind == KindFall){
+		_pin_level = (kind == KindRise)? 1 : 0;
+	}
+	_last_ts_us = now;
+	core_util_critical_section_exit();
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonTrace::clear(){
+	core_util_critical_section_enter();
+	_head = 0;
+	_tail = 0;
+	_last_ts_us = PushButton::getTimeUs();
+	_base_ts_us = _last_ts_us;
+	_base_level = _pin_level;
+	_dropped = 0;
+	core_util_critical_section_exit();
+}
+
+
+//------------------------------------------------------------------------------------
+uint32_t PushButtonTrace::snapshot(uint8_t* dst, uint32_t len){
+	if(len < HeaderSize){
+		return 0;
+	}
+	// se exportan los registros hasta el ultimo escrito al iniciar la exportacion. Las secciones criticas se
+	// limitan a SnapshotChunk registros o bytes, por lo que la latencia de las ISR no depende del tamano de la
+	// traza. Un byte solo se sobrescribe tras descartar su registro, por lo que cada bloque comprueba que los
+	// productores no hayan descartado la posicion en curso; en ese caso la exportacion se reinicia
+	uint32_t room = len - HeaderSize;
+	for(uint32_t retry = 0; retry < SnapshotRetries; retry++){
+		core_util_critical_section_enter();
+		uint32_t pos = _tail;
+		uint32_t head = _head;
+		uint32_t base_ts_us = _base_ts_us;
+		uint8_t base_level = _base_level;
+		uint32_t dropped = _dropped;
+		Header cfg = _cfg;
+		core_util_critical_section_exit();
+
+		// registros de cabeza que no caben en el destino: se omiten para exportar los mas recientes, acumulando
+		// el instante y el nivel de referencia del primer registro exportado
+		bool valid = true;
+		while(valid && head - pos > room){
+			core_util_critical_section_enter();
+			valid = ((int32_t)(pos - _tail) >= 0);
+			for(uint32_t n = 0; valid && n < SnapshotChunk && head - pos > room; n++){
+				uint64_t v = get(pos);
+				uint32_t kind = (uint32_t)(v & ((1u << KindBits) - 1));
+				if(kind == KindGesture){
+					get(pos);
+				}
+				else if(kind == KindRise || kind == KindFall){
+					base_level = (kind == KindRise)? 1 : 0;
+				}
+				base_ts_us += (uint32_t)(v >> KindBits);
+				dropped++;
+			}
+			core_util_critical_section_exit();
+		}
+		uint32_t bytes = head - pos;
+		for(uint32_t i = 0; valid && i < bytes; ){
+			core_util_critical_section_enter();
+			valid = ((int32_t)(pos + i - _tail) >= 0);
+			for(uint32_t n = 0; valid && n < SnapshotChunk && i < bytes; n++, i++){
+				dst[HeaderSize + i] = _buf[(pos + i) & (_size - 1)];
+			}
+			core_util_critical_section_exit();
+		}
+		if(!valid){
+			continue;
+		}
+		memcpy(dst, TraceMagic, sizeof(TraceMagic));
+		putU32(&dst[4], base_ts_us);
+		putU32(&dst[8], cfg.filter_us);
+		putU32(&dst[12], cfg.hold_us);
+		putU32(&dst[16], dropped);
+		putU32(&dst[20], bytes);
+		dst[24] = base_level;
+		dst[25] = cfg.level;
+		dst[26] = cfg.filt_mode;
+		dst[27] = cfg.flags;
+		return HeaderSize + bytes;
+	}
+	return 0;
+}
+
+
+//------------------------------------------------------------------------------------
+PushButtonTrace::Reader::Reader(const uint8_t* blob, uint32_t len){
+	memset(&_hdr, 0, sizeof(Header));
+	_data = NULL;
+	_pos = 0;
+	_ts_us = 0;
+	_valid = (blob && len >= HeaderSize && memcmp(blob, TraceMagic, sizeof(TraceMagic)) == 0);
+	if(!_valid){
+		return;
+	}
+	_hdr.base_ts_us = getU32(&blob[4]);
+	_hdr.filter_us = getU32(&blob[8]);
+	_hdr.hold_us = getU32(&blob[12]);
+	_hdr.dropped = getU32(&blob[16]);
+	_hdr.length = getU32(&blob[20]);
+	_hdr.base_level = blob[24];
+	_hdr.level = blob[25];
+	_hdr.filt_mode = blob[26];
+	_hdr.flags = blob[27];
+	_valid = (_hdr.length <= len - HeaderSize);
+	_data = &blob[HeaderSize];
+	_ts_us = _hdr.base_ts_us;
+}
+
+
+//------------------------------------------------------------------------------------
+bool PushButtonTrace::Reader::next(Record& rec){
+	uint64_t v[2] = { 0, 0 };
+	for(uint32_t n = 0; n < 2; n++){
+		uint32_t shift = 0;
+		for(;;){
+			if(!_valid || _pos >= _hdr.length || shift > 63){
+				return false;
+			}
+			uint8_t b = _data[_pos++];
+			v[n] |= (uint64_t)(b & 0x7F) << shift;
+			shift += 7;
+			if((b & 0x80) == 0){
+				break;
+			}
+		}
+		if((v[0] & ((1u << KindBits) - 1)) != KindGesture){
+			break;
+		}
+	}
+	_ts_us += (uint32_t)(v[0] >> KindBits);
+	rec.ts_us = _ts_us;
+	rec.kind = (uint8_t)(v[0] & ((1u << KindBits) - 1));
+	rec.value = (uint32_t)v[1];
+	return true;
+}
+
+
+//------------------------------------------------------------------------------------
+//-- PRIVATE METHODS IMPLEMENTATION --------------------------------------------------
+//------------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------------
+void PushButtonTrace::put(uint64_t v){
+	do{
+		uint8_t b = (uint8_t)(v & 0x7F);
+		v >>= 7;
+		_buf[_head & (_size - 1)] = (v != 0)? (b | 0x80) : b;
+		_head++;
+	}while(v != 0);
+}
+
+
+//------------------------------------------------------------------------------------
+uint64_t PushButtonTrace::get(uint32_t& pos){
+	uint64_t v = 0;
+	uint32_t shift = 0;
+	uint8_t b;
+	do{
+		b = _buf[pos & (_size - 1)];
+		pos++;
+		v |= (uint64_t)(b & 0x7F) << shift;
+		shift += 7;
+	}while((b & 0x80) != 0 && pos != _head);
+	return v;
+}
+
+
+//------------------------------------------------------------------------------------
+void PushButtonTrace::dropOldest(){
+	uint64_t v = get(_tail);
+	uint32_t kind = (uint32_t)(v & ((1u << KindBits) - 1));
+	if(kind == KindGesture){
+		get(_tail);
+	}
+	else if(kind == KindRise || kind == KindFall){
+		_base_level = (kind == KindRise)? 1 : 0;
+	}
+	_base_ts_us += (uint32_t)(v >> KindBits);
+	_dropped++;
+}
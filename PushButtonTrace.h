@@ -0,0 +1,203 @@
+/*
+ * PushButtonTrace.h
+ *
+ *  Created on: Oct 2026
+ *      Author: raulMrello
+ *
+ *	PushButtonTrace es el registrador de trazas de un pulsador (ver PushButton::setTraceRecorder). Registra los
+ *  flancos capturados en las ISR y los eventos notificados (press, hold, release, gestos) en un buffer circular de
+ *  bytes, para reproducir despues en host la secuencia real de un contacto (ver test/tools/trace_replay.cpp).
+ *
+ *  Cada registro ocupa 1 a 5 bytes: un entero de longitud variable (7 bits por byte) con el tiempo transcurrido
+ *  desde el registro anterior, en microsegundos, y el tipo de registro en los 3 bits menos significativos. Los
+ *  gestos anaden un segundo entero con el gesto y el numero de pulsaciones. Un flanco con rebotes cada 300us ocupa
+ *  2 bytes.
+ *
+ *  No reserva memoria: el almacenamiento lo proporciona el llamante. Funciona como registrador de vuelo: si el
+ *  buffer esta lleno, se descartan los registros mas antiguos, de forma que siempre conserva la historia mas
+ *  reciente. La insercion se realiza en una seccion critica de pocas instrucciones, por lo que admite varios
+ *  productores (ISR e hilo de despacho).
+ *
+ *  La traza se exporta con snapshot() en un bloque autocontenido (cabecera con la configuracion del pulsador y el
+ *  nivel y el instante de referencia del primer registro, seguida de los registros), que se decodifica con Reader.
+ */
+
+#ifndef __PushButtonTrace__H
+#define __PushButtonTrace__H
+
+#include "mbed.h"
+#include "PushButton.h"
+
+
+class PushButtonTrace {
+  public:
+
+	/** Tipos de registro */
+	enum Kind {
+		KindFall = 0,						/// Flanco de bajada
+		KindRise,							/// Flanco de subida
+		KindPress,							/// Evento press notificado
+		KindHold,							/// Evento hold notificado
+		KindRelease,						/// Evento release notificado
+		KindGesture,						/// Gesto notificado (value: gesto << 8 | pulsaciones)
+		KindCancel,							/// Anulacion de una pulsacion inmediata notificada
+		KindStorm							/// Tormenta de interrupciones notificada
+	};
+
+	/** Opciones de funcionamiento del pulsador (Header::flags) */
+	enum Flags {
+		FlagLeadingEdge = (1 << 0)			/// Notificacion inmediata de las pulsaciones
+	};
+
+	/** Registro decodificado */
+	struct Record {
+		uint32_t ts_us;						/// Instante del registro
+		uint8_t kind;						/// Tipo de registro (Kind)
+		uint32_t value;						/// Dato adicional (KindGesture)
+	};
+
+	/** Cabecera de una traza exportada */
+	struct Header {
+		uint32_t base_ts_us;				/// Instante de referencia del primer registro
+		uint32_t filter_us;					/// Tiempo del filtro anti-glitch
+		uint32_t hold_us;					/// Periodo de los eventos hold (0: deshabilitados)
+		uint32_t dropped;					/// Registros descartados por desbordamiento
+		uint32_t length;					/// Bytes de registros
+		uint8_t base_level;					/// Nivel del pin en base_ts_us
+		uint8_t level;						/// Nivel logico de la pulsacion (PushButton::LogicLevel)
+		uint8_t filt_mode;					/// Motor de filtrado (PushButton::FilterMode)
+		uint8_t flags;						/// Opciones de funcionamiento (Flags)
+	};
+
+	static const uint32_t HeaderSize = 28;	/// Bytes de la cabecera exportada
+
+
+	/** Decodificador de una traza exportada con snapshot() */
+	class Reader {
+	  public:
+		/** Constructor
+		 *  @param blob Traza exportada
+		 *  @param len Bytes de la traza
+		 */
+		Reader(const uint8_t* blob, uint32_t len);
+
+		/** isValid
+	     *  Comprueba la cabecera de la traza
+	     *  @return true si la traza es valida
+	     */
+		bool isValid() { return _valid; }
+
+		/** getHeader
+	     *  Obtiene la cabecera de la traza
+	     *  @return Cabecera
+	     */
+		const Header& getHeader() { return _hdr; }
+
+		/** next
+	     *  Decodifica el siguiente registro
+	     *  @param rec Recibe el registro
+	     *  @return true si se decodifica, false al final de la traza
+	     */
+		bool next(Record& rec);
+
+	  private:
+		const uint8_t* _data;				/// Registros
+		uint32_t _pos;						/// Posicion del siguiente registro
+		uint32_t _ts_us;					/// Instante del ultimo registro decodificado
+		Header _hdr;						/// Cabecera
+		bool _valid;						/// Cabecera valida
+	};
+
+
+	/** Constructor
+	 *  @param buf Almacenamiento de los registros
+	 *  @param size Bytes del almacenamiento (potencia de 2)
+	 */
+	PushButtonTrace(uint8_t* buf, uint32_t size);
+
+
+	/** setup
+     *  Registra la configuracion del pulsador y reinicia la traza (invocado desde PushButton::setTraceRecorder)
+     *  @param level Nivel logico de la pulsacion
+     *  @param filt_mode Motor de filtrado
+     *  @param filter_us Tiempo del filtro anti-glitch
+     *  @param hold_us Periodo de los eventos hold
+     *  @param pin_level Nivel actual del pin
+     *  @param flags Opciones de funcionamiento (Flags)
+     */
+	void setup(PushButton::LogicLevel level, PushButton::FilterMode filt_mode, uint32_t filter_us, uint32_t hold_us, uint8_t pin_level,
+			uint8_t flags = 0);
+
+
+	/** record
+     *  Inserta un registro con el instante actual. Puede invocarse desde cualquier contexto
+     *  @param kind Tipo de registro
+     *  @param value Dato adicional (KindGesture)
+     */
+	void record(Kind kind, uint32_t value = 0);
+
+
+	/** clear
+     *  Descarta los registros, conservando la configuracion
+     */
+	void clear();
+
+
+	/** snapshot
+     *  Exporta la traza. Si el destino no admite todos los registros se exportan los mas recientes, y los omitidos
+     *  se contabilizan como descartados. Las interrupciones solo se enmascaran durante bloques de pocos registros
+     *  @param dst Destino
+     *  @param len Bytes del destino (HeaderSize + size() para la traza completa)
+     *  @return Bytes exportados o 0 si el destino no admite la cabecera o si los productores descartan de forma
+     *  continuada los registros en curso de exportar
+     */
+	uint32_t snapshot(uint8_t* dst, uint32_t len);
+
+
+	/** size
+     *  Obtiene el numero de bytes de registros almacenados
+     *  @return Bytes
+     */
+	uint32_t size() { return _head - _tail; }
+
+
+	/** getDroppedCount
+     *  Obtiene el numero de registros descartados para insertar otros mas recientes
+     *  @return Registros descartados
+     */
+	uint32_t getDroppedCount() { return _dropped; }
+
+  private:
+	uint8_t* _buf;							/// Almacenamiento
+	uint32_t _size;							/// Bytes del almacenamiento (potencia de 2)
+	uint32_t _head;							/// Contador libre de bytes escritos
+	uint32_t _tail;							/// Contador libre de bytes descartados
+	uint32_t _last_ts_us;					/// Instante del ultimo registro
+	uint32_t _base_ts_us;					/// Instante previo al registro mas antiguo
+	uint8_t _base_level;					/// Nivel del pin previo al registro mas antiguo
+	uint8_t _pin_level;						/// Nivel del pin tras el ultimo flanco registrado
+	uint32_t _dropped;						/// Registros descartados
+	Header _cfg;							/// Configuracion del pulsador
+
+	/** put
+     *  Escribe un entero de longitud variable
+     */
+	void put(uint64_t v);
+
+	/** get
+     *  Lee un entero de longitud variable desde una posicion del buffer
+     *  @param pos Posicion (contador libre), se actualiza tras la lectura
+     *  @return Valor leido
+     */
+	uint64_t get(uint32_t& pos);
+
+	/** dropOldest
+     *  Descarta el registro mas antiguo, actualizando el instante y el nivel de referencia
+     */
+	void dropOldest();
+};
+
+
+#endif /*__PushButtonTrace__H */
+
+/**** END OF FILE ****/
@@ -0,0 +1,147 @@
+/*
+ * bench_bank.cpp
+ *
+ *	Benchmark en host del filtrado de bancos de entradas muestreadas.
+ *
+ *	Procesa 100k instantaneas pseudoaleatorias (reproducibles) de un banco de 1 a 64 pulsadores con:
+ *	- per-button: un PushButtonDebouncer por pulsador, alimentado con el bit de cada entrada en cada muestra
+ *	  (equivalente a procesar cada pulsador por separado).
+ *	- bank32 / bank64: PushButtonBank con contadores verticales, una llamada a update() por muestra.
+ *	Para cada tamano informa del tiempo de CPU por muestra y del numero de flancos detectados. El coste de
+ *	PushButtonBank debe mantenerse constante con el numero de pulsadores.
+ *
+ *	Compilacion (desde este directorio):
+ *		g++ -O2 -std=c++11 -I../.. bench_bank.cpp -o bench_bank
+ */
+
+#include "PushButtonDebouncer.h"
+#include "PushButtonBank.h"
+#include <stdio.h>
+#include <vector>
+#include <chrono>
+
+
+//------------------------------------------------------------------------------------
+//-- BENCHMARK CONFIGURATION ---------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+static const uint32_t NumSamples = 100000;
+static const uint32_t SampleUs = 5000;
+static const uint32_t Repetitions = 20;
+
+/** Destino de los resultados, evita que el compilador descarte los calculos */
+static volatile uint32_t s_sink;
+
+
+//------------------------------------------------------------------------------------
+//-- SAMPLE GENERATOR ----------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+static uint32_t s_seed = 12345;
+static uint32_t rnd(uint32_t max){
+	s_seed = s_seed * 1103515245 + 12345;
+	return (s_seed >> 8) % max;
+}
+
+/** Genera instantaneas en reposo (bits a 1) con pulsaciones de ~50 muestras y rebotes en cada cambio */
+static std::vector<uint64_t> generateSamples(){
+	std::vector<uint64_t> samples;
+	uint64_t level = ~0ULL;
+	for(uint32_t i = 0; i < NumSamples; i++){
+		uint64_t sample = level;
+		uint32_t bit = rnd(64);
+		if(rnd(50) == 0){
+			level ^= (1ULL << bit);
+		}
+		else if(rnd(8) == 0){
+			sample ^= (1ULL << bit);
+		}
+		samples.push_back(sample);
+	}
+	return samples;
+}
+
+
+//------------------------------------------------------------------------------------
+//-- ENGINES -------------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+struct Result {
+	double ns_per_sample;
+	uint32_t edges;
+};
+
+/** Un PushButtonDebouncer por pulsador, con ventana equivalente a 4 muestras */
+static Result runPerButton(const std::vector<uint64_t>& samples, uint32_t buttons){
+	Result r = {0, 0};
+	auto t0 = std::chrono::steady_clock::now();
+	for(uint32_t rep = 0; rep < Repetitions; rep++){
+		std::vector<PushButtonDebouncer> db(buttons, PushButtonDebouncer(PushButtonDebouncer::StableTime, 3 * SampleUs));
+		std::vector<uint8_t> raw(buttons, 1);
+		for(uint32_t b = 0; b < buttons; b++){
+			db[b].reset(1, 0);
+		}
+		uint32_t edges = 0;
+		for(size_t i = 0; i < samples.size(); i++){
+			uint32_t now = (uint32_t)(i * SampleUs);
+			for(uint32_t b = 0; b < buttons; b++){
+				uint8_t level = (uint8_t)((samples[i] >> b) & 1);
+				if(level != raw[b]){
+					raw[b] = level;
+					db[b].edge(level, now);
+				}
+				edges += (db[b].update(now))? 1 : 0;
+			}
+		}
+		s_sink = edges;
+		r.edges = edges;
+	}
+	auto t1 = std::chrono::steady_clock::now();
+	r.ns_per_sample = std::chrono::duration<double, std::nano>(t1 - t0).count() / (Repetitions * samples.size());
+	return r;
+}
+
+/** Contadores verticales: una llamada a update() por muestra para todo el banco */
+template <typename Word>
+static Result runBank(const std::vector<uint64_t>& samples, uint32_t buttons){
+	Result r = {0, 0};
+	Word enabled = (buttons >= 8 * sizeof(Word))? ~(Word)0 : (Word)(((Word)1 << buttons) - 1);
+	std::vector<Word> words(samples.begin(), samples.end());
+	auto t0 = std::chrono::steady_clock::now();
+	for(uint32_t rep = 0; rep < Repetitions; rep++){
+		PushButtonBank<Word> bank(0, ~(Word)0, enabled);
+		uint32_t edges = 0;
+		for(size_t i = 0; i < words.size(); i++){
+			edges += (uint32_t)__builtin_popcountll((uint64_t)bank.update(words[i]));
+		}
+		s_sink = edges + (uint32_t)bank.getState();
+		r.edges = edges;
+	}
+	auto t1 = std::chrono::steady_clock::now();
+	r.ns_per_sample = std::chrono::duration<double, std::nano>(t1 - t0).count() / (Repetitions * samples.size());
+	return r;
+}
+
+
+//------------------------------------------------------------------------------------
+//-- ENTRY POINT ---------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+int main(){
+	std::vector<uint64_t> samples = generateSamples();
+	static const uint32_t sizes[] = { 1, 8, 16, 32, 64 };
+	printf("%u muestras, periodo %u us\n\n", (unsigned)samples.size(), SampleUs);
+	printf("%-8s %16s %16s %16s %8s\n", "buttons", "per-button ns/s", "bank32 ns/s", "bank64 ns/s", "edges");
+	for(uint32_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++){
+		Result pb = runPerButton(samples, sizes[i]);
+		Result b64 = runBank<uint64_t>(samples, sizes[i]);
+		if(sizes[i] <= 32){
+			Result b32 = runBank<uint32_t>(samples, sizes[i]);
+			printf("%-8u %16.2f %16.2f %16.2f %8u\n", sizes[i], pb.ns_per_sample, b32.ns_per_sample, b64.ns_per_sample, b64.edges);
+		}
+		else{
+			printf("%-8u %16.2f %16s %16.2f %8u\n", sizes[i], pb.ns_per_sample, "-", b64.ns_per_sample, b64.edges);
+		}
+	}
+	return 0;
+}
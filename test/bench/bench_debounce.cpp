@@ -0,0 +1,208 @@
+/*
+ * bench_debounce.cpp
+ *
+ *	Benchmark en host de los motores de filtrado anti-glitch de PushButton.
+ *
+ *	Genera una secuencia pseudoaleatoria (reproducible) de 10k flancos con rebotes y la procesa con:
+ *	- timer: modelo del filtrado actual, que reinicia _tick_filt en cada flanco. El servicio de timers se
+ *	  modela como una lista ordenada de timers activos (como la del RTOS), con varios timers de fondo.
+ *	- stable / integrator: PushButtonDebouncer, evaluado en cada flanco y reprogramando unicamente el
+ *	  timeout de espera del hilo de despacho.
+ *	Para cada motor informa del tiempo de CPU por flanco, de las llamadas al servicio de timers y de los
+ *	eventos press/release resultantes, que deben coincidir en todos los motores.
+ *
+ *	Compilacion (desde este directorio):
+ *		g++ -O2 -std=c++11 -I../.. bench_debounce.cpp -o bench_debounce
+ */
+
+#include "PushButtonDebouncer.h"
+#include <stdio.h>
+#include <vector>
+#include <list>
+#include <chrono>
+
+
+//------------------------------------------------------------------------------------
+//-- BENCHMARK CONFIGURATION ---------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+static const uint32_t NumEdges = 10000;
+static const uint32_t WindowUs = 20000;
+static const uint32_t BackgroundTimers = 8;
+static const uint32_t Repetitions = 200;
+
+
+//------------------------------------------------------------------------------------
+//-- EDGE GENERATOR ------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+struct Edge {
+	uint32_t ts_us;
+	uint8_t level;
+};
+
+static uint32_t s_seed = 12345;
+static uint32_t rnd(uint32_t max){
+	s_seed = s_seed * 1103515245 + 12345;
+	return (s_seed >> 8) % max;
+}
+
+/** Genera pulsaciones cada ~150ms con 2..16 rebotes de 50..800us en cada cambio de nivel */
+static std::vector<Edge> generateEdges(){
+	std::vector<Edge> edges;
+	uint32_t t = 1000;
+	uint8_t level = 1;
+	while(edges.size() < NumEdges){
+		uint8_t target = !level;
+		uint32_t bounces = 2 + 2 * rnd(8);
+		for(uint32_t i = 0; i <= bounces && edges.size() < NumEdges; i++){
+			level = (i % 2 == 0)? target : !target;
+			Edge e = { t, level };
+			edges.push_back(e);
+			t += 50 + rnd(750);
+		}
+		t += 100000 + rnd(100000);
+	}
+	return edges;
+}
+
+
+//------------------------------------------------------------------------------------
+//-- TIMER SERVICE MODEL -------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+/** Servicio de timers: lista ordenada por instante de expiracion */
+struct TimerService {
+	std::list<std::pair<uint32_t, int> > active;
+	uint32_t calls;
+
+	void start(int id, uint32_t deadline){
+		stop(id);
+		calls++;
+		std::list<std::pair<uint32_t, int> >::iterator it = active.begin();
+		while(it != active.end() && (int32_t)(it->first - deadline) <= 0){
+			++it;
+		}
+		active.insert(it, std::make_pair(deadline, id));
+	}
+
+	void stop(int id){
+		calls++;
+		for(std::list<std::pair<uint32_t, int> >::iterator it = active.begin(); it != active.end(); ++it){
+			if(it->second == id){
+				active.erase(it);
+				return;
+			}
+		}
+	}
+};
+
+struct Result {
+	double ns_per_edge;
+	uint32_t timer_calls;
+	uint32_t rearms;
+	uint32_t presses;
+	uint32_t releases;
+};
+
+
+//------------------------------------------------------------------------------------
+//-- ENGINES -------------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+/** Modelo del filtrado actual: reinicio de _tick_filt en cada flanco y lectura del pin al expirar */
+static Result runTimer(const std::vector<Edge>& edges){
+	Result r = {0, 0, 0, 0, 0};
+	auto t0 = std::chrono::steady_clock::now();
+	for(uint32_t rep = 0; rep < Repetitions; rep++){
+		TimerService svc;
+		svc.calls = 0;
+		for(uint32_t i = 0; i < BackgroundTimers; i++){
+			svc.start(100 + i, 0x7fffffff);
+		}
+		svc.calls = 0;
+		uint8_t stable = 1, curr = 1;
+		uint32_t presses = 0, releases = 0;
+		for(size_t i = 0; i < edges.size(); i++){
+			// expiraciones anteriores al flanco
+			if(!svc.active.empty() && svc.active.front().second == 0 && (int32_t)(svc.active.front().first - edges[i].ts_us) <= 0){
+				svc.active.pop_front();
+				if(curr != stable){
+					stable = curr;
+					(stable == 0)? presses++ : releases++;
+				}
+			}
+			curr = edges[i].level;
+			svc.start(0, edges[i].ts_us + WindowUs);
+		}
+		if(curr != stable){
+			stable = curr;
+			(stable == 0)? presses++ : releases++;
+		}
+		r.timer_calls = svc.calls;
+		r.presses = presses;
+		r.releases = releases;
+	}
+	auto t1 = std::chrono::steady_clock::now();
+	r.ns_per_edge = std::chrono::duration<double, std::nano>(t1 - t0).count() / (Repetitions * edges.size());
+	return r;
+}
+
+/** Filtro por marcas de tiempo: un flanco es una llamada a edge() y la espera se reprograma por lote */
+static Result runDebouncer(const std::vector<Edge>& edges, PushButtonDebouncer::Mode mode){
+	Result r = {0, 0, 0, 0, 0};
+	auto t0 = std::chrono::steady_clock::now();
+	for(uint32_t rep = 0; rep < Repetitions; rep++){
+		PushButtonDebouncer db(mode, WindowUs);
+		db.reset(1, 0);
+		uint32_t presses = 0, releases = 0, rearms = 0;
+		uint32_t deadline = 0;
+		bool waiting = false;
+		for(size_t i = 0; i < edges.size(); i++){
+			// despertar por timeout anterior al flanco
+			if(waiting && (int32_t)(deadline - edges[i].ts_us) <= 0){
+				if(db.update(deadline)){
+					(db.getStable() == 0)? presses++ : releases++;
+				}
+				waiting = db.isPending();
+				deadline += db.getRemaining(deadline);
+			}
+			db.edge(edges[i].level, edges[i].ts_us);
+			if(db.update(edges[i].ts_us)){
+				(db.getStable() == 0)? presses++ : releases++;
+			}
+			waiting = db.isPending();
+			deadline = edges[i].ts_us + db.getRemaining(edges[i].ts_us);
+			rearms++;
+		}
+		uint32_t end = edges.back().ts_us + 2 * WindowUs;
+		if(db.update(end)){
+			(db.getStable() == 0)? presses++ : releases++;
+		}
+		r.rearms = rearms;
+		r.presses = presses;
+		r.releases = releases;
+	}
+	auto t1 = std::chrono::steady_clock::now();
+	r.ns_per_edge = std::chrono::duration<double, std::nano>(t1 - t0).count() / (Repetitions * edges.size());
+	return r;
+}
+
+
+//------------------------------------------------------------------------------------
+//-- ENTRY POINT ---------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+static void print(const char* name, const Result& r){
+	printf("%-12s %10.1f %12u %12u %8u %8u\n", name, r.ns_per_edge, r.timer_calls, r.rearms, r.presses, r.releases);
+}
+
+int main(){
+	std::vector<Edge> edges = generateEdges();
+	printf("%u flancos, ventana %u us, %u timers de fondo\n\n", (unsigned)edges.size(), WindowUs, BackgroundTimers);
+	printf("%-12s %10s %12s %12s %8s %8s\n", "engine", "ns/edge", "timer_calls", "wait_rearms", "press", "release");
+	print("timer", runTimer(edges));
+	print("stable", runDebouncer(edges, PushButtonDebouncer::StableTime));
+	print("integrator", runDebouncer(edges, PushButtonDebouncer::Integrator));
+	return 0;
+}
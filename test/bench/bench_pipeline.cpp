@@ -0,0 +1,224 @@
+/*
+ * bench_pipeline.cpp
+ *
+ *	Benchmark en host del recorrido completo de un evento de PushButton sobre el HAL simulado de test/host:
+ *	ISR (isrRiseCallback/isrFallCallback) -> hilo de despacho (_task) -> filtro (timer o sin timer) ->
+ *	gpioFilterCallback/notifyLevel -> callback de usuario.
+ *
+ *	Ejecuta, para 1, 16 y 256 pulsadores, en modo independiente (hilo propio) y en modo grupo (gestores de 32
+ *	pulsadores), con filtrado por timer y de tiempo estable, tres secuencias de flancos reproducibles:
+ *	- clean: un flanco por transicion.
+ *	- bouncy: 5 rebotes de 300us por transicion.
+ *	- adversarial: rafagas de 40 flancos de 50us por transicion y glitches aislados de 10us entre transiciones,
+ *	  que no deben generar eventos. Los flancos descartados por desbordamiento se reportan en edge_overflows.
+ *
+ *	Emite una linea JSON por ejecucion, para su seguimiento entre versiones:
+ *	- events, expected: eventos press/release notificados y esperados.
+ *	- events_per_sec: eventos procesados por segundo de CPU del host (recorrido completo, incluido el HAL
+ *	  simulado, cuyo coste por flanco crece con el numero de hilos e InterruptIn).
+ *	- isr_ns: tiempo de CPU del host por ISR.
+ *	- lat_p50_us, lat_p99_us, lat_max_us: latencia en tiempo virtual desde el primer flanco hasta la callback
+ *	  (incluye la ventana de filtrado, FilterUs).
+ *	- allocs_per_button, heap_bytes_per_button: reservas de memoria dinamica durante la construccion, sin las
+ *	  del propio HAL simulado (mbed_sim::Counters::heap_allocs).
+ *	- sizeof_button: tamanio del objeto PushButton. sizeof_extension: tamanio de las funciones opcionales
+ *	  (PushButton::ExtensionStorage), que los pulsadores de este benchmark no reservan.
+ *	- bytes_per_button: memoria medida por pulsador: el objeto y las reservas durante su construccion mas la
+ *	  parte proporcional de los gestores (sin las pilas de los hilos, que reserva el HAL).
+ *
+ *	Compilacion (desde este directorio):
+ *		g++ -O2 -std=c++11 -I../host -I../.. bench_pipeline.cpp ../host/mbed_sim.cpp ../../PushButon.cpp
+ *			../../PushButtonManager.cpp ../../PushButtonEventQueue.cpp ../../PushButtonTrace.cpp ../../PushButtonSampler.cpp
+ *			-o bench_pipeline
+ */
+
+#include "mbed_sim.h"
+#include "PushButton.h"
+#include "PushButtonManager.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+
+
+//------------------------------------------------------------------------------------
+//-- BENCHMARK CONFIGURATION ---------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+static const uint32_t FilterUs = 20000;
+static const uint32_t TotalCycles = 1024;			/// Pulsaciones totales por ejecucion (repartidas entre pulsadores)
+static const uint32_t AdversarialDiv = 4;			/// Reduccion de pulsaciones en la secuencia adversarial (40 flancos)
+static const uint32_t CycleUs = 200000;				/// Periodo de pulsacion de cada pulsador
+static const uint32_t PinBase = 1000;
+
+
+//------------------------------------------------------------------------------------
+//-- EVENT RECORDING -----------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+static std::vector<PushButton*> s_btns;
+static std::vector<uint32_t> s_latency;
+static uint32_t s_events = 0;
+
+static void onEvent(uint32_t id){
+	s_events++;
+	if(s_latency.size() < s_latency.capacity()){
+		s_latency.push_back((uint32_t)mbed_sim::now_us() - s_btns[id]->getEventTimestamp());
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+//-- EDGE STREAMS --------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+enum Stream { Clean, Bouncy, Adversarial };
+static const char* StreamName[] = { "clean", "bouncy", "adversarial" };
+
+/** Programa una transicion con n flancos alternos separados spacing_us, terminando en 'level' */
+static void transition(PinName pin, int level, uint64_t at_us, uint32_t n, uint32_t spacing_us){
+	for(uint32_t i = 0; i < n; i++){
+		int l = ((n - 1 - i) % 2 == 0)? level : !level;
+		mbed_sim::schedule_pin(pin, l, at_us + i * spacing_us);
+	}
+}
+
+/** Programa una pulsacion de todos los pulsadores a partir del instante t_us */
+static void schedule(Stream stream, uint32_t buttons, uint64_t t_us){
+	for(uint32_t b = 0; b < buttons; b++){
+		PinName pin = PinBase + b;
+		// desfase entre pulsadores para repartir la carga del hilo de despacho
+		uint64_t t = t_us + 1000 + (uint64_t)b * (CycleUs / 2) / buttons;
+		switch(stream){
+			case Clean:
+				transition(pin, 0, t, 1, 0);
+				transition(pin, 1, t + CycleUs / 2, 1, 0);
+				break;
+			case Bouncy:
+				transition(pin, 0, t, 5, 300);
+				transition(pin, 1, t + CycleUs / 2, 5, 300);
+				break;
+			case Adversarial:
+				transition(pin, 0, t, 41, 50);
+				transition(pin, 1, t + CycleUs / 2, 41, 50);
+				// glitches aislados en reposo y pulsado
+				transition(pin, 0, t + CycleUs / 4, 2, 10);
+				transition(pin, 1, t + 3 * CycleUs / 4, 2, 10);
+				break;
+		}
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+//-- RUNNER --------------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+static uint32_t percentile(std::vector<uint32_t>& v, uint32_t pct){
+	if(v.empty()){
+		return 0;
+	}
+	size_t k = (v.size() - 1) * pct / 100;
+	std::nth_element(v.begin(), v.begin() + k, v.end());
+	return v[k];
+}
+
+static void run(bool group, PushButton::FilterMode filter, uint32_t buttons, Stream stream){
+	mbed_sim::reset();
+	s_btns.assign(buttons, NULL);
+	s_events = 0;
+	uint32_t total = (stream == Adversarial)? (TotalCycles / AdversarialDiv) : TotalCycles;
+	uint32_t cycles = (total / buttons > 0)? (total / buttons) : 1;
+	s_latency.clear();
+	s_latency.reserve(2 * cycles * buttons);
+
+	// construccion
+	std::vector<PushButtonManager*> mgrs;
+	for(uint32_t b = 0; b < buttons; b++){
+		mbed_sim::set_pin(PinBase + b, 1);
+	}
+	uint64_t mgr_bytes = mbed_sim::counters().heap_bytes;
+	if(group){
+		for(uint32_t m = 0; m < (buttons + PushButtonManager::MaxButtons - 1) / PushButtonManager::MaxButtons; m++){
+			mgrs.push_back(new PushButtonManager());
+		}
+	}
+	uint32_t allocs0 = mbed_sim::counters().heap_allocs;
+	uint64_t bytes0 = mbed_sim::counters().heap_bytes;
+	mgr_bytes = bytes0 - mgr_bytes;
+	for(uint32_t b = 0; b < buttons; b++){
+		PushButton* btn = (group)? new PushButton(mgrs[b / PushButtonManager::MaxButtons], PinBase + b, b, PushButton::PressIsLowLevel, PullUp, FilterUs)
+				: new PushButton(PinBase + b, b, PushButton::PressIsLowLevel, PullUp, FilterUs);
+		s_btns[b] = btn;
+		btn->setFilterMode(filter);
+		btn->enablePressEvents(callback(&onEvent));
+		btn->enableReleaseEvents(callback(&onEvent));
+	}
+	uint32_t allocs = mbed_sim::counters().heap_allocs - allocs0;
+	uint64_t alloc_bytes = mbed_sim::counters().heap_bytes - bytes0;
+	mbed_sim::run();
+
+	// procesado, programando cada pulsacion al inicio de su periodo
+	mbed_sim::counters().isr_calls = 0;
+	mbed_sim::counters().isr_host_ns = 0;
+	std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+	for(uint32_t c = 0; c < cycles; c++){
+		schedule(stream, buttons, mbed_sim::now_us());
+		mbed_sim::advance(CycleUs);
+	}
+	mbed_sim::advance(CycleUs);
+	std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+	double host_s = std::chrono::duration<double>(t1 - t0).count();
+
+	uint32_t overflows = 0;
+	for(uint32_t b = 0; b < buttons; b++){
+		overflows += (group)? 0 : s_btns[b]->getEdgeOverflowCount();
+	}
+	for(size_t m = 0; m < mgrs.size(); m++){
+		overflows += mgrs[m]->getEdgeOverflowCount();
+	}
+	std::vector<uint32_t> lat = s_latency;
+	uint32_t isr_calls = mbed_sim::counters().isr_calls;
+	printf("{\"bench\":\"pipeline\",\"mode\":\"%s\",\"filter\":\"%s\",\"buttons\":%u,\"stream\":\"%s\","
+			"\"events\":%u,\"expected\":%u,\"edges\":%u,\"edge_overflows\":%u,"
+			"\"events_per_sec\":%.0f,\"isr_ns\":%.1f,"
+			"\"lat_p50_us\":%u,\"lat_p99_us\":%u,\"lat_max_us\":%u,"
+			"\"allocs_per_button\":%.2f,\"heap_bytes_per_button\":%.1f,\"sizeof_button\":%u,\"sizeof_extension\":%u,"
+			"\"bytes_per_button\":%.1f}\n",
+			(group)? "group" : "standalone", (filter == PushButton::FilterTimer)? "timer" : "stable", buttons, StreamName[stream],
+			s_events, 2 * cycles * buttons, isr_calls, overflows,
+			(host_s > 0)? s_events / host_s : 0.0, (isr_calls > 0)? (double)mbed_sim::counters().isr_host_ns / isr_calls : 0.0,
+			percentile(lat, 50), percentile(lat, 99), (lat.empty())? 0 : *std::max_element(lat.begin(), lat.end()),
+			(double)allocs / buttons, (double)alloc_bytes / buttons, (uint32_t)sizeof(PushButton), (uint32_t)sizeof(PushButton::ExtensionStorage),
+			(double)(alloc_bytes + mgr_bytes) / buttons);
+
+	for(uint32_t b = 0; b < buttons; b++){
+		delete(s_btns[b]);
+	}
+	for(size_t m = 0; m < mgrs.size(); m++){
+		delete(mgrs[m]);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+//-- ENTRY POINT ---------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+int main(){
+	static const uint32_t sizes[] = { 1, 16, 256 };
+	static const PushButton::FilterMode filters[] = { PushButton::FilterTimer, PushButton::FilterStableTime };
+	for(uint32_t g = 0; g < 2; g++){
+		for(uint32_t f = 0; f < 2; f++){
+			for(uint32_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++){
+				for(uint32_t st = Clean; st <= Adversarial; st++){
+					run(g == 1, filters[f], sizes[s], (Stream)st);
+				}
+			}
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,220 @@
+/*
+ * bench_wheel.cpp
+ *
+ *	Benchmark en host del planificador de vencimientos de los pulsadores de un grupo.
+ *
+ *	Para grupos de 1 a 256 pulsadores, con un timer por pulsador y retardos pseudoaleatorios (reproducibles) de
+ *	1ms a 2s, mide el coste por operacion de:
+ *	- insert: inicio de los timers de todos los pulsadores.
+ *	- cancel: cancelacion de todos los timers en orden aleatorio.
+ *	- restart: reinicio de un timer aleatorio (el caso del filtro anti-glitch en cada rafaga de rebotes).
+ *	- expire: avance del tiempo hasta el siguiente vencimiento (getRemaining), como el hilo del gestor, hasta
+ *	  extraer todos los vencimientos (coste por vencimiento, incluidos el calculo de la espera y el avance).
+ *	con:
+ *	- list: lista ordenada por vencimiento, como la de los timers de un RTOS (insercion O(n)).
+ *	- wheel: PushButtonTimerWheel (insercion y cancelacion O(1)).
+ *
+ *	Compilacion (desde este directorio):
+ *		g++ -O2 -std=c++11 -I../.. bench_wheel.cpp -o bench_wheel
+ */
+
+#include "PushButtonTimerWheel.h"
+#include <stdio.h>
+#include <vector>
+#include <chrono>
+
+
+//------------------------------------------------------------------------------------
+//-- BENCHMARK CONFIGURATION ---------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+static const uint32_t TickUs = 1000;
+static const uint32_t MaxDelayMs = 2000;
+static const uint32_t Restarts = 100000;
+static const uint32_t Repetitions = 50;
+
+/** Destino de los resultados, evita que el compilador descarte los calculos */
+static volatile uint32_t s_sink;
+
+
+//------------------------------------------------------------------------------------
+//-- DELAY GENERATOR -----------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+static uint32_t s_seed = 12345;
+static uint32_t rnd(uint32_t max){
+	s_seed = s_seed * 1103515245 + 12345;
+	return (s_seed >> 8) % max;
+}
+
+
+//------------------------------------------------------------------------------------
+//-- ENGINES -------------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+/** Lista ordenada por vencimiento, con la misma interfaz que PushButtonTimerWheel */
+class SortedList {
+  public:
+	struct Node {
+		Node* next;
+		Node* prev;
+		uint32_t deadline;
+		bool armed;
+		Node() : next(NULL), prev(NULL), deadline(0), armed(false) {}
+	};
+
+	SortedList(uint32_t, uint32_t now_us) : _head(NULL), _now(now_us) {}
+
+	void start(Node* n, uint32_t delay_us, uint32_t, uint32_t now_us){
+		stop(n);
+		n->deadline = now_us + delay_us;
+		n->armed = true;
+		Node** pp = &_head;
+		Node* prev = NULL;
+		while(*pp && (int32_t)((*pp)->deadline - n->deadline) <= 0){
+			prev = *pp;
+			pp = &(*pp)->next;
+		}
+		n->next = *pp;
+		n->prev = prev;
+		if(n->next){
+			n->next->prev = n;
+		}
+		*pp = n;
+	}
+
+	void stop(Node* n){
+		if(!n->armed){
+			return;
+		}
+		if(n->prev){
+			n->prev->next = n->next;
+		}
+		else{
+			_head = n->next;
+		}
+		if(n->next){
+			n->next->prev = n->prev;
+		}
+		n->armed = false;
+	}
+
+	void advance(uint32_t now_us){
+		_now = now_us;
+	}
+
+	uint32_t getRemaining(uint32_t now_us){
+		if(_head == NULL){
+			return PushButtonTimerWheel::NoDeadline;
+		}
+		return ((int32_t)(_head->deadline - now_us) > 0)? (_head->deadline - now_us) : 0;
+	}
+
+	Node* popExpired(){
+		Node* n = _head;
+		if(n == NULL || (int32_t)(n->deadline - _now) > 0){
+			return NULL;
+		}
+		stop(n);
+		return n;
+	}
+
+  private:
+	Node* _head;
+	uint32_t _now;
+};
+
+
+struct Result {
+	double insert_ns;
+	double cancel_ns;
+	double restart_ns;
+	double expire_ns;
+};
+
+template <typename Engine>
+static Result run(uint32_t buttons){
+	Result r = {0, 0, 0, 0};
+	std::vector<uint32_t> delays(buttons), order(buttons), restart(Restarts);
+	for(uint32_t i = 0; i < buttons; i++){
+		delays[i] = TickUs * (1 + rnd(MaxDelayMs));
+		order[i] = i;
+	}
+	for(uint32_t i = 0; i < buttons; i++){
+		uint32_t j = rnd(buttons);
+		uint32_t t = order[i]; order[i] = order[j]; order[j] = t;
+	}
+	for(uint32_t i = 0; i < Restarts; i++){
+		restart[i] = rnd(buttons);
+	}
+	typedef std::chrono::steady_clock Clock;
+	Clock::duration insert(0), cancel(0), restarts(0), expire(0);
+	uint32_t fired = 0;
+	for(uint32_t rep = 0; rep < Repetitions; rep++){
+		Engine engine(TickUs, 0);
+		std::vector<typename Engine::Node> node(buttons);
+
+		Clock::time_point t0 = Clock::now();
+		for(uint32_t i = 0; i < buttons; i++){
+			engine.start(&node[i], delays[i], 0, 0);
+		}
+		Clock::time_point t1 = Clock::now();
+		for(uint32_t i = 0; i < buttons; i++){
+			engine.stop(&node[order[i]]);
+		}
+		Clock::time_point t2 = Clock::now();
+		insert += t1 - t0;
+		cancel += t2 - t1;
+
+		for(uint32_t i = 0; i < buttons; i++){
+			engine.start(&node[i], delays[i], 0, 0);
+		}
+		t0 = Clock::now();
+		for(uint32_t i = 0; i < Restarts; i++){
+			uint32_t k = restart[i];
+			engine.start(&node[k], delays[k], 0, 0);
+		}
+		t1 = Clock::now();
+		restarts += t1 - t0;
+
+		t0 = Clock::now();
+		uint32_t now = 0;
+		for(;;){
+			uint32_t remaining = engine.getRemaining(now);
+			if(remaining == PushButtonTimerWheel::NoDeadline){
+				break;
+			}
+			now += remaining;
+			engine.advance(now);
+			while(engine.popExpired() != NULL){
+				fired++;
+			}
+		}
+		t1 = Clock::now();
+		expire += t1 - t0;
+	}
+	s_sink = fired;
+	r.insert_ns = std::chrono::duration<double, std::nano>(insert).count() / (Repetitions * buttons);
+	r.cancel_ns = std::chrono::duration<double, std::nano>(cancel).count() / (Repetitions * buttons);
+	r.restart_ns = std::chrono::duration<double, std::nano>(restarts).count() / (Repetitions * Restarts);
+	r.expire_ns = std::chrono::duration<double, std::nano>(expire).count() / (Repetitions * buttons);
+	return r;
+}
+
+
+//------------------------------------------------------------------------------------
+//-- ENTRY POINT ---------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+int main(){
+	static const uint32_t sizes[] = { 1, 8, 32, 64, 128, 256 };
+	printf("retardos 1..%u ms, tick %u us, %u reinicios\n\n", MaxDelayMs, TickUs, Restarts);
+	printf("%-8s %-6s %12s %12s %12s %12s\n", "buttons", "engine", "insert ns", "cancel ns", "restart ns", "expire ns");
+	for(uint32_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++){
+		Result l = run<SortedList>(sizes[i]);
+		Result w = run<PushButtonTimerWheel>(sizes[i]);
+		printf("%-8u %-6s %12.2f %12.2f %12.2f %12.2f\n", sizes[i], "list", l.insert_ns, l.cancel_ns, l.restart_ns, l.expire_ns);
+		printf("%-8u %-6s %12.2f %12.2f %12.2f %12.2f\n", sizes[i], "wheel", w.insert_ns, w.cancel_ns, w.restart_ns, w.expire_ns);
+	}
+	return 0;
+}
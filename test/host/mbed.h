@@ -0,0 +1,263 @@
+/*
+ * mbed.h
+ *
+ *	HAL simulado para compilar y verificar los drivers en Linux sin hardware.
+ *
+ *	Reproduce la parte del API mbed que utiliza el componente (InterruptIn, DigitalIn, DigitalOut, RtosTimer, Thread,
+ *	Callback, Mutex y las secciones criticas) sobre un reloj virtual. Los hilos se ejecutan de forma
+ *	cooperativa (ucontext), por lo que cualquier secuencia de flancos es completamente determinista.
+ *	El control del reloj virtual y de los pines se realiza desde "mbed_sim.h".
+ */
+
+#ifndef __HOST_MBED__H
+#define __HOST_MBED__H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <functional>
+#include <type_traits>
+
+/** El HAL simulado se comporta como un target mbed */
+#ifndef __MBED__
+#define __MBED__	1
+#endif
+
+
+//------------------------------------------------------------------------------------
+//-- TIPOS BASICOS -------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+typedef int32_t PinName;
+typedef int32_t PinName32;
+static const PinName NC = (PinName)0xFFFFFFFF;
+
+enum PinMode {
+	PullNone,
+	PullUp,
+	PullDown,
+	PullDefault = PullUp
+};
+
+#define MBED_ASSERT(expr)	assert(expr)
+
+
+//------------------------------------------------------------------------------------
+//-- TRAZAS --------------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+namespace mbed_sim {
+/** Nivel de trazas: 0 desactivadas, 1 activadas */
+extern int trace_enabled;
+/** Flag que indica si el codigo en curso se ejecuta en contexto de ISR */
+extern bool in_isr;
+}
+
+#define IS_ISR()	(mbed_sim::in_isr)
+
+#define _HOST_TRACE(lvl, expr, mod, fmt, ...)	\
+	do{ if((expr) && mbed_sim::trace_enabled){ printf("%s %s " fmt "\n", lvl, mod, ##__VA_ARGS__); } }while(0)
+#define DEBUG_TRACE_E(expr, mod, fmt, ...)	_HOST_TRACE("E", expr, mod, fmt, ##__VA_ARGS__)
+#define DEBUG_TRACE_W(expr, mod, fmt, ...)	_HOST_TRACE("W", expr, mod, fmt, ##__VA_ARGS__)
+#define DEBUG_TRACE_I(expr, mod, fmt, ...)	_HOST_TRACE("I", expr, mod, fmt, ##__VA_ARGS__)
+#define DEBUG_TRACE_D(expr, mod, fmt, ...)	_HOST_TRACE("D", expr, mod, fmt, ##__VA_ARGS__)
+
+
+//------------------------------------------------------------------------------------
+//-- CALLBACK ------------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+template <typename F> class Callback;
+
+/** Como en mbed, el destino se guarda en el propio objeto (copiable con memcpy), sin memoria dinamica */
+template <typename R, typename... A>
+class Callback<R(A...)> {
+  public:
+	Callback(R (*func)(A...) = 0) : _thunk(0) {
+		if(func){
+			store([func](A... a) -> R { return func(a...); });
+		}
+	}
+
+	template <typename T, typename U>
+	Callback(U* obj, R (T::*method)(A...)) : _thunk(0) {
+		store([obj, method](A... a) -> R { return (obj->*method)(a...); });
+	}
+
+	template <typename T, typename U>
+	Callback(U* obj, R (*func)(T*, A...)) : _thunk(0) {
+		store([obj, func](A... a) -> R { return func(obj, a...); });
+	}
+
+	R call(A... a) const { return _thunk(&_storage, a...); }
+	R operator()(A... a) const { return _thunk(&_storage, a...); }
+	operator bool() const { return _thunk != 0; }
+
+  private:
+	struct Dummy {};
+	union Storage {
+		void* obj;
+		void (*func)();
+		void (Dummy::*method)();
+		unsigned char bytes[sizeof(void*) + sizeof(void (Dummy::*)())];
+	};
+
+	R (*_thunk)(const Storage*, A...);
+	Storage _storage;
+
+	template <typename F>
+	void store(const F& f){
+		static_assert(sizeof(F) <= sizeof(Storage) && alignof(F) <= alignof(Storage), "Callback: destino demasiado grande");
+		static_assert(std::is_trivially_copyable<F>::value, "Callback: destino no copiable");
+		memcpy(&_storage, &f, sizeof(F));
+		_thunk = [](const Storage* s, A... a) -> R { return (*reinterpret_cast<const F*>(s))(a...); };
+	}
+};
+
+template <typename R, typename... A>
+Callback<R(A...)> callback(R (*func)(A...) = 0) { return Callback<R(A...)>(func); }
+
+template <typename R, typename... A>
+Callback<R(A...)> callback(const Callback<R(A...)>& cb) { return cb; }
+
+template <typename T, typename U, typename R, typename... A>
+Callback<R(A...)> callback(U* obj, R (T::*method)(A...)) { return Callback<R(A...)>(obj, method); }
+
+template <typename T, typename U, typename R, typename... A>
+Callback<R(A...)> callback(U* obj, R (*func)(T*, A...)) { return Callback<R(A...)>(obj, func); }
+
+
+//------------------------------------------------------------------------------------
+//-- RTOS ----------------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+enum osPriority {
+	osPriorityIdle = -3,
+	osPriorityLow = -2,
+	osPriorityBelowNormal = -1,
+	osPriorityNormal = 0,
+	osPriorityAboveNormal = 1,
+	osPriorityHigh = 2,
+	osPriorityRealtime = 3
+};
+
+enum osStatus {
+	osOK = 0,
+	osEventSignal = 0x08,
+	osEventTimeout = 0x40,
+	osErrorParameter = 0x80
+};
+
+enum os_timer_type {
+	osTimerOnce = 0,
+	osTimerPeriodic = 1
+};
+
+#define osWaitForever		0xFFFFFFFFU
+#define osFlagsWaitAny		0
+#define OS_STACK_SIZE		4096
+
+struct osEvent {
+	osStatus status;
+	union {
+		uint32_t v;
+		void* p;
+		int32_t signals;
+	} value;
+};
+
+static inline void core_util_critical_section_enter(void) {}
+static inline void core_util_critical_section_exit(void) {}
+
+
+class Thread {
+  public:
+	Thread(osPriority priority = osPriorityNormal, uint32_t stack_size = OS_STACK_SIZE, unsigned char* stack_mem = NULL, const char* name = NULL);
+	~Thread();
+	osStatus start(Callback<void()> task);
+	int32_t signal_set(int32_t signals);
+	osEvent signal_wait(int32_t signals, uint32_t millisec = osWaitForever);
+	const char* get_name() { return _name; }
+	static osStatus wait(uint32_t millisec);
+
+	/** Estado interno del hilo simulado */
+	struct Ctx;
+  private:
+	Ctx* _ctx;
+	const char* _name;
+};
+
+
+class RtosTimer {
+  public:
+	RtosTimer(Callback<void()> func, os_timer_type type = osTimerPeriodic, const char* name = NULL);
+	~RtosTimer();
+	osStatus start(uint32_t millisec);
+	osStatus stop();
+
+	/** Estado interno del timer simulado */
+	struct Ctx;
+  private:
+	Ctx* _ctx;
+};
+
+
+class Mutex {
+  public:
+	osStatus lock(uint32_t /*millisec*/ = osWaitForever) { return osOK; }
+	osStatus unlock() { return osOK; }
+};
+
+
+//------------------------------------------------------------------------------------
+//-- GPIO ----------------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+class InterruptIn {
+  public:
+	InterruptIn(PinName pin);
+	~InterruptIn();
+	int read();
+	void mode(PinMode pull);
+	void rise(Callback<void()> func);
+	void fall(Callback<void()> func);
+	operator int() { return read(); }
+
+	/** Estado interno del pin simulado */
+	struct Ctx;
+  private:
+	Ctx* _ctx;
+};
+
+
+class DigitalOut {
+  public:
+	DigitalOut(PinName pin, int value = 0);
+	void write(int value);
+	int read() { return _value; }
+	DigitalOut& operator=(int value) { write(value); return *this; }
+	operator int() { return read(); }
+  private:
+	PinName _pin;
+	int _value;
+};
+
+
+class DigitalIn {
+  public:
+	DigitalIn(PinName pin, PinMode pull = PullDefault);
+	int read();
+	void mode(PinMode /*pull*/) {}
+	operator int() { return read(); }
+  private:
+	PinName _pin;
+};
+
+
+/** Lectura del reloj virtual en microsegundos */
+uint32_t us_ticker_read(void);
+
+
+#endif /*__HOST_MBED__H */
@@ -0,0 +1,589 @@
+/*
+ * mbed_sim.cpp
+ *
+ *	Implementacion del HAL simulado descrito en "mbed.h" y "mbed_sim.h".
+ */
+
+#include "mbed_sim.h"
+#include <ucontext.h>
+#include <stdlib.h>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <new>
+
+
+//------------------------------------------------------------------------------------
+//--- PRIVATE TYPES ------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+static const uint64_t NoDeadline = (uint64_t)-1;
+static const uint32_t MinHostStackSize = 256 * 1024;
+
+struct Thread::Ctx {
+	Thread* owner;
+	ucontext_t uc;
+	char* stack;
+	Callback<void()> task;
+	int32_t flags;
+	int32_t wait_mask;
+	bool started;
+	bool waiting;
+	bool runnable;
+	bool finished;
+	uint64_t wait_deadline;
+	osEvent result;
+};
+
+struct RtosTimer::Ctx {
+	Callback<void()> func;
+	os_timer_type type;
+	bool running;
+	uint64_t period_us;
+	uint64_t deadline;
+};
+
+struct InterruptIn::Ctx {
+	PinName pin;
+	Callback<void()> rise;
+	Callback<void()> fall;
+};
+
+struct PinChange {
+	uint64_t at_us;
+	uint32_t seq;
+	PinName pin;
+	int level;
+};
+
+namespace mbed_sim {
+int trace_enabled = 0;
+bool in_isr = false;
+}
+
+static uint64_t s_now = 0;
+static uint32_t s_seq = 0;
+static mbed_sim::Counters s_counters;
+static std::map<PinName, int> s_pins;
+static std::vector<PinChange> s_changes;
+static std::vector<Thread::Ctx*> s_threads;
+static std::vector<RtosTimer::Ctx*> s_timers;
+static std::vector<InterruptIn::Ctx*> s_iins;
+static ucontext_t s_sched_uc;
+static Thread::Ctx* s_current = NULL;
+static std::function<void(PinName, int)> s_output_observer;
+static uint32_t s_host_allocs = 0;
+
+
+/** Las reservas del propio HAL (contexto de los objetos simulados, listas internas) no existen en el target y
+ *  no se contabilizan en Counters::heap_allocs
+ */
+struct HostAlloc {
+	HostAlloc() { s_host_allocs++; }
+	~HostAlloc() { s_host_allocs--; }
+};
+
+/** Copia de una lista interna, por si los hilos, timers o ISRs que se ejecutan la modifican */
+template <typename T>
+static std::vector<T> hostCopy(const std::vector<T>& list){
+	HostAlloc host;
+	return list;
+}
+
+
+//------------------------------------------------------------------------------------
+//--- PRIVATE FUNCTIONS --------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------------
+__attribute__((noinline)) void* operator new(size_t size){
+	if(s_host_allocs == 0){
+		s_counters.heap_allocs++;
+		s_counters.heap_bytes += size;
+	}
+	void* p = malloc((size > 0)? size : 1);
+	if(!p){
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+
+//------------------------------------------------------------------------------------
+void* operator new[](size_t size){
+	return operator new(size);
+}
+
+
+//------------------------------------------------------------------------------------
+__attribute__((noinline)) void operator delete(void* ptr) noexcept {
+	free(ptr);
+}
+
+
+//------------------------------------------------------------------------------------
+void operator delete[](void* ptr) noexcept {
+	operator delete(ptr);
+}
+
+
+//------------------------------------------------------------------------------------
+void operator delete(void* ptr, size_t) noexcept {
+	operator delete(ptr);
+}
+
+
+//------------------------------------------------------------------------------------
+void operator delete[](void* ptr, size_t) noexcept {
+	operator delete(ptr);
+}
+
+//------------------------------------------------------------------------------------
+static void threadEntry(){
+	Thread::Ctx* ctx = s_current;
+	ctx->task.call();
+	ctx->finished = true;
+	ctx->runnable = false;
+	swapcontext(&ctx->uc, &s_sched_uc);
+}
+
+
+//------------------------------------------------------------------------------------
+static void applyPin(PinName pin, int level){
+	int prev = mbed_sim::get_pin(pin);
+	{
+		HostAlloc host;
+		s_pins[pin] = level;
+	}
+	if(prev == level){
+		return;
+	}
+	std::vector<InterruptIn::Ctx*> iins = hostCopy(s_iins);
+	for(InterruptIn::Ctx* c : iins){
+		if(c->pin != pin || std::find(s_iins.begin(), s_iins.end(), c) == s_iins.end()){
+			continue;
+		}
+		Callback<void()> cb = (level)? c->rise : c->fall;
+		if(cb){
+			s_counters.isr_calls++;
+			mbed_sim::in_isr = true;
+			std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+			cb.call();
+			s_counters.isr_host_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+			mbed_sim::in_isr = false;
+		}
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+static uint64_t nextDeadline(){
+	uint64_t next = NoDeadline;
+	for(const PinChange& p : s_changes){
+		next = std::min(next, p.at_us);
+	}
+	for(RtosTimer::Ctx* t : s_timers){
+		if(t->running){
+			next = std::min(next, t->deadline);
+		}
+	}
+	for(Thread::Ctx* t : s_threads){
+		if(t->waiting){
+			next = std::min(next, t->wait_deadline);
+		}
+	}
+	return next;
+}
+
+
+//------------------------------------------------------------------------------------
+static void fireDeadlines(){
+	// cambios de pin en orden de programacion
+	std::sort(s_changes.begin(), s_changes.end(), [](const PinChange& a, const PinChange& b){
+		return (a.at_us != b.at_us)? (a.at_us < b.at_us) : (a.seq < b.seq);
+	});
+	while(!s_changes.empty() && s_changes.front().at_us <= s_now){
+		PinChange p = s_changes.front();
+		s_changes.erase(s_changes.begin());
+		applyPin(p.pin, p.level);
+		mbed_sim::run();
+	}
+	// expiracion de timers
+	std::vector<RtosTimer::Ctx*> timers = hostCopy(s_timers);
+	for(RtosTimer::Ctx* t : timers){
+		if(std::find(s_timers.begin(), s_timers.end(), t) == s_timers.end() || !t->running || t->deadline > s_now){
+			continue;
+		}
+		if(t->type == osTimerPeriodic){
+			t->deadline += t->period_us;
+		}
+		else{
+			t->running = false;
+		}
+		s_counters.timer_fires++;
+		t->func.call();
+		mbed_sim::run();
+	}
+	// timeouts de hilos
+	for(Thread::Ctx* t : s_threads){
+		if(t->waiting && t->wait_deadline <= s_now){
+			t->waiting = false;
+			t->runnable = true;
+			t->result.status = osEventTimeout;
+			t->result.value.signals = 0;
+		}
+	}
+	mbed_sim::run();
+}
+
+
+//------------------------------------------------------------------------------------
+//-- SIMULATION CONTROL --------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------------
+void mbed_sim::reset(uint64_t start_us){
+	s_now = start_us;
+	s_seq = 0;
+	s_pins.clear();
+	s_changes.clear();
+	s_output_observer = nullptr;
+	memset(&s_counters, 0, sizeof(s_counters));
+}
+
+
+//------------------------------------------------------------------------------------
+uint64_t mbed_sim::now_us(){
+	return s_now;
+}
+
+
+//------------------------------------------------------------------------------------
+void mbed_sim::set_pin(PinName pin, int level){
+	applyPin(pin, (level)? 1 : 0);
+	run();
+}
+
+
+//------------------------------------------------------------------------------------
+int mbed_sim::get_pin(PinName pin){
+	std::map<PinName, int>::iterator it = s_pins.find(pin);
+	return (it == s_pins.end())? 0 : it->second;
+}
+
+
+//------------------------------------------------------------------------------------
+void mbed_sim::schedule_pin(PinName pin, int level, uint64_t at_us){
+	HostAlloc host;
+	PinChange p = { at_us, s_seq++, pin, (level)? 1 : 0 };
+	s_changes.push_back(p);
+}
+
+
+//------------------------------------------------------------------------------------
+void mbed_sim::advance(uint64_t us){
+	run_until(s_now + us);
+}
+
+
+//------------------------------------------------------------------------------------
+void mbed_sim::run_until(uint64_t at_us){
+	run();
+	for(;;){
+		uint64_t next = nextDeadline();
+		if(next == NoDeadline || next > at_us){
+			break;
+		}
+		if(next > s_now){
+			s_now = next;
+		}
+		fireDeadlines();
+	}
+	if(at_us > s_now){
+		s_now = at_us;
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+void mbed_sim::busy(uint64_t us){
+	s_now += us;
+}
+
+
+//------------------------------------------------------------------------------------
+void mbed_sim::run(){
+	if(s_current){
+		return;
+	}
+	bool pending = true;
+	while(pending){
+		pending = false;
+		std::vector<Thread::Ctx*> threads = hostCopy(s_threads);
+		for(Thread::Ctx* t : threads){
+			if(std::find(s_threads.begin(), s_threads.end(), t) == s_threads.end() || !t->runnable){
+				continue;
+			}
+			if(t->started){
+				s_counters.thread_wakeups++;
+			}
+			t->started = true;
+			t->runnable = false;
+			s_current = t;
+			swapcontext(&s_sched_uc, &t->uc);
+			s_current = NULL;
+			pending = true;
+		}
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+Thread* mbed_sim::current_thread(){
+	return (s_current)? s_current->owner : NULL;
+}
+
+
+//------------------------------------------------------------------------------------
+void mbed_sim::on_output(std::function<void(PinName, int)> observer){
+	s_output_observer = observer;
+}
+
+
+//------------------------------------------------------------------------------------
+mbed_sim::Counters& mbed_sim::counters(){
+	return s_counters;
+}
+
+
+//------------------------------------------------------------------------------------
+uint32_t mbed_sim::timer_count(){
+	return (uint32_t)s_timers.size();
+}
+
+
+//------------------------------------------------------------------------------------
+uint32_t us_ticker_read(void){
+	return (uint32_t)s_now;
+}
+
+
+//------------------------------------------------------------------------------------
+//-- THREAD --------------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------------
+Thread::Thread(osPriority /*priority*/, uint32_t stack_size, unsigned char* /*stack_mem*/, const char* name) : _name(name) {
+	HostAlloc host;
+	_ctx = new Ctx();
+	_ctx->owner = this;
+	_ctx->stack = (char*)malloc(std::max(stack_size, MinHostStackSize));
+	_ctx->flags = 0;
+	_ctx->wait_mask = 0;
+	_ctx->started = false;
+	_ctx->waiting = false;
+	_ctx->runnable = false;
+	_ctx->finished = false;
+	_ctx->wait_deadline = NoDeadline;
+	getcontext(&_ctx->uc);
+	_ctx->uc.uc_stack.ss_sp = _ctx->stack;
+	_ctx->uc.uc_stack.ss_size = std::max(stack_size, MinHostStackSize);
+	_ctx->uc.uc_link = NULL;
+	makecontext(&_ctx->uc, threadEntry, 0);
+	s_threads.push_back(_ctx);
+}
+
+
+//------------------------------------------------------------------------------------
+Thread::~Thread(){
+	s_threads.erase(std::remove(s_threads.begin(), s_threads.end(), _ctx), s_threads.end());
+	free(_ctx->stack);
+	delete(_ctx);
+}
+
+
+//------------------------------------------------------------------------------------
+osStatus Thread::start(Callback<void()> task){
+	_ctx->task = task;
+	_ctx->runnable = true;
+	return osOK;
+}
+
+
+//------------------------------------------------------------------------------------
+int32_t Thread::signal_set(int32_t signals){
+	s_counters.signal_sets++;
+	_ctx->flags |= signals;
+	if(_ctx->waiting && (_ctx->wait_mask == 0 || (_ctx->flags & _ctx->wait_mask) == _ctx->wait_mask)){
+		_ctx->waiting = false;
+		_ctx->runnable = true;
+		_ctx->result.status = osEventSignal;
+		_ctx->result.value.signals = (_ctx->wait_mask == 0)? _ctx->flags : _ctx->wait_mask;
+		_ctx->flags &= ~_ctx->result.value.signals;
+	}
+	return _ctx->flags;
+}
+
+
+//------------------------------------------------------------------------------------
+osEvent Thread::signal_wait(int32_t signals, uint32_t millisec){
+	Ctx* ctx = s_current;
+	MBED_ASSERT(ctx);
+	osEvent oe;
+	if((signals == 0 && ctx->flags != 0) || (signals != 0 && (ctx->flags & signals) == signals)){
+		oe.status = osEventSignal;
+		oe.value.signals = (signals == 0)? ctx->flags : signals;
+		ctx->flags &= ~oe.value.signals;
+		return oe;
+	}
+	if(millisec == 0){
+		oe.status = osOK;
+		oe.value.signals = 0;
+		return oe;
+	}
+	ctx->wait_mask = signals;
+	ctx->waiting = true;
+	ctx->wait_deadline = (millisec == osWaitForever)? NoDeadline : (s_now + (uint64_t)millisec * 1000);
+	swapcontext(&ctx->uc, &s_sched_uc);
+	return ctx->result;
+}
+
+
+//------------------------------------------------------------------------------------
+osStatus Thread::wait(uint32_t millisec){
+	// espera sin senales: solo finaliza por timeout (mascara que ningun signal_set completa)
+	Ctx* ctx = s_current;
+	MBED_ASSERT(ctx);
+	ctx->wait_mask = (int32_t)0x80000000;
+	ctx->waiting = true;
+	ctx->wait_deadline = s_now + (uint64_t)millisec * 1000;
+	swapcontext(&ctx->uc, &s_sched_uc);
+	return osEventTimeout;
+}
+
+
+//------------------------------------------------------------------------------------
+//-- RTOS TIMER ----------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------------
+RtosTimer::RtosTimer(Callback<void()> func, os_timer_type type, const char* /*name*/){
+	HostAlloc host;
+	_ctx = new Ctx();
+	_ctx->func = func;
+	_ctx->type = type;
+	_ctx->running = false;
+	_ctx->period_us = 0;
+	_ctx->deadline = NoDeadline;
+	s_timers.push_back(_ctx);
+}
+
+
+//------------------------------------------------------------------------------------
+RtosTimer::~RtosTimer(){
+	s_timers.erase(std::remove(s_timers.begin(), s_timers.end(), _ctx), s_timers.end());
+	delete(_ctx);
+}
+
+
+//------------------------------------------------------------------------------------
+osStatus RtosTimer::start(uint32_t millisec){
+	s_counters.timer_starts++;
+	_ctx->period_us = (uint64_t)millisec * 1000;
+	_ctx->deadline = s_now + _ctx->period_us;
+	_ctx->running = true;
+	return osOK;
+}
+
+
+//------------------------------------------------------------------------------------
+osStatus RtosTimer::stop(){
+	s_counters.timer_stops++;
+	_ctx->running = false;
+	return osOK;
+}
+
+
+//------------------------------------------------------------------------------------
+//-- GPIO ----------------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------------
+InterruptIn::InterruptIn(PinName pin){
+	HostAlloc host;
+	_ctx = new Ctx();
+	_ctx->pin = pin;
+	s_iins.push_back(_ctx);
+}
+
+
+//------------------------------------------------------------------------------------
+InterruptIn::~InterruptIn(){
+	s_iins.erase(std::remove(s_iins.begin(), s_iins.end(), _ctx), s_iins.end());
+	delete(_ctx);
+}
+
+
+//------------------------------------------------------------------------------------
+int InterruptIn::read(){
+	s_counters.pin_reads++;
+	return mbed_sim::get_pin(_ctx->pin);
+}
+
+
+//------------------------------------------------------------------------------------
+void InterruptIn::mode(PinMode /*pull*/){
+}
+
+
+//------------------------------------------------------------------------------------
+void InterruptIn::rise(Callback<void()> func){
+	_ctx->rise = func;
+}
+
+
+//------------------------------------------------------------------------------------
+void InterruptIn::fall(Callback<void()> func){
+	_ctx->fall = func;
+}
+
+
+//------------------------------------------------------------------------------------
+DigitalOut::DigitalOut(PinName pin, int value) : _pin(pin), _value(-1) {
+	write(value);
+}
+
+
+//------------------------------------------------------------------------------------
+void DigitalOut::write(int value){
+	value = (value)? 1 : 0;
+	if(value == _value){
+		return;
+	}
+	_value = value;
+	{
+		HostAlloc host;
+		s_pins[_pin] = value;
+	}
+	if(s_output_observer){
+		s_output_observer(_pin, value);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+DigitalIn::DigitalIn(PinName pin, PinMode /*pull*/) : _pin(pin) {
+}
+
+
+//------------------------------------------------------------------------------------
+int DigitalIn::read(){
+	s_counters.pin_reads++;
+	return mbed_sim::get_pin(_pin);
+}
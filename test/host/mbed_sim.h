@@ -0,0 +1,77 @@
+/*
+ * mbed_sim.h
+ *
+ *	Control del HAL simulado: reloj virtual, nivel de los pines y planificador cooperativo de hilos.
+ *
+ *	Todas las acciones se ejecutan sobre el reloj virtual. Al cambiar un pin se ejecuta la ISR asociada
+ *	y a continuacion todos los hilos listos, de forma que la latencia hilo/timer en tiempo virtual es nula
+ *	y las secuencias resultantes no dependen de la carga del host.
+ */
+
+#ifndef __HOST_MBED_SIM__H
+#define __HOST_MBED_SIM__H
+
+#include "mbed.h"
+
+namespace mbed_sim {
+
+/** Contadores de actividad del HAL simulado */
+struct Counters {
+	uint32_t isr_calls;			/// ISRs de InterruptIn ejecutadas
+	uint32_t timer_starts;		/// Llamadas a RtosTimer::start
+	uint32_t timer_stops;		/// Llamadas a RtosTimer::stop
+	uint32_t timer_fires;		/// Expiraciones de RtosTimer
+	uint32_t signal_sets;		/// Llamadas a Thread::signal_set
+	uint32_t thread_wakeups;	/// Reanudaciones de hilos bloqueados en signal_wait
+	uint32_t pin_reads;			/// Lecturas de pin (InterruptIn/DigitalIn)
+	uint64_t isr_host_ns;		/// Tiempo de CPU del host consumido en las ISRs de InterruptIn
+	uint32_t heap_allocs;		/// Reservas de memoria dinamica (operator new) fuera del propio HAL simulado
+	uint64_t heap_bytes;		/// Bytes reservados en heap_allocs
+};
+
+/** Reinicia reloj, pines y contadores. Los objetos vivos (hilos, timers, pines) se mantienen.
+ *  @param start_us Valor inicial del reloj virtual (permite verificar desbordamientos de 32 bits)
+ */
+void reset(uint64_t start_us = 0);
+
+/** Tiempo virtual actual en microsegundos */
+uint64_t now_us();
+
+/** Cambia el nivel de un pin de forma inmediata, ejecutando las ISRs y los hilos listos */
+void set_pin(PinName pin, int level);
+
+/** Lee el nivel actual de un pin */
+int get_pin(PinName pin);
+
+/** Programa un cambio de nivel en un instante absoluto del reloj virtual */
+void schedule_pin(PinName pin, int level, uint64_t at_us);
+
+/** Avanza el reloj virtual ejecutando en orden todos los eventos pendientes (pines, timers, timeouts) */
+void advance(uint64_t us);
+
+/** Avanza el reloj virtual hasta un instante absoluto */
+void run_until(uint64_t at_us);
+
+/** Simula tiempo de CPU consumido por el codigo en curso: avanza el reloj sin procesar eventos, que se
+ *  atenderan con retraso en la siguiente llamada a advance() */
+void busy(uint64_t us);
+
+/** Ejecuta los hilos listos hasta que todos quedan bloqueados */
+void run();
+
+/** Hilo simulado en ejecucion, o NULL desde una ISR, el servicio de timers o el hilo principal del test */
+Thread* current_thread();
+
+/** Instala un observador de escrituras en DigitalOut, que permite modelar circuitos externos (p.ej. una
+ *  matriz de teclas) actualizando otros pines con set_pin() en funcion de las salidas */
+void on_output(std::function<void(PinName, int)> observer);
+
+/** Contadores de actividad acumulados desde el ultimo reset */
+Counters& counters();
+
+/** Numero de objetos RtosTimer existentes */
+uint32_t timer_count();
+
+}
+
+#endif /*__HOST_MBED_SIM__H */
@@ -0,0 +1,12 @@
+/*
+ * mdf_api_cortex.h
+ *
+ *	Sustituto vacio del adaptador MDF para Cortex utilizado por el HAL simulado.
+ */
+
+#ifndef __HOST_MDF_API_CORTEX__H
+#define __HOST_MDF_API_CORTEX__H
+
+#include "mbed.h"
+
+#endif /*__HOST_MDF_API_CORTEX__H */
@@ -0,0 +1,1319 @@
+/*
+ * test_host_PushButton.cpp
+ *
+ *	Test unitario en host para el modulo Driver_PushButton, sobre el HAL simulado.
+ *
+ *	Cada test programa una secuencia de flancos (rebotes, glitches, pulsaciones largas) sobre el reloj
+ *	virtual y verifica la secuencia press/hold/release resultante, asi como la latencia de cada evento en
+ *	tiempo virtual respecto del primer flanco que lo origino.
+ *
+ *	Compilacion y ejecucion: ver "Host tests" en README.md
+ */
+
+
+//------------------------------------------------------------------------------------
+//-- TEST HEADERS --------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+#include "mbed_sim.h"
+#include "unity.h"
+#include "PushButton.h"
+#include "PushButtonManager.h"
+#include "PushButtonPool.h"
+#include "PushButtonEventQueue.h"
+#include <vector>
+
+
+//------------------------------------------------------------------------------------
+//-- SPECIFIC COMPONENTS FOR TESTING -------------------------------------------------
+//------------------------------------------------------------------------------------
+
+static const uint32_t FilterUs = 20000;
+static const uint32_t HoldMs = 100;
+
+
+/** Evento registrado: tipo ('P'ress, 'H'old, 'R'elease), pulsador, instante virtual y marca del evento */
+struct Event {
+	char type;
+	uint32_t id;
+	uint64_t t_us;
+	uint32_t ts_us;
+};
+
+static std::vector<Event> events;
+static PushButton* btns[32];
+
+/** Hilo desde el que se invoca cada callback de eventos o gestos */
+static std::vector<Thread*> contexts;
+
+
+//------------------------------------------------------------------------------------
+static void record(char type, uint32_t id){
+	Event e = { type, id, mbed_sim::now_us(), btns[id]->getEventTimestamp() };
+	events.push_back(e);
+	contexts.push_back(mbed_sim::current_thread());
+}
+static void onPressed(uint32_t id){ record('P', id); }
+static void onHold(uint32_t id){ record('H', id); }
+static void onReleased(uint32_t id){ record('R', id); }
+static void onPressed2(){ record('P', 0); }
+static void onReleased2(){ record('R', 0); }
+
+
+//------------------------------------------------------------------------------------
+static uint32_t countEvents(char type, uint32_t id = 0){
+	uint32_t n = 0;
+	for(size_t i = 0; i < events.size(); i++){
+		n += (events[i].type == type && events[i].id == id)? 1 : 0;
+	}
+	return n;
+}
+
+
+//------------------------------------------------------------------------------------
+static const Event* findEvent(char type, uint32_t id = 0){
+	for(size_t i = 0; i < events.size(); i++){
+		if(events[i].type == type && events[i].id == id){
+			return &events[i];
+		}
+	}
+	return NULL;
+}
+
+
+/** Latencia en tiempo virtual desde el primer flanco de la rafaga hasta la callback */
+static uint32_t latency(const Event* e){
+	return (uint32_t)e->t_us - e->ts_us;
+}
+
+
+//------------------------------------------------------------------------------------
+static void reportLatency(const char* scenario){
+	uint32_t min = 0xFFFFFFFF, max = 0;
+	for(size_t i = 0; i < events.size(); i++){
+		if(events[i].type != 'H'){
+			uint32_t l = latency(&events[i]);
+			min = (l < min)? l : min;
+			max = (l > max)? l : max;
+		}
+	}
+	if(max > 0){
+		printf("      %-28s latencia press/release: min=%uus max=%uus\n", scenario, min, max);
+	}
+}
+
+
+/** Programa una transicion con rebotes: n flancos alternos separados spacing_us, terminando en 'level' */
+static uint64_t bounce(PinName pin, int level, uint64_t at_us, uint32_t n, uint32_t spacing_us){
+	for(uint32_t i = 0; i < n; i++){
+		int l = ((n - 1 - i) % 2 == 0)? level : !level;
+		mbed_sim::schedule_pin(pin, l, at_us + i * spacing_us);
+	}
+	return at_us + (n - 1) * spacing_us;
+}
+
+
+//------------------------------------------------------------------------------------
+static PushButton* newButton(PinName pin, uint32_t id, PushButtonManager* mgr = NULL){
+	mbed_sim::set_pin(pin, 1);
+	PushButton* btn = (mgr)? new PushButton(mgr, pin, id, PushButton::PressIsLowLevel, PullUp, FilterUs)
+			: new PushButton(pin, id, PushButton::PressIsLowLevel, PullUp, FilterUs);
+	btns[id] = btn;
+	btn->enablePressEvents(callback(&onPressed));
+	btn->enableHoldEvents(callback(&onHold), HoldMs);
+	btn->enableReleaseEvents(callback(&onReleased));
+	mbed_sim::run();
+	return btn;
+}
+
+
+//------------------------------------------------------------------------------------
+static void setup(uint64_t start_us = 0){
+	mbed_sim::reset(start_us);
+	events.clear();
+	contexts.clear();
+}
+
+
+//------------------------------------------------------------------------------------
+//-- TEST CASES ----------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Pulsacion limpia con eventos hold", "[Driver_PushButton]") {
+	setup();
+	PushButton* btn = newButton(1, 0);
+	mbed_sim::schedule_pin(1, 0, 10000);
+	mbed_sim::schedule_pin(1, 1, 360000);
+	mbed_sim::advance(500000);
+
+	TEST_ASSERT_EQUAL(1, countEvents('P'));
+	TEST_ASSERT_EQUAL(3, countEvents('H'));
+	TEST_ASSERT_EQUAL(1, countEvents('R'));
+	TEST_ASSERT_EQUAL(10000, findEvent('P')->ts_us);
+	TEST_ASSERT_EQUAL(FilterUs, latency(findEvent('P')));
+	TEST_ASSERT_EQUAL(FilterUs, latency(findEvent('R')));
+	TEST_ASSERT_EQUAL(10000 + FilterUs + 1000 * HoldMs, findEvent('H')->t_us);
+	reportLatency("limpia");
+	delete(btn);
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Pulsacion con rebotes", "[Driver_PushButton]") {
+	setup();
+	PushButton* btn = newButton(2, 0);
+	uint64_t last = bounce(2, 0, 10000, 7, 300);
+	bounce(2, 1, 200000, 5, 500);
+	mbed_sim::advance(400000);
+
+	TEST_ASSERT_EQUAL(1, countEvents('P'));
+	TEST_ASSERT_EQUAL(1, countEvents('R'));
+	TEST_ASSERT_EQUAL(10000, findEvent('P')->ts_us);
+	TEST_ASSERT_EQUAL(last + FilterUs, findEvent('P')->t_us);
+	TEST_ASSERT_EQUAL(0, btn->getEdgeOverflowCount());
+	reportLatency("rebotes");
+	delete(btn);
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Glitch descartado", "[Driver_PushButton]") {
+	setup();
+	PushButton* btn = newButton(3, 0);
+	mbed_sim::schedule_pin(3, 0, 10000);
+	mbed_sim::schedule_pin(3, 1, 12000);
+	mbed_sim::advance(200000);
+
+	TEST_ASSERT_EQUAL(0, events.size());
+	delete(btn);
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Filtros sin timer", "[Driver_PushButton]") {
+	const PushButton::FilterMode modes[] = { PushButton::FilterStableTime, PushButton::FilterIntegrator };
+	for(uint32_t m = 0; m < 2; m++){
+		setup();
+		PushButton* btn = newButton(4, 0);
+		btn->disableHoldEvents();
+		btn->setFilterMode(modes[m]);
+		mbed_sim::counters().timer_starts = 0;
+		bounce(4, 0, 10000, 7, 300);
+		mbed_sim::schedule_pin(4, 1, 12000 + FilterUs);
+		mbed_sim::schedule_pin(4, 0, 12500 + FilterUs);
+		bounce(4, 1, 200000, 5, 500);
+		mbed_sim::schedule_pin(4, 0, 300000);
+		mbed_sim::schedule_pin(4, 1, 301000);
+		mbed_sim::advance(400000);
+
+		TEST_ASSERT_EQUAL(1, countEvents('P'));
+		TEST_ASSERT_EQUAL(1, countEvents('R'));
+		TEST_ASSERT_EQUAL(0, mbed_sim::counters().timer_starts);
+		TEST_ASSERT_EQUAL(10000, findEvent('P')->ts_us);
+		TEST_ASSERT_EQUAL(200000, findEvent('R')->ts_us);
+		reportLatency((m == 0)? "sin timer (stable)" : "sin timer (integrator)");
+		delete(btn);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Filtro adaptativo al rebote del contacto", "[Driver_PushButton]") {
+	for(uint32_t group = 0; group < 2; group++){
+		setup();
+		PushButtonManager* mgr = (group)? new PushButtonManager() : NULL;
+		PushButton* btn = newButton(8, 0, mgr);
+		btn->disableHoldEvents();
+		btn->setAdaptiveFilter();
+		PushButtonBounceEstimator::Config cfg;
+
+		// 8 pulsaciones con 5 flancos de rebote cada 300us en cada transicion: la ventana baja hasta el minimo
+		uint64_t t = 10000;
+		uint64_t last = 0;
+		for(uint32_t i = 0; i < 8; i++, t += 100000){
+			last = bounce(8, 0, t, 5, 300);
+			bounce(8, 1, t + 50000, 5, 300);
+		}
+		mbed_sim::advance(t);
+		TEST_ASSERT_EQUAL(8, countEvents('P'));
+		TEST_ASSERT_EQUAL(8, countEvents('R'));
+		TEST_ASSERT_EQUAL(10000 + 1200 + FilterUs, events[0].t_us);
+		PushButtonBounceEstimator::Stats stats;
+		btn->getBounceStats(stats);
+		TEST_ASSERT_EQUAL(cfg.min_us, stats.window_us);
+		TEST_ASSERT_EQUAL(300, stats.gap_us);
+		TEST_ASSERT_EQUAL(1200, stats.max_bounce_us);
+		TEST_ASSERT_EQUAL(16, stats.bursts);
+
+		// ventana aprendida: la pulsacion se notifica tras la ventana minima
+		events.clear();
+		last = bounce(8, 0, t, 5, 300);
+		mbed_sim::advance(50000);
+		TEST_ASSERT_EQUAL(1, countEvents('P'));
+		TEST_ASSERT_EQUAL(last + cfg.min_us, findEvent('P')->t_us);
+		TEST_ASSERT_EQUAL(t, findEvent('P')->ts_us);
+
+		// un rebote de 3ms, mayor que la ventana, continua tras la pulsacion sin generar eventos y amplia la ventana
+		events.clear();
+		t += 50000;
+		bounce(8, 1, t, 3, 300);
+		mbed_sim::schedule_pin(8, 0, t + 3600);
+		mbed_sim::schedule_pin(8, 1, t + 3900);
+		mbed_sim::advance(50000);
+		TEST_ASSERT_EQUAL(1, countEvents('R'));
+		TEST_ASSERT_EQUAL(0, countEvents('P'));
+		btn->getBounceStats(stats);
+		TEST_ASSERT_EQUAL(1, stats.late_bounces);
+		TEST_ASSERT_EQUAL(3000 * (100 + cfg.margin_pct) / 100, stats.window_us);
+		TEST_ASSERT_EQUAL(0, stats.noise_errors);
+		TEST_ASSERT_EQUAL(0, mbed_sim::counters().timer_starts);
+		reportLatency("adaptativo");
+		delete(btn);
+		delete(mgr);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+static void onCancelled(uint32_t id){ record('C', id); }
+
+/** En modo grupo los timers tienen la resolucion de la rueda de timers (1ms) */
+static bool nearTimer(uint64_t t_us, uint64_t expected_us){
+	return t_us >= expected_us && t_us - expected_us <= 1000;
+}
+
+TEST_CASE("Notificacion inmediata de pulsaciones", "[Driver_PushButton]") {
+	const PushButton::FilterMode modes[] = { PushButton::FilterTimer, PushButton::FilterStableTime };
+	for(uint32_t run = 0; run < 4; run++){
+		setup();
+		PushButtonManager* mgr = (run & 2)? new PushButtonManager() : NULL;
+		PushButton* btn = newButton(9, 0, mgr);
+		btn->setFilterMode(modes[run & 1]);
+		btn->enableCancelEvents(callback(&onCancelled));
+		btn->setLeadingEdgeMode(true);
+
+		// pulsacion con rebotes: press en el primer flanco, hold desde la pulsacion y release tras el filtrado
+		bounce(9, 0, 10000, 7, 300);
+		bounce(9, 1, 200000, 5, 300);
+		// glitch: press inmediato anulado tras el filtrado, sin eventos hold ni release
+		mbed_sim::schedule_pin(9, 0, 300000);
+		mbed_sim::schedule_pin(9, 1, 302000);
+		// pulsacion limpia
+		mbed_sim::schedule_pin(9, 0, 500000);
+		mbed_sim::schedule_pin(9, 1, 600000);
+		mbed_sim::advance(700000);
+
+		const char seq[] = "PHHRPCPHR";
+		TEST_ASSERT_EQUAL(sizeof(seq) - 1, events.size());
+		for(uint32_t i = 0; i < events.size(); i++){
+			TEST_ASSERT_EQUAL(seq[i], events[i].type);
+		}
+		TEST_ASSERT_EQUAL(10000, events[0].t_us);
+		TEST_ASSERT_TRUE(nearTimer(events[1].t_us, 10000 + 1000 * HoldMs));
+		TEST_ASSERT_TRUE(nearTimer(events[3].t_us, 200000 + 1200 + FilterUs));
+		TEST_ASSERT_EQUAL(300000, events[4].t_us);
+		TEST_ASSERT_TRUE(nearTimer(events[5].t_us, 302000 + FilterUs));
+		TEST_ASSERT_EQUAL(300000, events[5].ts_us);
+		TEST_ASSERT_EQUAL(500000, events[6].t_us);
+		if(mgr){
+			TEST_ASSERT_EQUAL(0, mgr->getPressedMask());
+		}
+
+		// sin notificacion inmediata, la pulsacion se notifica tras el filtrado
+		events.clear();
+		btn->setLeadingEdgeMode(false);
+		mbed_sim::schedule_pin(9, 0, 800000);
+		mbed_sim::schedule_pin(9, 1, 850000);
+		mbed_sim::advance(200000);
+		TEST_ASSERT_TRUE(nearTimer(findEvent('P')->t_us, 800000 + FilterUs));
+		delete(btn);
+		delete(mgr);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+static void onStorm(uint32_t id){ record('S', id); }
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Proteccion frente a tormentas de interrupciones", "[Driver_PushButton]") {
+	for(uint32_t run = 0; run < 2; run++){
+		setup();
+		PushButtonManager* mgr = (run == 1)? new PushButtonManager() : NULL;
+		PushButton* btn = newButton(11, 0, mgr);
+		btn->enableStormEvents(callback(&onStorm));
+		btn->setStormProtection(20, 10, 100);
+
+		// los rebotes de una pulsacion normal no alcanzan el umbral
+		bounce(11, 0, 10000, 7, 300);
+		bounce(11, 1, 200000, 7, 300);
+		mbed_sim::advance(300000);
+		TEST_ASSERT_EQUAL(1, countEvents('P'));
+		TEST_ASSERT_EQUAL(1, countEvents('R'));
+		TEST_ASSERT_EQUAL(0, countEvents('S'));
+
+		// contacto defectuoso: 4000 flancos cada 50us que terminan en reposo. Se enmascara en el flanco 21 durante
+		// 100ms y, al repetirse tras habilitar de nuevo las ISR, durante 200ms. La tormenta no genera eventos
+		events.clear();
+		uint32_t isr_calls = mbed_sim::counters().isr_calls;
+		for(uint32_t i = 0; i < 4000; i++){
+			mbed_sim::schedule_pin(11, (i % 2 == 0)? 0 : 1, 400000 + i * 50);
+		}
+		mbed_sim::advance(500000);
+		TEST_ASSERT_EQUAL(2, events.size());
+		TEST_ASSERT_EQUAL(2, countEvents('S'));
+		TEST_ASSERT_EQUAL(401000, events[0].t_us);
+		TEST_ASSERT_EQUAL(401000, events[0].ts_us);
+		TEST_ASSERT_TRUE(mbed_sim::counters().isr_calls - isr_calls <= 2 * 21);
+		PushButton::StormStats st;
+		btn->getStormStats(st);
+		TEST_ASSERT_EQUAL(2, st.storms);
+		TEST_ASSERT_EQUAL(200, st.backoff_ms);
+		TEST_ASSERT_FALSE(st.masked);
+		TEST_ASSERT_TRUE(st.masked_ms >= 300 && st.masked_ms <= 302);
+
+		// la pulsacion durante el enmascaramiento se notifica al finalizar este, con el enmascaramiento inicial
+		events.clear();
+		for(uint32_t i = 0; i <= 1000; i++){
+			mbed_sim::schedule_pin(11, (i % 2 == 0)? 0 : 1, 1200000 + i * 50);
+		}
+		mbed_sim::schedule_pin(11, 1, 1400000);
+		mbed_sim::advance(700000);
+		TEST_ASSERT_EQUAL(1, countEvents('S'));
+		TEST_ASSERT_EQUAL(1, countEvents('P'));
+		TEST_ASSERT_EQUAL(1, countEvents('R'));
+		TEST_ASSERT_TRUE(nearTimer(findEvent('P')->t_us, 1301000 + FilterUs));
+		btn->getStormStats(st);
+		TEST_ASSERT_EQUAL(3, st.storms);
+		TEST_ASSERT_EQUAL(100, st.backoff_ms);
+		if(mgr){
+			TEST_ASSERT_EQUAL(0, mgr->getPressedMask());
+		}
+		delete(btn);
+		delete(mgr);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Tormenta al vencer el filtro", "[Driver_PushButton]") {
+	setup();
+	PushButton* btn = newButton(12, 0);
+	btn->enableStormEvents(callback(&onStorm));
+	btn->setStormProtection(4, 100, 100);
+
+	// flancos cada 20ms: el quinto detecta la tormenta en el mismo instante en que vence el filtro iniciado por el
+	// cuarto. La rafaga se descarta y la pulsacion solo se notifica tras finalizar el enmascaramiento
+	for(uint32_t i = 0; i < 5; i++){
+		mbed_sim::schedule_pin(12, (i % 2 == 0)? 0 : 1, 10000 + i * FilterUs);
+	}
+	mbed_sim::advance(250000);
+	TEST_ASSERT_EQUAL(2, events.size());
+	TEST_ASSERT_EQUAL('S', events[0].type);
+	TEST_ASSERT_EQUAL('P', events[1].type);
+	TEST_ASSERT_TRUE(nearTimer(events[1].t_us, 10000 + 4 * FilterUs + 100000 + FilterUs));
+	TEST_ASSERT_TRUE(contexts[0] != NULL);
+	for(size_t i = 1; i < contexts.size(); i++){
+		TEST_ASSERT_TRUE(contexts[i] == contexts[0]);
+	}
+	delete(btn);
+}
+
+
+/** Evento hold con perfil: instante virtual, numero de evento y tiempo pulsado, o escalon alcanzado (repeat 0) */
+struct HoldRepeat {
+	uint64_t t_us;
+	uint32_t repeat;
+	uint32_t held_ms;
+};
+
+static std::vector<HoldRepeat> repeats;
+
+
+//------------------------------------------------------------------------------------
+static void onHoldRepeat(uint32_t /*id*/, uint32_t repeat, uint32_t held_ms){
+	HoldRepeat r = { mbed_sim::now_us(), repeat, held_ms };
+	repeats.push_back(r);
+}
+static void onHoldStep(uint32_t /*id*/, uint8_t step){
+	HoldRepeat r = { mbed_sim::now_us(), 0, step };
+	repeats.push_back(r);
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Perfil de aceleracion de eventos hold", "[Driver_PushButton]") {
+	PushButton::HoldProfile profile;
+	profile.delay_ms = 500;
+	profile.period_ms = 200;
+	profile.steps = 2;
+	profile.step[0].after_ms = 2000;
+	profile.step[0].period_ms = 50;
+	profile.step[1].after_ms = 2300;
+	profile.step[1].period_ms = 20;
+	for(uint32_t run = 0; run < 3; run++){
+		setup();
+		repeats.clear();
+		PushButtonManager* mgr = (run == 1)? new PushButtonManager() : NULL;
+		PushButton* btn = newButton(12, 0, mgr);
+		btn->setLowPowerMode(run == 2);
+		btn->enableHoldEvents(callback(&onHoldRepeat), profile);
+		btn->enableHoldStepEvents(callback(&onHoldStep));
+		uint32_t starts = mbed_sim::counters().timer_starts;
+
+		// pulsacion de 2.5s: hold cada 200ms desde los 500ms, cada 50ms desde los 2s y cada 20ms desde los 2.3s
+		mbed_sim::schedule_pin(12, 0, 10000);
+		mbed_sim::schedule_pin(12, 1, 2510000);
+		mbed_sim::advance(3000000);
+		TEST_ASSERT_EQUAL(1, countEvents('P'));
+		TEST_ASSERT_EQUAL(1, countEvents('R'));
+
+		uint32_t repeat = 0;
+		uint32_t step = 0;
+		for(size_t i = 0; i < repeats.size(); i++){
+			const HoldRepeat& r = repeats[i];
+			if(r.repeat == 0){
+				// el escalon se notifica antes del primer evento hold que lo aplica
+				TEST_ASSERT_EQUAL(++step, r.held_ms);
+				TEST_ASSERT_TRUE(i + 1 < repeats.size() && repeats[i + 1].t_us == r.t_us);
+				continue;
+			}
+			TEST_ASSERT_EQUAL(++repeat, r.repeat);
+			TEST_ASSERT_EQUAL((uint32_t)((r.t_us - 10000) / 1000), r.held_ms);
+			const HoldRepeat* prev = (i > 0 && repeats[i - 1].repeat == 0)? &repeats[i - 2] : ((i > 0)? &repeats[i - 1] : NULL);
+			if(prev == NULL){
+				TEST_ASSERT_TRUE(r.held_ms >= 500 && r.held_ms <= 500 + FilterUs / 1000 + 1);
+				continue;
+			}
+			uint32_t expected = (prev->held_ms >= 2300)? 20 : ((prev->held_ms >= 2000)? 50 : 200);
+			TEST_ASSERT_TRUE(nearTimer(r.t_us, prev->t_us + 1000 * expected));
+		}
+		TEST_ASSERT_EQUAL(2, step);
+		TEST_ASSERT_TRUE(repeat >= 18);
+		// el perfil se aplica tambien a la callback hold de periodo fijo
+		TEST_ASSERT_EQUAL(repeat, countEvents('H'));
+		// solo se reprograma el timer del pulsador al cambiar el periodo, no en cada evento hold
+		if(mgr == NULL && run == 0){
+			TEST_ASSERT_TRUE(mbed_sim::counters().timer_starts - starts <= 6);
+		}
+		delete(btn);
+		delete(mgr);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+static void onSlowHold(uint32_t id, uint32_t repeat, uint32_t held_ms){
+	onHoldRepeat(id, repeat, held_ms);
+	mbed_sim::busy(3000);
+}
+
+TEST_CASE("Perfil de aceleracion con callbacks lentas", "[Driver_PushButton]") {
+	// el timer propio se reprograma desde el vencimiento nominal: las callbacks no retrasan los eventos hold
+	PushButton::HoldProfile profile;
+	profile.delay_ms = 500;
+	profile.period_ms = 200;
+	profile.steps = 1;
+	profile.step[0].after_ms = 900;
+	profile.step[0].period_ms = 50;
+	for(uint32_t run = 0; run < 2; run++){
+		setup();
+		repeats.clear();
+		PushButtonManager* mgr = (run == 1)? new PushButtonManager() : NULL;
+		PushButton* btn = newButton(13, 0, mgr);
+		btn->enableHoldEvents(callback(&onSlowHold), profile);
+		mbed_sim::schedule_pin(13, 0, 10000);
+		mbed_sim::schedule_pin(13, 1, 1210000);
+		mbed_sim::advance(1500000);
+		TEST_ASSERT_EQUAL(1, countEvents('R'));
+		TEST_ASSERT_TRUE(repeats.size() >= 8);
+		for(size_t i = 1; i < repeats.size(); i++){
+			uint32_t expected = (i <= 2)? 200 : 50;
+			TEST_ASSERT_TRUE(nearTimer(repeats[i].t_us, repeats[i - 1].t_us + 1000 * expected));
+		}
+		delete(btn);
+		delete(mgr);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Consulta del estado sin callbacks", "[Driver_PushButton]") {
+	setup();
+	PushButtonManager* mgr = new PushButtonManager();
+	PushButton* grp[3];
+	for(uint32_t i = 0; i < 3; i++){
+		mbed_sim::set_pin(13 + i, 1);
+		grp[i] = (i == 2)? new PushButton(13 + i, i, PushButton::PressIsLowLevel, PullUp, FilterUs)
+				: new PushButton(mgr, 13 + i, i, PushButton::PressIsLowLevel, PullUp, FilterUs);
+	}
+	// sin callbacks, solo consulta del estado
+	grp[0]->enableStateTracking();
+	grp[2]->enableStateTracking();
+	// con eventos hold
+	btns[1] = grp[1];
+	grp[1]->enableHoldEvents(callback(&onHold), HoldMs);
+	mbed_sim::run();
+
+	PushButton::State st;
+	grp[0]->getState(st);
+	TEST_ASSERT_FALSE(st.pressed);
+	TEST_ASSERT_EQUAL(0, st.presses);
+
+	// dos pulsaciones en el primero, una mantenida en el segundo y otra en curso en el tercero
+	bounce(13, 0, 10000, 5, 300);
+	bounce(13, 1, 100000, 5, 300);
+	mbed_sim::schedule_pin(13, 0, 200000);
+	mbed_sim::schedule_pin(14, 0, 200000);
+	mbed_sim::schedule_pin(15, 0, 300000);
+	mbed_sim::advance(450000);
+
+	grp[0]->getState(st);
+	TEST_ASSERT_TRUE(st.pressed);
+	TEST_ASSERT_EQUAL(2, st.presses);
+	TEST_ASSERT_EQUAL(1, st.releases);
+	TEST_ASSERT_EQUAL(200000, st.press_ts_us);
+	TEST_ASSERT_EQUAL(0, st.holds);
+	grp[1]->getState(st);
+	TEST_ASSERT_TRUE(st.pressed);
+	TEST_ASSERT_EQUAL(2, st.holds);
+	TEST_ASSERT_EQUAL(2, countEvents('H', 1));
+
+	// mascaras del grupo y de un conjunto arbitrario de pulsadores
+	TEST_ASSERT_EQUAL(0x3, mgr->getPressedMask());
+	TEST_ASSERT_EQUAL(0x2, mgr->getHeldMask());
+	TEST_ASSERT_EQUAL(0x7, PushButton::getPressedMask(grp, 3));
+
+	// las pulsaciones desde la ultima consulta son la diferencia de contadores
+	uint32_t presses = st.presses;
+	mbed_sim::schedule_pin(14, 1, 500000);
+	mbed_sim::schedule_pin(14, 0, 600000);
+	mbed_sim::schedule_pin(14, 1, 650000);
+	mbed_sim::advance(300000);
+	grp[1]->getState(st);
+	TEST_ASSERT_FALSE(st.pressed);
+	TEST_ASSERT_EQUAL(1, st.presses - presses);
+	TEST_ASSERT_EQUAL(2, st.releases);
+	TEST_ASSERT_EQUAL(0, st.holds);
+	TEST_ASSERT_EQUAL(0x1, mgr->getPressedMask());
+	TEST_ASSERT_EQUAL(0, mgr->getHeldMask());
+	TEST_ASSERT_EQUAL(0x5, PushButton::getPressedMask(grp, 3));
+	for(uint32_t i = 0; i < 3; i++){
+		delete(grp[i]);
+	}
+	delete(mgr);
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Desinstala callbacks hold", "[Driver_PushButton]") {
+	setup();
+	PushButton* btn = newButton(5, 0);
+	mbed_sim::schedule_pin(5, 0, 10000);
+	mbed_sim::advance(250000);
+	btn->disableHoldEvents();
+	mbed_sim::advance(250000);
+	mbed_sim::set_pin(5, 1);
+	mbed_sim::advance(50000);
+
+	TEST_ASSERT_EQUAL(2, countEvents('H'));
+	TEST_ASSERT_EQUAL(1, countEvents('R'));
+	delete(btn);
+}
+
+
+//------------------------------------------------------------------------------------
+static void onPressedAgain(uint32_t id){ record('Q', id); }
+static void onPressedReconfig(uint32_t id){
+	record('P', id);
+	// dos publicaciones mientras la configuracion en curso sigue en uso
+	btns[id]->disablePressEvents();
+	btns[id]->enablePressEvents(callback(&onPressedAgain));
+}
+static void onHoldDisable(uint32_t id){
+	record('H', id);
+	btns[id]->disableHoldEvents();
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Reconfiguracion desde las callbacks", "[Driver_PushButton]") {
+	for(uint32_t group = 0; group < 2; group++){
+		setup();
+		PushButtonManager* mgr = (group)? new PushButtonManager() : NULL;
+		PushButton* btn = newButton(7, 0, mgr);
+		btn->enablePressEvents(callback(&onPressedReconfig));
+		btn->enableHoldEvents(callback(&onHoldDisable), HoldMs);
+		mbed_sim::schedule_pin(7, 0, 10000);
+		mbed_sim::schedule_pin(7, 1, 400000);
+		mbed_sim::schedule_pin(7, 0, 500000);
+		mbed_sim::schedule_pin(7, 1, 800000);
+		mbed_sim::advance(900000);
+
+		// la primera pulsacion usa la configuracion vigente y la siguiente la nueva; tras deshabilitar los
+		// eventos hold desde su propia callback no se generan mas
+		TEST_ASSERT_EQUAL(1, countEvents('P'));
+		TEST_ASSERT_EQUAL(1, countEvents('Q'));
+		TEST_ASSERT_EQUAL(1, countEvents('H'));
+		TEST_ASSERT_EQUAL(2, countEvents('R'));
+		TEST_ASSERT_UINT32_WITHIN(1000, 10000 + FilterUs + 1000 * HoldMs, findEvent('H')->t_us);
+		if(mgr){
+			TEST_ASSERT_EQUAL(0, mgr->getTimerCount());
+		}
+		delete(btn);
+		delete(mgr);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Reconfiguracion durante una rafaga", "[Driver_PushButton]") {
+	for(uint32_t group = 0; group < 2; group++){
+		setup();
+		PushButtonManager* mgr = (group)? new PushButtonManager() : NULL;
+		PushButton* btn = newButton(16, 0, mgr);
+		btn->setFilterMode(PushButton::FilterStableTime);
+		bounce(16, 0, 10000, 5, 400);
+		mbed_sim::schedule_pin(16, 1, 200000);
+		mbed_sim::advance(11000);
+		// la reconfiguracion desde la aplicacion no altera el filtrado en curso del hilo de despacho
+		btn->enableReleaseEvents(callback(&onReleased));
+		mbed_sim::advance(289000);
+
+		TEST_ASSERT_EQUAL(1, countEvents('P'));
+		TEST_ASSERT_EQUAL(1, countEvents('R'));
+		TEST_ASSERT_EQUAL(10000, findEvent('P')->ts_us);
+		delete(btn);
+		delete(mgr);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Reconfiguracion del despacho durante una pulsacion", "[Driver_PushButton]") {
+	for(uint32_t group = 0; group < 2; group++){
+		setup();
+		PushButtonManager* mgr = (group)? new PushButtonManager() : NULL;
+		PushButton* btn = newButton(18, 0, mgr);
+		mbed_sim::schedule_pin(18, 0, 10000);
+		mbed_sim::schedule_pin(18, 1, 600000);
+		mbed_sim::advance(200000);
+		TEST_ASSERT_EQUAL(1, countEvents('H'));
+
+		// el modo de bajo consumo se publica de inmediato y el hilo de despacho continua el evento hold en curso
+		// sin timer; tras desinstalar las callbacks hold, el propio hilo los detiene
+		btn->setLowPowerMode(true);
+		TEST_ASSERT_EQUAL(PushButton::FilterStableTime, btn->getFilterMode());
+		mbed_sim::advance(150000);
+		TEST_ASSERT_EQUAL(2, countEvents('H'));
+		TEST_ASSERT_EQUAL(200000 + 1000 * HoldMs, events.back().t_us);
+		btn->disableHoldEvents();
+		mbed_sim::advance(500000);
+		TEST_ASSERT_EQUAL(2, countEvents('H'));
+		TEST_ASSERT_EQUAL(1, countEvents('R'));
+		TEST_ASSERT_EQUAL(600000, findEvent('R')->ts_us);
+		if(mgr){
+			TEST_ASSERT_EQUAL(0, mgr->getTimerCount());
+		}
+		TEST_ASSERT_TRUE(contexts[0] != NULL);
+		for(size_t i = 1; i < contexts.size(); i++){
+			TEST_ASSERT_TRUE(contexts[i] == contexts[0]);
+		}
+		delete(btn);
+		delete(mgr);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Callbacks void", "[Driver_PushButton]") {
+	setup();
+	mbed_sim::set_pin(6, 1);
+	PushButton* btn = new PushButton(6, 0, PushButton::PressIsLowLevel, PullUp, FilterUs);
+	btns[0] = btn;
+	btn->enablePressEvents(callback(&onPressed2));
+	btn->enableReleaseEvents(callback(&onReleased2));
+	mbed_sim::schedule_pin(6, 0, 10000);
+	mbed_sim::schedule_pin(6, 1, 100000);
+	mbed_sim::advance(200000);
+
+	TEST_ASSERT_EQUAL(1, countEvents('P'));
+	TEST_ASSERT_EQUAL(1, countEvents('R'));
+	delete(btn);
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Desbordamiento del contador de microsegundos", "[Driver_PushButton]") {
+	setup(0xFFFFFFFFULL - 15000);
+	PushButton* btn = newButton(7, 0);
+	btn->setFilterMode(PushButton::FilterStableTime);
+	uint64_t t0 = mbed_sim::now_us();
+	bounce(7, 0, t0 + 10000, 5, 400);
+	mbed_sim::advance(150000);
+
+	TEST_ASSERT_EQUAL(1, countEvents('P'));
+	TEST_ASSERT_EQUAL(1, countEvents('H'));
+	TEST_ASSERT_EQUAL((uint32_t)(t0 + 10000), findEvent('P')->ts_us);
+	TEST_ASSERT_UINT32_WITHIN(1000, 1600 + FilterUs, latency(findEvent('P')));
+	delete(btn);
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Modo grupo con hilo compartido", "[Driver_PushButton]") {
+	setup();
+	PushButtonManager* mgr = new PushButtonManager();
+	for(uint32_t i = 0; i < 4; i++){
+		newButton(10 + i, i, mgr);
+	}
+	TEST_ASSERT_EQUAL(4, mgr->getButtonCount());
+	btns[2]->setFilterMode(PushButton::FilterIntegrator);
+	mbed_sim::counters().thread_wakeups = 0;
+	for(uint32_t i = 0; i < 4; i++){
+		bounce(10 + i, 0, 10000 + 1000 * i, 5, 200);
+		mbed_sim::schedule_pin(10 + i, 1, 250000 + 5000 * i);
+	}
+	mbed_sim::advance(500000);
+
+	for(uint32_t i = 0; i < 4; i++){
+		TEST_ASSERT_EQUAL(1, countEvents('P', i));
+		TEST_ASSERT_EQUAL(2, countEvents('H', i));
+		TEST_ASSERT_EQUAL(1, countEvents('R', i));
+		TEST_ASSERT_EQUAL(10000 + 1000 * i, findEvent('P', i)->ts_us);
+	}
+	TEST_ASSERT_EQUAL(0, mgr->getEdgeOverflowCount());
+	printf("      %-28s despertares del hilo compartido: %u\n", "grupo x4", mbed_sim::counters().thread_wakeups);
+	reportLatency("grupo x4");
+	for(uint32_t i = 0; i < 4; i++){
+		delete(btns[i]);
+	}
+	TEST_ASSERT_EQUAL(0, mgr->getButtonCount());
+	delete(mgr);
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Modo grupo con rueda de timers compartida", "[Driver_PushButton]") {
+	setup();
+	PushButtonManager* mgr = new PushButtonManager();
+	uint32_t timers = mbed_sim::timer_count();
+	for(uint32_t i = 0; i < 32; i++){
+		newButton(100 + i, i, mgr);
+	}
+	// los timers de filtrado y hold de los 32 pulsadores se programan en la rueda del gestor
+	TEST_ASSERT_EQUAL(timers, mbed_sim::timer_count());
+	mbed_sim::counters().thread_wakeups = 0;
+	for(uint32_t i = 0; i < 32; i++){
+		bounce(100 + i, 0, 10000 + 700 * i, 5, 200);
+		mbed_sim::schedule_pin(100 + i, 1, 250000 + 700 * i);
+	}
+	mbed_sim::advance(500000);
+
+	for(uint32_t i = 0; i < 32; i++){
+		TEST_ASSERT_EQUAL(1, countEvents('P', i));
+		TEST_ASSERT_EQUAL(2, countEvents('H', i));
+		TEST_ASSERT_EQUAL(1, countEvents('R', i));
+		TEST_ASSERT_EQUAL(10000 + 700 * i, findEvent('P', i)->ts_us);
+	}
+	TEST_ASSERT_EQUAL(0, mbed_sim::counters().timer_starts);
+	TEST_ASSERT_EQUAL(0, mgr->getTimerCount());
+	printf("      %-28s despertares del hilo compartido: %u\n", "grupo x32", mbed_sim::counters().thread_wakeups);
+	reportLatency("grupo x32");
+	for(uint32_t i = 0; i < 32; i++){
+		delete(btns[i]);
+	}
+	delete(mgr);
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Contenedor estatico sin memoria dinamica", "[Driver_PushButton]") {
+	setup();
+	// el contenedor (gestor e hilo de despacho incluidos) se construye aqui, con los contadores ya reiniciados
+	static PushButtonPool<4, OS_STACK_SIZE, 1> pool;
+	TEST_ASSERT_EQUAL(0, mbed_sim::counters().heap_allocs);
+	const uint8_t* begin = (const uint8_t*)&pool;
+	const uint8_t* end = begin + sizeof(pool);
+	for(uint32_t i = 0; i < 4; i++){
+		mbed_sim::set_pin(140 + i, 1);
+		btns[i] = pool.create(140 + i, i, PushButton::PressIsLowLevel, PullUp, FilterUs, (i == 3));
+		TEST_ASSERT_TRUE(btns[i] != NULL);
+		// el pulsador reside en el propio contenedor
+		TEST_ASSERT_TRUE((const uint8_t*)btns[i] >= begin && (const uint8_t*)btns[i] < end);
+		btns[i]->enablePressEvents(callback(&onPressed));
+		btns[i]->enableReleaseEvents(callback(&onReleased));
+	}
+	// las funciones opcionales del pulsador extendido utilizan el almacenamiento del contenedor
+	btns[3]->setStormProtection(50, 10, 100);
+	TEST_ASSERT_EQUAL(0, pool.getExtFreeCount());
+	// sin posiciones libres la creacion falla sin detener el sistema
+	TEST_ASSERT_TRUE(pool.create(144, 4, PushButton::PressIsLowLevel, PullUp, FilterUs) == NULL);
+	TEST_ASSERT_EQUAL(0, pool.getFreeCount());
+	TEST_ASSERT_EQUAL(4, pool.getManager().getButtonCount());
+
+	// la posicion de un pulsador destruido se reutiliza
+	PushButton* old = btns[2];
+	pool.destroy(btns[2]);
+	TEST_ASSERT_EQUAL(1, pool.getFreeCount());
+	// sin funciones opcionales libres, la creacion de un pulsador extendido tambien falla
+	TEST_ASSERT_TRUE(pool.create(142, 2, PushButton::PressIsLowLevel, PullUp, FilterUs, true) == NULL);
+	btns[2] = pool.create(142, 2, PushButton::PressIsLowLevel, PullUp, FilterUs);
+	TEST_ASSERT_TRUE(btns[2] == old);
+	btns[2]->enablePressEvents(callback(&onPressed));
+	btns[2]->enableReleaseEvents(callback(&onReleased));
+	mbed_sim::run();
+	// ni la creacion, ni la destruccion, ni el arranque del hilo de despacho reservan memoria dinamica
+	TEST_ASSERT_EQUAL(0, mbed_sim::counters().heap_allocs);
+
+	for(uint32_t i = 0; i < 4; i++){
+		bounce(140 + i, 0, 10000 + 1000 * i, 5, 200);
+		mbed_sim::schedule_pin(140 + i, 1, 200000);
+	}
+	mbed_sim::advance(300000);
+	for(uint32_t i = 0; i < 4; i++){
+		TEST_ASSERT_EQUAL(1, countEvents('P', i));
+		TEST_ASSERT_EQUAL(1, countEvents('R', i));
+	}
+	uint32_t allocs = mbed_sim::counters().heap_allocs;
+	for(uint32_t i = 0; i < 4; i++){
+		pool.destroy(btns[i]);
+	}
+	TEST_ASSERT_EQUAL(allocs, mbed_sim::counters().heap_allocs);
+	TEST_ASSERT_EQUAL(4, pool.getFreeCount());
+	TEST_ASSERT_EQUAL(1, pool.getExtFreeCount());
+	printf("      %-28s memoria del driver: %u bytes (4 pulsadores de %u bytes, 1 extension de %u bytes, pila %u)\n", "contenedor estatico",
+			(uint32_t)sizeof(pool), (uint32_t)sizeof(PushButton), (uint32_t)sizeof(PushButton::ExtensionStorage), OS_STACK_SIZE);
+}
+
+
+//------------------------------------------------------------------------------------
+#if defined(ENABLE_PUSHBUTTON_STATS)
+static void onPressedSlow(uint32_t id){
+	mbed_sim::busy(3000);
+	record('P', id);
+}
+#endif
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Instrumentacion de latencias", "[Driver_PushButton]") {
+	setup();
+	PushButton* btn = newButton(20, 0);
+	PushButtonStats::Snapshot snap;
+	#if defined(ENABLE_PUSHBUTTON_STATS)
+	btn->enablePressEvents(callback(&onPressedSlow));
+	for(uint32_t i = 0; i < 10; i++){
+		bounce(20, 0, 10000 + 300000 * i, 3, 500);
+		mbed_sim::schedule_pin(20, 1, 250000 + 300000 * i);
+	}
+	mbed_sim::schedule_pin(20, 0, 3100000);
+	mbed_sim::schedule_pin(20, 1, 3102000);
+	mbed_sim::advance(3500000);
+
+	TEST_ASSERT_TRUE(btn->getStats(snap));
+	TEST_ASSERT_EQUAL(10, countEvents('P'));
+	TEST_ASSERT_EQUAL(20, snap.callback.count - snap.hold_ticks);
+	TEST_ASSERT_EQUAL(10 * 2, snap.hold_ticks);
+	TEST_ASSERT_EQUAL(0, snap.level_errors);
+	TEST_ASSERT_EQUAL(42, snap.dispatch.count);
+	TEST_ASSERT_EQUAL(0, snap.dispatch.max_us);
+	TEST_ASSERT_EQUAL(3000, snap.callback.max_us);
+	TEST_ASSERT_EQUAL(3000, snap.callback.p99_us);
+	TEST_ASSERT_EQUAL(0, snap.callback.p50_us);
+	printf("      %-28s callback: n=%u p50=%uus p99=%uus max=%uus\n", "instrumentacion",
+			snap.callback.count, snap.callback.p50_us, snap.callback.p99_us, snap.callback.max_us);
+	btn->resetStats();
+	btn->getStats(snap);
+	TEST_ASSERT_EQUAL(0, snap.callback.count);
+	#else
+	TEST_ASSERT_FALSE(btn->getStats(snap));
+	#endif
+	delete(btn);
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Histograma de latencias", "[Driver_PushButton]") {
+	PushButtonHistogram h;
+	PushButtonHistogram::Summary sum;
+	for(uint32_t i = 1; i <= 1000; i++){
+		h.add(i);
+	}
+	h.getSummary(sum);
+	TEST_ASSERT_EQUAL(1000, sum.count);
+	TEST_ASSERT_EQUAL(1, sum.min_us);
+	TEST_ASSERT_EQUAL(1000, sum.max_us);
+	TEST_ASSERT_UINT32_WITHIN(50, 500, sum.p50_us);
+	TEST_ASSERT_UINT32_WITHIN(30, 990, sum.p99_us);
+	for(uint32_t i = 0; i < 200000; i++){
+		h.add(700);
+	}
+	h.getSummary(sum);
+	TEST_ASSERT_EQUAL(201000, sum.count);
+	TEST_ASSERT_UINT32_WITHIN(260, 700, sum.p50_us);
+}
+
+
+
+//------------------------------------------------------------------------------------
+/** Gesto registrado: gesto, pulsaciones cortas e instante virtual */
+struct GestureEvent {
+	PushButtonGesture::Gesture gesture;
+	uint8_t clicks;
+	uint64_t t_us;
+};
+
+static std::vector<GestureEvent> gestures;
+
+static void onGesture(uint32_t /*id*/, PushButtonGesture::Gesture gesture, uint8_t clicks){
+	GestureEvent e = { gesture, clicks, mbed_sim::now_us() };
+	gestures.push_back(e);
+	contexts.push_back(mbed_sim::current_thread());
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Reconocimiento de gestos", "[Driver_PushButton]") {
+	static const char* names[] = { "independiente timer", "independiente stable", "grupo timer" };
+	// secuencias: click, doble click, triple click, pulsacion larga y click seguido de pulsacion larga
+	static const uint32_t edges[][2] = {
+		{10, 100},
+		{1010, 1060}, {1150, 1200},
+		{2010, 2060}, {2110, 2160}, {2210, 2260},
+		{3010, 3900},
+		{5010, 5060}, {5150, 6000}
+	};
+	static const GestureEvent expected[] = {
+		{ PushButtonGesture::GestureClick, 1, 300000 },
+		{ PushButtonGesture::GestureDoubleClick, 2, 1400000 },
+		{ PushButtonGesture::GestureTripleClick, 3, 2260000 + FilterUs },
+		{ PushButtonGesture::GestureLongPress, 0, 3510000 },
+		{ PushButtonGesture::GestureLongRelease, 0, 3900000 + FilterUs },
+		{ PushButtonGesture::GestureClick, 1, 5650000 },
+		{ PushButtonGesture::GestureLongPress, 0, 5650000 },
+		{ PushButtonGesture::GestureLongRelease, 0, 6000000 + FilterUs }
+	};
+	for(uint32_t m = 0; m < 3; m++){
+		setup();
+		gestures.clear();
+		PushButtonManager* mgr = (m == 2)? new PushButtonManager() : NULL;
+		PushButton* btn = newButton(30, 0, mgr);
+		btn->enableHoldEvents(callback(&onHold), 300);
+		if(m == 1){
+			btn->setFilterMode(PushButton::FilterStableTime);
+		}
+		btn->enableGestureEvents(callback(&onGesture), PushButtonGesture::Config(200000, 500000, 3));
+		for(uint32_t i = 0; i < sizeof(edges) / sizeof(edges[0]); i++){
+			mbed_sim::schedule_pin(30, 0, 1000 * edges[i][0]);
+			mbed_sim::schedule_pin(30, 1, 1000 * edges[i][1]);
+		}
+		mbed_sim::advance(7000000);
+
+		printf("      %-28s gestos: %u\n", names[m], (unsigned)gestures.size());
+		TEST_ASSERT_EQUAL(sizeof(expected) / sizeof(expected[0]), gestures.size());
+		for(uint32_t i = 0; i < gestures.size(); i++){
+			TEST_ASSERT_EQUAL(expected[i].gesture, gestures[i].gesture);
+			TEST_ASSERT_EQUAL(expected[i].clicks, gestures[i].clicks);
+			TEST_ASSERT_UINT32_WITHIN(2000, expected[i].t_us, gestures[i].t_us);
+		}
+		TEST_ASSERT_EQUAL(9, countEvents('P'));
+		TEST_ASSERT_EQUAL(9, countEvents('R'));
+		// el filtro, los eventos hold y los gestos se resuelven en un unico hilo (propio o del gestor), nunca
+		// desde el servicio de timers, por lo que el reconocedor de gestos no se modifica concurrentemente
+		TEST_ASSERT_TRUE(countEvents('H') > 0);
+		TEST_ASSERT_TRUE(contexts.size() > 0 && contexts[0] != NULL);
+		for(uint32_t i = 0; i < contexts.size(); i++){
+			TEST_ASSERT_TRUE(contexts[i] == contexts[0]);
+		}
+		delete(btn);
+		delete(mgr);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+/** Evento de combinacion registrado: combinacion, evento e instante virtual */
+struct ChordEvent {
+	uint32_t chord;
+	PushButtonChord::Event event;
+	uint64_t t_us;
+};
+
+static std::vector<ChordEvent> chords;
+
+static void onChord(uint32_t chord, PushButtonChord::Event event){
+	ChordEvent e = { chord, event, mbed_sim::now_us() };
+	chords.push_back(e);
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Combinaciones de pulsadores", "[Driver_PushButton]") {
+	setup();
+	chords.clear();
+	PushButtonManager* mgr = new PushButtonManager();
+	for(uint32_t i = 0; i < 3; i++){
+		newButton(40 + i, i, mgr);
+	}
+	const uint32_t ab[] = { 0, 1 };
+	const uint32_t abc[] = { 0, 1, 2 };
+	const uint32_t unknown[] = { 0, 7 };
+	TEST_ASSERT_TRUE(mgr->addChord(100, ab, 2, 3000));
+	TEST_ASSERT_TRUE(mgr->addChord(101, abc, 3));
+	TEST_ASSERT_FALSE(mgr->addChord(102, ab, 2));
+	TEST_ASSERT_FALSE(mgr->addChord(103, unknown, 2));
+	mgr->enableChordEvents(callback(&onChord), 150);
+
+	// A+B mantenidos 3s
+	mbed_sim::schedule_pin(40, 0, 10000);
+	mbed_sim::schedule_pin(41, 0, 60000);
+	mbed_sim::schedule_pin(40, 1, 4000000);
+	mbed_sim::schedule_pin(41, 1, 4100000);
+	// A+B fuera de la ventana de tolerancia
+	mbed_sim::schedule_pin(40, 0, 5010000);
+	mbed_sim::schedule_pin(41, 0, 5300000);
+	mbed_sim::schedule_pin(40, 1, 5500000);
+	mbed_sim::schedule_pin(41, 1, 5500000);
+	// A+B completa A+B+C
+	mbed_sim::schedule_pin(40, 0, 6010000);
+	mbed_sim::schedule_pin(41, 0, 6020000);
+	mbed_sim::schedule_pin(42, 0, 6040000);
+	mbed_sim::schedule_pin(42, 1, 6500000);
+	mbed_sim::schedule_pin(40, 1, 6600000);
+	mbed_sim::schedule_pin(41, 1, 6600000);
+	// tras liberar B no se reconoce ninguna combinacion hasta liberar todos
+	mbed_sim::schedule_pin(40, 0, 7010000);
+	mbed_sim::schedule_pin(41, 0, 7020000);
+	mbed_sim::schedule_pin(41, 1, 7100000);
+	mbed_sim::schedule_pin(41, 0, 7200000);
+	mbed_sim::schedule_pin(40, 1, 7300000);
+	mbed_sim::schedule_pin(41, 1, 7300000);
+	mbed_sim::run_until(3500000);
+	TEST_ASSERT_EQUAL(0x3, mgr->getPressedMask());
+	mbed_sim::run_until(8000000);
+	TEST_ASSERT_EQUAL(0, mgr->getPressedMask());
+
+	static const ChordEvent expected[] = {
+		{ 100, PushButtonChord::EventPress, 60000 + FilterUs },
+		{ 100, PushButtonChord::EventHold, 3060000 },
+		{ 100, PushButtonChord::EventRelease, 4000000 + FilterUs },
+		{ 100, PushButtonChord::EventPress, 6020000 + FilterUs },
+		{ 100, PushButtonChord::EventRelease, 6040000 + FilterUs },
+		{ 101, PushButtonChord::EventPress, 6040000 + FilterUs },
+		{ 101, PushButtonChord::EventRelease, 6500000 + FilterUs },
+		{ 100, PushButtonChord::EventPress, 7020000 + FilterUs },
+		{ 100, PushButtonChord::EventRelease, 7100000 + FilterUs }
+	};
+	TEST_ASSERT_EQUAL(sizeof(expected) / sizeof(expected[0]), chords.size());
+	for(uint32_t i = 0; i < chords.size(); i++){
+		TEST_ASSERT_EQUAL(expected[i].chord, chords[i].chord);
+		TEST_ASSERT_EQUAL(expected[i].event, chords[i].event);
+		TEST_ASSERT_UINT32_WITHIN(1000, expected[i].t_us, chords[i].t_us);
+	}
+	for(uint32_t i = 0; i < 3; i++){
+		delete(btns[i]);
+	}
+	delete(mgr);
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Combinaciones: eventos sin extraer", "[Driver_PushButton]") {
+	// cada llamada registra como maximo MaxPending eventos; sin extraerlos, los siguientes se contabilizan
+	PushButtonChord chord;
+	TEST_ASSERT_TRUE(chord.addChord(7, 0x3));
+	PushButtonChord::Event event;
+	uint32_t id;
+	chord.press(0, 0);
+	chord.press(1, 10);
+	chord.release(0, 20);
+	chord.release(1, 30);
+	TEST_ASSERT_EQUAL(0, chord.getDropCount());
+	chord.press(0, 40);
+	chord.press(1, 50);
+	TEST_ASSERT_EQUAL(1, chord.getDropCount());
+	TEST_ASSERT_TRUE(chord.poll(event, id));
+	TEST_ASSERT_EQUAL(PushButtonChord::EventPress, event);
+	TEST_ASSERT_EQUAL(7, id);
+	TEST_ASSERT_TRUE(chord.poll(event, id));
+	TEST_ASSERT_EQUAL(PushButtonChord::EventRelease, event);
+	TEST_ASSERT_FALSE(chord.poll(event, id));
+	// extrayendo tras cada llamada no se descarta ningun evento
+	chord.release(0, 60);
+	TEST_ASSERT_TRUE(chord.poll(event, id));
+	TEST_ASSERT_EQUAL(PushButtonChord::EventRelease, event);
+	TEST_ASSERT_EQUAL(1, chord.getDropCount());
+}
+
+
+//------------------------------------------------------------------------------------
+static std::vector<PushButtonManager::Batch> batches;
+static void onBatch(const PushButtonManager::Batch& batch){ batches.push_back(batch); }
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Entrega de eventos por lotes", "[Driver_PushButton]") {
+	setup();
+	batches.clear();
+	PushButtonManager* mgr = new PushButtonManager();
+	for(uint32_t i = 0; i < 4; i++){
+		newButton(50 + i, i, mgr);
+	}
+	uint32_t id = 0;
+	TEST_ASSERT_TRUE(mgr->getButtonId(3, id));
+	TEST_ASSERT_EQUAL(3, id);
+	TEST_ASSERT_FALSE(mgr->getButtonId(4, id));
+	mgr->enableBatchEvents(callback(&onBatch));
+
+	// tres pulsadores cambian a la vez, despues uno solo
+	for(uint32_t i = 0; i < 3; i++){
+		mbed_sim::schedule_pin(50 + i, 0, 10000);
+		mbed_sim::schedule_pin(50 + i, 1, 250000);
+	}
+	mbed_sim::schedule_pin(53, 0, 400000);
+	mbed_sim::schedule_pin(53, 1, 450000);
+	mbed_sim::advance(500000);
+
+	// las callbacks individuales se mantienen
+	for(uint32_t i = 0; i < 3; i++){
+		TEST_ASSERT_EQUAL(1, countEvents('P', i));
+		TEST_ASSERT_EQUAL(2, countEvents('H', i));
+		TEST_ASSERT_EQUAL(1, countEvents('R', i));
+	}
+	static const PushButtonManager::Batch expected[] = {
+		{ 0x7, 0, 0, 0x7, 10000 },
+		{ 0, 0x7, 0, 0x7, 10000 + FilterUs + 1000 * HoldMs },
+		{ 0, 0x7, 0, 0x7, 10000 + FilterUs + 2000 * HoldMs },
+		{ 0, 0, 0x7, 0, 250000 },
+		{ 0x8, 0, 0, 0x8, 400000 },
+		{ 0, 0, 0x8, 0, 450000 }
+	};
+	TEST_ASSERT_EQUAL(sizeof(expected) / sizeof(expected[0]), batches.size());
+	for(uint32_t i = 0; i < batches.size(); i++){
+		TEST_ASSERT_EQUAL(expected[i].pressed, batches[i].pressed);
+		TEST_ASSERT_EQUAL(expected[i].held, batches[i].held);
+		TEST_ASSERT_EQUAL(expected[i].released, batches[i].released);
+		TEST_ASSERT_EQUAL(expected[i].state, batches[i].state);
+		TEST_ASSERT_UINT32_WITHIN(1000, expected[i].ts_us, batches[i].ts_us);
+	}
+
+	// sin callback no se notifican lotes
+	mgr->disableBatchEvents();
+	mbed_sim::schedule_pin(50, 0, 510000);
+	mbed_sim::schedule_pin(50, 1, 560000);
+	mbed_sim::advance(100000);
+	TEST_ASSERT_EQUAL(2, countEvents('P', 0));
+	TEST_ASSERT_EQUAL(sizeof(expected) / sizeof(expected[0]), batches.size());
+	for(uint32_t i = 0; i < 4; i++){
+		delete(btns[i]);
+	}
+	delete(mgr);
+}
+
+
+//------------------------------------------------------------------------------------
+static uint32_t queue_notifications;
+static void onQueueNotify(){ queue_notifications++; }
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Entrega diferida por cola de eventos", "[Driver_PushButton]") {
+	setup();
+	PushButton::Event buf[4];
+	PushButtonEventQueue queue(buf, 4);
+	queue_notifications = 0;
+	queue.attach(callback(&onQueueNotify));
+	PushButton* btn = newButton(50, 0);
+	btn->setEventQueue(&queue);
+	mbed_sim::schedule_pin(50, 0, 10000);
+	mbed_sim::schedule_pin(50, 1, 260000);
+	mbed_sim::advance(400000);
+
+	// ninguna callback se ejecuta en el contexto del driver
+	TEST_ASSERT_EQUAL(0, events.size());
+	TEST_ASSERT_EQUAL(4, queue.size());
+	TEST_ASSERT_EQUAL(1, queue_notifications);
+
+	// consumo por lotes desde el hilo de la aplicacion
+	TEST_ASSERT_EQUAL(2, queue.dispatch(2));
+	TEST_ASSERT_EQUAL(1, countEvents('P'));
+	TEST_ASSERT_EQUAL(1, countEvents('H'));
+	TEST_ASSERT_EQUAL(10000, findEvent('P')->ts_us);
+	TEST_ASSERT_EQUAL(2, queue.dispatch());
+	TEST_ASSERT_EQUAL(2, countEvents('H'));
+	TEST_ASSERT_EQUAL(1, countEvents('R'));
+	TEST_ASSERT_EQUAL(260000, findEvent('R')->ts_us);
+
+	// desbordamiento: la liberacion no cabe en la cola
+	mbed_sim::schedule_pin(50, 0, 500000);
+	mbed_sim::schedule_pin(50, 1, 850000);
+	mbed_sim::advance(500000);
+	TEST_ASSERT_EQUAL(2, queue_notifications);
+	TEST_ASSERT_EQUAL(1, queue.getOverflowCount());
+	TEST_ASSERT_EQUAL(4, queue.getMaxUsage());
+
+	// los eventos pendientes de un pulsador eliminado se descartan
+	delete(btn);
+	TEST_ASSERT_EQUAL(4, queue.dispatch());
+	TEST_ASSERT_EQUAL(4, events.size());
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Modo de bajo consumo: activaciones por hora", "[Driver_PushButton]") {
+	static const uint64_t Hour = 3600ULL * 1000000;
+	uint32_t wakeups[2], holds[2];
+	for(uint32_t m = 0; m < 2; m++){
+		setup();
+		PushButtonManager* mgr = new PushButtonManager();
+		for(uint32_t i = 0; i < 4; i++){
+			newButton(60 + i, i, mgr);
+			btns[i]->enableHoldEvents(callback(&onHold), 300);
+			btns[i]->setLowPowerMode(m == 1);
+		}
+		// el gestor aplica la configuracion, tras la que se contabiliza la actividad
+		mbed_sim::run();
+		mbed_sim::counters().timer_starts = 0;
+		mbed_sim::counters().thread_wakeups = 0;
+		// una hora en reposo
+		mbed_sim::advance(Hour);
+		if(m == 1){
+			TEST_ASSERT_EQUAL(0, mbed_sim::counters().timer_starts);
+			TEST_ASSERT_EQUAL(0, mbed_sim::counters().timer_fires);
+			TEST_ASSERT_EQUAL(0, mbed_sim::counters().thread_wakeups);
+		}
+		// una hora con 30 pulsaciones de 1s con rebotes en cada pulsador
+		uint64_t t0 = mbed_sim::now_us();
+		for(uint32_t i = 0; i < 4; i++){
+			for(uint32_t n = 0; n < 30; n++){
+				uint64_t t = t0 + 100000ULL * (1 + n * 1000 + i * 7);
+				bounce(60 + i, 0, t, 5, 300);
+				bounce(60 + i, 1, t + 1000000, 3, 300);
+			}
+		}
+		mbed_sim::advance(Hour);
+
+		holds[m] = countEvents('H', 0) + countEvents('H', 1) + countEvents('H', 2) + countEvents('H', 3);
+		wakeups[m] = mgr->getWakeupCount();
+		for(uint32_t i = 0; i < 4; i++){
+			TEST_ASSERT_EQUAL(30, countEvents('P', i));
+			TEST_ASSERT_EQUAL(30, countEvents('R', i));
+			wakeups[m] += btns[i]->getWakeupCount();
+		}
+		if(m == 1){
+			TEST_ASSERT_EQUAL(0, mbed_sim::counters().timer_starts);
+		}
+		for(uint32_t i = 0; i < 4; i++){
+			delete(btns[i]);
+		}
+		delete(mgr);
+	}
+	printf("      %-28s activaciones/h: timer=%u tickless=%u (hold: %u / %u)\n", "bajo consumo x4", wakeups[0], wakeups[1], holds[0], holds[1]);
+	TEST_ASSERT_EQUAL(4 * 30 * 3, holds[0]);
+	TEST_ASSERT_EQUAL(holds[0], holds[1]);
+	TEST_ASSERT_TRUE(wakeups[1] < wakeups[0]);
+}
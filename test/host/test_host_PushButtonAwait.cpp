@@ -0,0 +1,156 @@
+/*
+ * test_host_PushButtonAwait.cpp
+ *
+ *	Test unitario en host para la espera de eventos con corrutinas (PushButtonAwait), sobre el HAL simulado.
+ *	Solo se compila con soporte de corrutinas (-std=c++20).
+ *
+ *	Compilacion y ejecucion: ver "Host tests" en README.md
+ */
+
+
+//------------------------------------------------------------------------------------
+//-- TEST HEADERS --------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+#include "mbed_sim.h"
+#include "unity.h"
+#include "PushButtonAwait.h"
+#include "PushButtonManager.h"
+#include <string>
+
+#if defined(__cpp_impl_coroutine)
+
+
+//------------------------------------------------------------------------------------
+//-- SPECIFIC COMPONENTS FOR TESTING -------------------------------------------------
+//------------------------------------------------------------------------------------
+
+static const uint32_t FilterUs = 20000;
+static const uint32_t HoldMs = 100;
+
+/** Secuencia observada por el flujo: 'P'ress, 'H'old, 'R'elease, 'T'imeout y 'M'enu (seleccion confirmada) */
+static std::string flow;
+
+
+//------------------------------------------------------------------------------------
+static void onHold(uint32_t /*id*/){ }
+
+
+//------------------------------------------------------------------------------------
+/** Flujo de menu: una pulsacion entra en el menu, las pulsaciones cortas avanzan de opcion y una pulsacion
+ *  mantenida confirma. Sin actividad durante 500ms se sale del menu
+ */
+static PushButtonTask menu(PushButtonFrame& /*frame*/, PushButtonEventSource& btn, uint32_t& option){
+	for(;;){
+		co_await btn.pressed();
+		flow += 'P';
+		option = 0;
+		for(;;){
+			PushButtonEventSource::Result r = co_await btn.nextEvent(500);
+			if(!r){
+				flow += 'T';
+				break;
+			}
+			if(r.event.type == PushButton::EventHold){
+				flow += 'H';
+				// confirma con la pulsacion mantenida y espera a su liberacion
+				co_await btn.released();
+				flow += 'M';
+				co_return;
+			}
+			flow += (r.event.type == PushButton::EventRelease)? 'R' : 'P';
+			option += (r.event.type == PushButton::EventPress)? 1 : 0;
+		}
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+static void setup(){
+	mbed_sim::reset();
+	flow.clear();
+}
+
+
+//------------------------------------------------------------------------------------
+//-- TEST CASES ----------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Corrutinas: flujo de menu con co_await", "[PushButtonAwait]") {
+	for(uint32_t run = 0; run < 2; run++){
+		setup();
+		PushButtonManager* mgr = (run == 1)? new PushButtonManager() : NULL;
+		mbed_sim::set_pin(220, 1);
+		PushButton* btn = (mgr)? new PushButton(mgr, 220, 0, PushButton::PressIsLowLevel, PullUp, FilterUs)
+				: new PushButton(220, 0, PushButton::PressIsLowLevel, PullUp, FilterUs);
+		btn->enableHoldEvents(callback(&onHold), HoldMs);
+		PushButtonEventSource* events = new PushButtonEventSource(*btn);
+		static PushButtonFrameStorage<512> frame;
+		uint32_t option = 0xFF;
+		{
+			PushButtonTask task = menu(frame, *events, option);
+			mbed_sim::run();
+			TEST_ASSERT_TRUE(frame.isUsed());
+			TEST_ASSERT_FALSE(task.done());
+
+			// entra en el menu y sale por inactividad
+			mbed_sim::schedule_pin(220, 0, 10000);
+			mbed_sim::schedule_pin(220, 1, 60000);
+			mbed_sim::advance(700000);
+			TEST_ASSERT_TRUE(flow == "PRT");
+
+			// entra, avanza dos opciones y confirma con una pulsacion mantenida
+			mbed_sim::schedule_pin(220, 0, 1000000);
+			mbed_sim::schedule_pin(220, 1, 1050000);
+			mbed_sim::schedule_pin(220, 0, 1200000);
+			mbed_sim::schedule_pin(220, 1, 1250000);
+			mbed_sim::schedule_pin(220, 0, 1400000);
+			mbed_sim::schedule_pin(220, 1, 1450000);
+			mbed_sim::schedule_pin(220, 0, 1600000);
+			mbed_sim::schedule_pin(220, 1, 1800000);
+			mbed_sim::advance(1300000);
+			TEST_ASSERT_TRUE(flow == "PRTPRPRPRPHM");
+			TEST_ASSERT_EQUAL(3, option);
+			TEST_ASSERT_TRUE(task.done());
+			TEST_ASSERT_EQUAL(0, events->getOverflowCount());
+		}
+		// el marco se libera al destruir la corrutina, sin memoria dinamica
+		TEST_ASSERT_FALSE(frame.isUsed());
+		delete(events);
+		delete(btn);
+		delete(mgr);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Corrutinas: eventos guardados y destruccion durante la espera", "[PushButtonAwait]") {
+	setup();
+	mbed_sim::set_pin(221, 1);
+	PushButton* btn = new PushButton(221, 0, PushButton::PressIsLowLevel, PullUp, FilterUs);
+	PushButtonEventSource* events = new PushButtonEventSource(*btn);
+	static PushButtonFrameStorage<512> frame;
+	uint32_t option = 0;
+
+	// los eventos anteriores a la corrutina se entregan en sus primeras esperas
+	mbed_sim::schedule_pin(221, 0, 10000);
+	mbed_sim::schedule_pin(221, 1, 60000);
+	mbed_sim::advance(100000);
+	{
+		PushButtonTask task = menu(frame, *events, option);
+		TEST_ASSERT_TRUE(flow == "PR");
+		TEST_ASSERT_FALSE(task.done());
+	}
+	// la corrutina destruida durante la espera deja de recibir eventos y su timeout se descarta
+	TEST_ASSERT_FALSE(frame.isUsed());
+	mbed_sim::schedule_pin(221, 0, 200000);
+	mbed_sim::schedule_pin(221, 1, 250000);
+	mbed_sim::advance(1000000);
+	TEST_ASSERT_TRUE(flow == "PR");
+	delete(events);
+	delete(btn);
+}
+
+#endif /* __cpp_impl_coroutine */
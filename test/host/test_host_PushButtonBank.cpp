@@ -0,0 +1,85 @@
+/*
+ * test_host_PushButtonBank.cpp
+ *
+ *	Test unitario en host para el motor de filtrado por contadores verticales PushButtonBank.
+ *
+ *	Compilacion y ejecucion: ver "Host tests" en README.md
+ */
+
+
+//------------------------------------------------------------------------------------
+//-- TEST HEADERS --------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+#include "unity.h"
+#include "PushButtonBank.h"
+
+
+//------------------------------------------------------------------------------------
+//-- TEST CASES ----------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Banco: cambio tras 4 muestras y rebotes descartados", "[PushButtonBank]") {
+	PushButtonBank<uint32_t> bank(10);
+	const uint32_t idle = 0xFFFFFFFF;
+	const uint32_t key3 = idle & ~(1u << 3);
+
+	// rebotes: ninguna secuencia de menos de 4 muestras iguales cambia el estado
+	TEST_ASSERT_EQUAL(0, bank.update(key3));
+	TEST_ASSERT_EQUAL(0, bank.update(key3));
+	TEST_ASSERT_EQUAL(0, bank.update(idle));
+	TEST_ASSERT_EQUAL(0, bank.update(key3));
+	TEST_ASSERT_EQUAL(0, bank.update(key3));
+	TEST_ASSERT_EQUAL(0, bank.update(key3));
+	TEST_ASSERT_EQUAL(1u << 3, bank.update(key3));
+	TEST_ASSERT_EQUAL(1u << 3, bank.getState());
+
+	uint32_t id = 0;
+	bool pressed = false;
+	TEST_ASSERT_TRUE(bank.nextEvent(id, pressed));
+	TEST_ASSERT_EQUAL(13, id);
+	TEST_ASSERT_TRUE(pressed);
+	TEST_ASSERT_FALSE(bank.nextEvent(id, pressed));
+
+	for(uint32_t i = 0; i < PushButtonBank<uint32_t>::Samples; i++){
+		bank.update(idle);
+	}
+	TEST_ASSERT_EQUAL(0, bank.getState());
+	TEST_ASSERT_TRUE(bank.nextEvent(id, pressed));
+	TEST_ASSERT_EQUAL(13, id);
+	TEST_ASSERT_FALSE(pressed);
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Banco: 64 entradas en paralelo con polaridad mixta", "[PushButtonBank]") {
+	// entradas 0..31 activas a nivel bajo, 32..63 activas a nivel alto, la entrada 63 no se utiliza
+	const uint64_t low = 0x00000000FFFFFFFFULL;
+	PushButtonBank<uint64_t> bank(0, low, ~(1ULL << 63));
+	const uint64_t idle = low;
+	const uint64_t all = ~low;
+
+	for(uint32_t i = 0; i < PushButtonBank<uint64_t>::Samples; i++){
+		bank.update(all);
+	}
+	TEST_ASSERT_TRUE(bank.getState() == ~(1ULL << 63));
+
+	uint32_t id = 0, n = 0;
+	bool pressed = false;
+	while(bank.nextEvent(id, pressed)){
+		TEST_ASSERT_TRUE(pressed);
+		TEST_ASSERT_EQUAL(n, id);
+		n++;
+	}
+	TEST_ASSERT_EQUAL(63, n);
+
+	for(uint32_t i = 0; i < PushButtonBank<uint64_t>::Samples; i++){
+		bank.update(idle);
+	}
+	TEST_ASSERT_TRUE(bank.getState() == 0);
+	TEST_ASSERT_TRUE(bank.getReleased() == ~(1ULL << 63));
+	bank.clearEvents();
+	TEST_ASSERT_FALSE(bank.nextEvent(id, pressed));
+}
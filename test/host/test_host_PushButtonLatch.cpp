@@ -0,0 +1,165 @@
+/*
+ * test_host_PushButtonLatch.cpp
+ *
+ *	Test unitario en host para la publicacion de configuraciones PushButtonLatch, sobre el HAL simulado.
+ *
+ *	Compilacion y ejecucion: ver "Host tests" en README.md
+ */
+
+
+//------------------------------------------------------------------------------------
+//-- TEST HEADERS --------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+#include "mbed_sim.h"
+#include "unity.h"
+#include "PushButtonLatch.h"
+
+
+//------------------------------------------------------------------------------------
+//-- SPECIFIC COMPONENTS FOR TESTING -------------------------------------------------
+//------------------------------------------------------------------------------------
+
+struct TConfig {
+	uint32_t a;
+	uint32_t b;
+	TConfig() : a(0), b(0) {}
+};
+
+typedef PushButtonLatch<TConfig> TLatch;
+
+static TLatch* latch;
+static Thread* readers[2];
+static uint32_t seen[2][2];
+static bool written;
+
+
+//------------------------------------------------------------------------------------
+/** Lector que retiene la configuracion publicada hasta recibir una senal */
+static void readerTask(uint32_t i){
+	TLatch::Reader cfg(*latch);
+	seen[i][0] = cfg->a + cfg->b;
+	readers[i]->signal_wait(1);
+	seen[i][1] = cfg->a + cfg->b;
+}
+static void reader0(){ readerTask(0); }
+static void reader1(){ readerTask(1); }
+
+
+//------------------------------------------------------------------------------------
+static void publish(uint32_t v){
+	TConfig& cfg = latch->edit();
+	cfg.a = v;
+	cfg.b = v;
+	latch->publish();
+}
+static void writerTask(){
+	publish(3);
+	written = true;
+}
+
+
+//------------------------------------------------------------------------------------
+//-- TEST CASES ----------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Latch: lectores retienen la configuracion publicada", "[PushButtonLatch]") {
+	mbed_sim::reset();
+	latch = new TLatch();
+	TEST_ASSERT_EQUAL(0, TLatch::Reader(*latch)->a);
+
+	// cada lector conserva la configuracion vigente al iniciar la lectura
+	readers[0] = new Thread();
+	readers[0]->start(callback(&reader0));
+	mbed_sim::run();
+	publish(1);
+	readers[1] = new Thread();
+	readers[1]->start(callback(&reader1));
+	mbed_sim::run();
+	publish(2);
+	TEST_ASSERT_EQUAL(2, TLatch::Reader(*latch)->a);
+
+	// con las dos posiciones libres retenidas, el escritor espera hasta que se libera una
+	written = false;
+	Thread* writer = new Thread();
+	writer->start(callback(&writerTask));
+	mbed_sim::run();
+	TEST_ASSERT_FALSE(written);
+	mbed_sim::advance(5000);
+	TEST_ASSERT_FALSE(written);
+	readers[0]->signal_set(1);
+	mbed_sim::advance(1000);
+	TEST_ASSERT_TRUE(written);
+	readers[1]->signal_set(1);
+	mbed_sim::run();
+
+	TEST_ASSERT_EQUAL(0, seen[0][0]);
+	TEST_ASSERT_EQUAL(0, seen[0][1]);
+	TEST_ASSERT_EQUAL(2, seen[1][0]);
+	TEST_ASSERT_EQUAL(2, seen[1][1]);
+	TEST_ASSERT_EQUAL(6, TLatch::Reader(*latch)->a + TLatch::Reader(*latch)->b);
+	delete(writer);
+	delete(readers[0]);
+	delete(readers[1]);
+	delete(latch);
+}
+
+
+//------------------------------------------------------------------------------------
+typedef PushButtonLatch<TConfig, 2> TLatch2;
+
+static TLatch2* latch2;
+static uint32_t published;
+
+
+//------------------------------------------------------------------------------------
+/** Lector que retiene la configuracion publicada hasta recibir una senal */
+static void reader2Task(){
+	TLatch2::Reader cfg(*latch2);
+	seen[0][0] = cfg->a;
+	readers[0]->signal_wait(1);
+	seen[0][1] = cfg->a;
+}
+
+
+//------------------------------------------------------------------------------------
+/** Escritor con dos publicaciones consecutivas */
+static void writer2Task(){
+	for(uint32_t v = 1; v <= 2; v++){
+		TConfig& cfg = latch2->edit();
+		cfg.a = v;
+		latch2->publish();
+		published = v;
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Latch: dos posiciones", "[PushButtonLatch]") {
+	mbed_sim::reset();
+	latch2 = new TLatch2();
+	published = 0;
+	readers[0] = new Thread();
+	readers[0]->start(callback(&reader2Task));
+	mbed_sim::run();
+
+	// la primera publicacion utiliza la posicion libre; la segunda espera a que el lector libere la anterior
+	Thread* writer = new Thread();
+	writer->start(callback(&writer2Task));
+	mbed_sim::run();
+	TEST_ASSERT_EQUAL(1, published);
+	TEST_ASSERT_EQUAL(1, TLatch2::Reader(*latch2)->a);
+	mbed_sim::advance(5000);
+	TEST_ASSERT_EQUAL(1, published);
+	readers[0]->signal_set(1);
+	mbed_sim::advance(1000);
+	TEST_ASSERT_EQUAL(2, published);
+	TEST_ASSERT_EQUAL(0, seen[0][0]);
+	TEST_ASSERT_EQUAL(0, seen[0][1]);
+	TEST_ASSERT_EQUAL(2, TLatch2::Reader(*latch2)->a);
+	delete(writer);
+	delete(readers[0]);
+	delete(latch2);
+}
@@ -0,0 +1,211 @@
+/*
+ * test_host_PushButtonMatrix.cpp
+ *
+ *	Test unitario en host para el modulo PushButtonMatrix, sobre el HAL simulado.
+ *
+ *	La matriz de teclas se modela con un observador de las salidas de fila: cada columna queda a nivel bajo
+ *	si alguna de sus teclas pulsadas pertenece a una fila activa (nivel bajo).
+ *
+ *	Compilacion y ejecucion: ver "Host tests" en README.md
+ */
+
+
+//------------------------------------------------------------------------------------
+//-- TEST HEADERS --------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+#include "mbed_sim.h"
+#include "unity.h"
+#include "PushButtonMatrix.h"
+#include <vector>
+
+
+//------------------------------------------------------------------------------------
+//-- SPECIFIC COMPONENTS FOR TESTING -------------------------------------------------
+//------------------------------------------------------------------------------------
+
+static const uint8_t NumLines = 4;
+static const PinName32 Rows[NumLines] = { 40, 41, 42, 43 };
+static const PinName32 Cols[NumLines] = { 50, 51, 52, 53 };
+static const uint32_t BaseId = 100;
+static const uint32_t ScanMs = 5;
+static const uint32_t HoldMs = 100;
+
+
+/** Evento registrado: tipo ('P'ress, 'H'old, 'R'elease), tecla e instante virtual */
+struct KeyEvent {
+	char type;
+	uint32_t id;
+	uint64_t t_us;
+};
+
+static std::vector<KeyEvent> events;
+static uint64_t keys;
+
+
+//------------------------------------------------------------------------------------
+static void record(char type, uint32_t id){
+	KeyEvent e = { type, id, mbed_sim::now_us() };
+	events.push_back(e);
+}
+static void onPressed(uint32_t id){ record('P', id); }
+static void onHold(uint32_t id){ record('H', id); }
+static void onReleased(uint32_t id){ record('R', id); }
+
+
+//------------------------------------------------------------------------------------
+static uint32_t countEvents(char type, uint32_t id){
+	uint32_t n = 0;
+	for(size_t i = 0; i < events.size(); i++){
+		n += (events[i].type == type && events[i].id == id)? 1 : 0;
+	}
+	return n;
+}
+
+
+//------------------------------------------------------------------------------------
+static const KeyEvent* findEvent(char type, uint32_t id){
+	for(size_t i = 0; i < events.size(); i++){
+		if(events[i].type == type && events[i].id == id){
+			return &events[i];
+		}
+	}
+	return NULL;
+}
+
+
+/** Actualiza el nivel de las columnas en funcion de las filas activas y las teclas pulsadas */
+static void updateColumns(){
+	for(uint8_t c = 0; c < NumLines; c++){
+		int level = 1;
+		for(uint8_t r = 0; r < NumLines; r++){
+			if((keys & ((uint64_t)1 << (r * NumLines + c))) != 0 && mbed_sim::get_pin(Rows[r]) == 0){
+				level = 0;
+			}
+		}
+		mbed_sim::set_pin(Cols[c], level);
+	}
+}
+
+
+/** Pulsa o libera una tecla en un instante absoluto del reloj virtual */
+static void setKey(uint32_t key, bool pressed, uint64_t at_us){
+	mbed_sim::run_until(at_us);
+	keys = (pressed)? (keys | ((uint64_t)1 << key)) : (keys & ~((uint64_t)1 << key));
+	updateColumns();
+}
+
+
+//------------------------------------------------------------------------------------
+static PushButtonMatrix* newMatrix(){
+	mbed_sim::reset();
+	events.clear();
+	keys = 0;
+	mbed_sim::on_output([](PinName, int){ updateColumns(); });
+	for(uint8_t c = 0; c < NumLines; c++){
+		mbed_sim::set_pin(Cols[c], 1);
+	}
+	PushButtonMatrix* mtx = new PushButtonMatrix(Rows, NumLines, Cols, NumLines, BaseId, ScanMs);
+	mtx->enablePressEvents(callback(&onPressed));
+	mtx->enableHoldEvents(callback(&onHold), HoldMs);
+	mtx->enableReleaseEvents(callback(&onReleased));
+	mbed_sim::run();
+	return mtx;
+}
+
+
+//------------------------------------------------------------------------------------
+//-- TEST CASES ----------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Matriz en reposo sin barridos", "[PushButtonMatrix]") {
+	PushButtonMatrix* mtx = newMatrix();
+	mbed_sim::advance(1000000);
+
+	PushButtonMatrix::ScanStats stats;
+	mtx->getScanStats(stats);
+	TEST_ASSERT_EQUAL(0, stats.scans);
+	TEST_ASSERT_EQUAL(0, stats.wakeups);
+	TEST_ASSERT_EQUAL(0, mbed_sim::counters().thread_wakeups);
+	TEST_ASSERT_EQUAL(0, events.size());
+	delete(mtx);
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Matriz pulsacion con rebotes y eventos hold", "[PushButtonMatrix]") {
+	PushButtonMatrix* mtx = newMatrix();
+	setKey(5, true, 10000);
+	setKey(5, false, 10300);
+	setKey(5, true, 10600);
+	mbed_sim::run_until(100000);
+	TEST_ASSERT_EQUAL((uint64_t)1 << 5, mtx->getState());
+	setKey(5, false, 372000);
+	mbed_sim::run_until(1000000);
+
+	TEST_ASSERT_EQUAL(1, countEvents('P', BaseId + 5));
+	TEST_ASSERT_EQUAL(3, countEvents('H', BaseId + 5));
+	TEST_ASSERT_EQUAL(1, countEvents('R', BaseId + 5));
+	TEST_ASSERT_EQUAL(5, events.size());
+	TEST_ASSERT_EQUAL(25000, findEvent('P', BaseId + 5)->t_us);
+	TEST_ASSERT_EQUAL(125000, findEvent('H', BaseId + 5)->t_us);
+	TEST_ASSERT_EQUAL(390000, findEvent('R', BaseId + 5)->t_us);
+	TEST_ASSERT_EQUAL(0, mtx->getState());
+
+	// tras la liberacion vuelve a reposo: no hay mas barridos
+	PushButtonMatrix::ScanStats stats;
+	mtx->getScanStats(stats);
+	TEST_ASSERT_EQUAL(1, stats.wakeups);
+	TEST_ASSERT_EQUAL(77, stats.scans);
+	TEST_ASSERT(stats.max_us >= stats.last_us);
+	mbed_sim::advance(1000000);
+	mtx->getScanStats(stats);
+	TEST_ASSERT_EQUAL(77, stats.scans);
+	delete(mtx);
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Matriz teclas simultaneas", "[PushButtonMatrix]") {
+	PushButtonMatrix* mtx = newMatrix();
+	mtx->disableHoldEvents();
+	setKey(0, true, 10000);
+	setKey(15, true, 10000);
+	setKey(6, true, 40000);
+	mbed_sim::run_until(100000);
+	TEST_ASSERT_EQUAL(((uint64_t)1 << 0) | ((uint64_t)1 << 6) | ((uint64_t)1 << 15), mtx->getState());
+	setKey(15, false, 200000);
+	mbed_sim::run_until(300000);
+	TEST_ASSERT_EQUAL(((uint64_t)1 << 0) | ((uint64_t)1 << 6), mtx->getState());
+	setKey(0, false, 300000);
+	setKey(6, false, 300000);
+	mbed_sim::run_until(1000000);
+
+	TEST_ASSERT_EQUAL(1, countEvents('P', BaseId + 0));
+	TEST_ASSERT_EQUAL(1, countEvents('P', BaseId + 6));
+	TEST_ASSERT_EQUAL(1, countEvents('P', BaseId + 15));
+	TEST_ASSERT_EQUAL(1, countEvents('R', BaseId + 0));
+	TEST_ASSERT_EQUAL(1, countEvents('R', BaseId + 6));
+	TEST_ASSERT_EQUAL(1, countEvents('R', BaseId + 15));
+	TEST_ASSERT_EQUAL(6, events.size());
+	TEST_ASSERT(findEvent('R', BaseId + 15)->t_us < findEvent('R', BaseId + 0)->t_us);
+	delete(mtx);
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Matriz glitch descartado", "[PushButtonMatrix]") {
+	PushButtonMatrix* mtx = newMatrix();
+	setKey(9, true, 10000);
+	setKey(9, false, 12000);
+	mbed_sim::run_until(500000);
+
+	PushButtonMatrix::ScanStats stats;
+	mtx->getScanStats(stats);
+	TEST_ASSERT_EQUAL(0, events.size());
+	TEST_ASSERT_EQUAL(1, stats.wakeups);
+	TEST_ASSERT_EQUAL(1 + 4, stats.scans);
+	delete(mtx);
+}
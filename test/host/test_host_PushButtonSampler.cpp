@@ -0,0 +1,180 @@
+/*
+ * test_host_PushButtonSampler.cpp
+ *
+ *	Test unitario en host para los pulsadores con entradas muestreadas (PushButtonSampler), sobre el HAL simulado.
+ *	Las entradas del expansor simulado son pines del HAL simulado leidos desde la funcion de lectura.
+ *
+ *	Compilacion y ejecucion: ver "Host tests" en README.md
+ */
+
+
+//------------------------------------------------------------------------------------
+//-- TEST HEADERS --------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+#include "mbed_sim.h"
+#include "unity.h"
+#include "PushButton.h"
+#include "PushButtonManager.h"
+#include "PushButtonSampler.h"
+#include <vector>
+
+
+//------------------------------------------------------------------------------------
+//-- SPECIFIC COMPONENTS FOR TESTING -------------------------------------------------
+//------------------------------------------------------------------------------------
+
+static const uint32_t FilterUs = 10000;
+static const uint32_t PeriodMs = 2;
+static const PinName ExpanderPin = 200;			/// Pin del HAL simulado de la entrada 0 del expansor
+
+
+/** Evento registrado: tipo ('P'ress, 'H'old, 'R'elease), pulsador e instante virtual */
+struct Event {
+	char type;
+	uint32_t id;
+	uint64_t t_us;
+};
+
+static std::vector<Event> events;
+static uint32_t reads;
+static bool read_fails;
+
+
+//------------------------------------------------------------------------------------
+static void record(char type, uint32_t id){
+	Event e = { type, id, mbed_sim::now_us() };
+	events.push_back(e);
+}
+static void onPressed(uint32_t id){ record('P', id); }
+static void onHold(uint32_t id){ record('H', id); }
+static void onReleased(uint32_t id){ record('R', id); }
+
+
+//------------------------------------------------------------------------------------
+static uint32_t countEvents(char type, uint32_t id){
+	uint32_t n = 0;
+	for(size_t i = 0; i < events.size(); i++){
+		n += (events[i].type == type && events[i].id == id)? 1 : 0;
+	}
+	return n;
+}
+
+
+/** Registro de entradas del expansor simulado: entrada i = pin ExpanderPin + i */
+static bool readExpander(uint32_t& raw){
+	reads++;
+	if(read_fails){
+		return false;
+	}
+	raw = 0;
+	for(uint32_t i = 0; i < 8; i++){
+		raw |= (uint32_t)mbed_sim::get_pin(ExpanderPin + i) << i;
+	}
+	return true;
+}
+
+
+//------------------------------------------------------------------------------------
+static void setup(){
+	mbed_sim::reset();
+	events.clear();
+	reads = 0;
+	read_fails = false;
+	for(uint32_t i = 0; i < 8; i++){
+		mbed_sim::set_pin(ExpanderPin + i, 1);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+//-- TEST CASES ----------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Muestreador: expansor con pulsadores independientes y en grupo", "[PushButtonSampler]") {
+	setup();
+	PushButtonSampler* smp = new PushButtonSampler(callback(&readExpander), PeriodMs);
+	PushButtonManager* mgr = new PushButtonManager();
+	PushButton* b0 = new PushButton(smp, 0, 0, PushButton::PressIsLowLevel, FilterUs);
+	PushButton* b3 = new PushButton(smp, 3, 3, PushButton::PressIsLowLevel, FilterUs, mgr);
+	PushButton* btns[] = { b0, b3 };
+	for(uint32_t i = 0; i < 2; i++){
+		btns[i]->enablePressEvents(callback(&onPressed));
+		btns[i]->enableReleaseEvents(callback(&onReleased));
+	}
+	mbed_sim::run();
+
+	// rebotes de 300us, mas rapidos que el muestreo, en ambas entradas
+	for(uint32_t i = 0; i < 7; i++){
+		mbed_sim::schedule_pin(ExpanderPin, (i % 2 == 0)? 0 : 1, 10000 + i * 300);
+		mbed_sim::schedule_pin(ExpanderPin + 3, (i % 2 == 0)? 0 : 1, 20000 + i * 300);
+	}
+	mbed_sim::schedule_pin(ExpanderPin, 1, 100000);
+	mbed_sim::schedule_pin(ExpanderPin + 3, 1, 150000);
+	mbed_sim::advance(200000);
+
+	TEST_ASSERT_EQUAL(1, countEvents('P', 0));
+	TEST_ASSERT_EQUAL(1, countEvents('R', 0));
+	TEST_ASSERT_EQUAL(1, countEvents('P', 3));
+	TEST_ASSERT_EQUAL(1, countEvents('R', 3));
+	// la pulsacion se observa en la primera muestra tras el ultimo rebote y se filtra a continuacion
+	TEST_ASSERT_TRUE(events[0].t_us <= 11800 + 1000 * PeriodMs + FilterUs + 1000);
+
+	// contacto ruidoso: 500 flancos en 65ms no generan mas de un flanco por muestra ni eventos
+	PushButtonSampler::Stats before, after;
+	smp->getStats(before);
+	for(uint32_t i = 0; i < 500; i++){
+		mbed_sim::schedule_pin(ExpanderPin, (i % 2 == 0)? 0 : 1, 300000 + i * 130);
+	}
+	mbed_sim::advance(200000);
+	smp->getStats(after);
+	TEST_ASSERT_TRUE(after.edges > before.edges);
+	TEST_ASSERT_TRUE(after.edges - before.edges <= (65 / PeriodMs) + 1);
+	TEST_ASSERT_EQUAL(1, countEvents('P', 0));
+	TEST_ASSERT_EQUAL(200 / PeriodMs, after.samples - before.samples);
+
+	// las lecturas fallidas descartan la muestra
+	read_fails = true;
+	mbed_sim::set_pin(ExpanderPin, 0);
+	mbed_sim::advance(50000);
+	smp->getStats(after);
+	TEST_ASSERT_TRUE(after.read_errors > 0);
+	TEST_ASSERT_EQUAL(1, countEvents('P', 0));
+	read_fails = false;
+	mbed_sim::advance(50000);
+	TEST_ASSERT_EQUAL(2, countEvents('P', 0));
+	// una lectura inicial en la construccion y una por periodo
+	smp->getStats(after);
+	TEST_ASSERT_EQUAL(1 + after.samples + after.read_errors, reads);
+
+	delete(b0);
+	delete(b3);
+	delete(mgr);
+	delete(smp);
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Muestreador: pines sin interrupcion", "[PushButtonSampler]") {
+	setup();
+	mbed_sim::set_pin(210, 1);
+	PushButtonSampler* smp = new PushButtonSampler(PeriodMs);
+	smp->addPin(5, 210, PullUp);
+	PushButton* btn = new PushButton(smp, 5, 7, PushButton::PressIsLowLevel, FilterUs);
+	btn->enablePressEvents(callback(&onPressed));
+	btn->enableHoldEvents(callback(&onHold), 100);
+	btn->enableReleaseEvents(callback(&onReleased));
+	mbed_sim::run();
+
+	mbed_sim::schedule_pin(210, 0, 10000);
+	mbed_sim::schedule_pin(210, 1, 260000);
+	mbed_sim::advance(300000);
+	TEST_ASSERT_EQUAL(1, countEvents('P', 7));
+	TEST_ASSERT_EQUAL(2, countEvents('H', 7));
+	TEST_ASSERT_EQUAL(1, countEvents('R', 7));
+	TEST_ASSERT_EQUAL(0, btn->getEdgeOverflowCount());
+	delete(btn);
+	delete(smp);
+}
@@ -0,0 +1,163 @@
+/*
+ * test_host_PushButtonT.cpp
+ *
+ *	Test unitario en host para la variante configurada en tiempo de compilacion PushButtonT, sobre el HAL
+ *	simulado. Un hilo de la aplicacion atiende los pulsadores con process().
+ *
+ *	Compilacion y ejecucion: ver "Host tests" en README.md
+ */
+
+
+//------------------------------------------------------------------------------------
+//-- TEST HEADERS --------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+#include "mbed_sim.h"
+#include "unity.h"
+#include "PushButtonT.h"
+#include <vector>
+
+
+//------------------------------------------------------------------------------------
+//-- SPECIFIC COMPONENTS FOR TESTING -------------------------------------------------
+//------------------------------------------------------------------------------------
+
+static const PinName32 PinPress = 150;
+static const PinName32 PinFull = 151;
+
+typedef PushButtonT<PushButton::PressIsLowLevel, PushButtonEvents::Press, 20000> PressOnly;
+typedef PushButtonT<PushButton::PressIsHighLevel, PushButtonEvents::Press | PushButtonEvents::Hold | PushButtonEvents::Release, 20000, 100> FullButton;
+
+/** Evento registrado: tipo ('P'ress, 'H'old, 'R'elease), pulsador e instante virtual */
+struct TEvent {
+	char type;
+	uint32_t id;
+	uint64_t t_us;
+};
+
+static std::vector<TEvent> events;
+static Thread* app;
+static PressOnly* press_only;
+static FullButton* full;
+static const int32_t EvButton = (1 << 0);
+
+
+//------------------------------------------------------------------------------------
+static void record(char type, uint32_t id){
+	TEvent e = { type, id, mbed_sim::now_us() };
+	events.push_back(e);
+}
+static void onPressed(uint32_t id){ record('P', id); }
+static void onHold(uint32_t id){ record('H', id); }
+static void onReleased(uint32_t id){ record('R', id); }
+static void wakeup(){ app->signal_set(EvButton); }
+
+
+//------------------------------------------------------------------------------------
+static uint32_t countEvents(char type, uint32_t id){
+	uint32_t n = 0;
+	for(size_t i = 0; i < events.size(); i++){
+		n += (events[i].type == type && events[i].id == id)? 1 : 0;
+	}
+	return n;
+}
+
+
+//------------------------------------------------------------------------------------
+/** Bucle de eventos de la aplicacion: espera hasta el menor de los timeouts de los pulsadores */
+static void appTask(){
+	uint32_t timeout = osWaitForever;
+	for(;;){
+		app->signal_wait(EvButton, timeout);
+		uint32_t t1 = press_only->process();
+		uint32_t t2 = full->process();
+		timeout = (t1 < t2)? t1 : t2;
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+/** Programa una transicion con rebotes: n flancos alternos separados spacing_us, terminando en 'level' */
+static void bounce(PinName pin, int level, uint64_t at_us, uint32_t n, uint32_t spacing_us){
+	for(uint32_t i = 0; i < n; i++){
+		int l = ((n - 1 - i) % 2 == 0)? level : !level;
+		mbed_sim::schedule_pin(pin, l, at_us + i * spacing_us);
+	}
+}
+
+
+//------------------------------------------------------------------------------------
+//-- TEST CASES ----------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Plantilla: eventos habilitados en compilacion", "[PushButtonT]") {
+	mbed_sim::reset();
+	events.clear();
+	mbed_sim::set_pin(PinPress, 1);
+	mbed_sim::set_pin(PinFull, 0);
+	press_only = new PressOnly(PinPress, 1, PullUp);
+	full = new FullButton(PinFull, 2, PullDown);
+	press_only->enablePressEvents(callback(&onPressed));
+	full->enablePressEvents(callback(&onPressed));
+	full->enableHoldEvents(callback(&onHold));
+	full->enableReleaseEvents(callback(&onReleased));
+	app = new Thread();
+	app->start(callback(&appTask));
+	press_only->attach(callback(&wakeup));
+	full->attach(callback(&wakeup));
+	mbed_sim::run();
+
+	// pulsaciones con rebotes: un evento por transicion, 20ms tras el ultimo rebote
+	bounce(PinPress, 0, 10000, 5, 300);
+	bounce(PinPress, 1, 100000, 3, 300);
+	bounce(PinFull, 1, 10000, 5, 300);
+	bounce(PinFull, 0, 260000, 3, 300);
+	mbed_sim::advance(400000);
+
+	TEST_ASSERT_EQUAL(1, countEvents('P', 1));
+	TEST_ASSERT_EQUAL(0, countEvents('R', 1));
+	TEST_ASSERT_EQUAL(1, countEvents('P', 2));
+	TEST_ASSERT_EQUAL(2, countEvents('H', 2));
+	TEST_ASSERT_EQUAL(1, countEvents('R', 2));
+	TEST_ASSERT_EQUAL(11200 + 20000, events[0].t_us);
+	TEST_ASSERT_FALSE(press_only->isPressed());
+	TEST_ASSERT_EQUAL(0, press_only->getEdgeOverflowCount());
+
+	// los eventos deshabilitados no ocupan memoria
+	printf("      %-28s memoria por pulsador: PushButton=%u press=%u press+hold+release=%u\n", "plantilla",
+			(uint32_t)sizeof(PushButton), (uint32_t)sizeof(PressOnly), (uint32_t)sizeof(FullButton));
+	TEST_ASSERT_TRUE(sizeof(PressOnly) + 2 * sizeof(Callback<void(uint32_t)>) < sizeof(FullButton));
+	TEST_ASSERT_TRUE(sizeof(FullButton) < sizeof(PushButton) / 2);
+
+	delete(app);
+	delete(press_only);
+	delete(full);
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Plantilla: resincronizacion tras desbordar el buffer de flancos", "[PushButtonT]") {
+	mbed_sim::reset();
+	events.clear();
+	mbed_sim::set_pin(152, 1);
+	// sin callback de notificacion ni hilo: los flancos se acumulan hasta la siguiente invocacion de process()
+	PressOnly* btn = new PressOnly(152, 3, PullUp);
+	btn->enablePressEvents(callback(&onPressed));
+
+	// 15 rebotes terminando en pulsacion: los 7 ultimos flancos no caben en el buffer (8) y el ultimo registrado
+	// es de liberacion
+	bounce(152, 0, 10000, 15, 300);
+	mbed_sim::advance(50000);
+	TEST_ASSERT_EQUAL(7, btn->getEdgeOverflowCount());
+	TEST_ASSERT_EQUAL(20, btn->process());
+	TEST_ASSERT_EQUAL(0, countEvents('P', 3));
+
+	// la rafaga resuelta con el nivel del pin se notifica tras una nueva ventana de filtrado
+	mbed_sim::advance(20000);
+	TEST_ASSERT_EQUAL(osWaitForever, btn->process());
+	TEST_ASSERT_EQUAL(1, countEvents('P', 3));
+	TEST_ASSERT_TRUE(btn->isPressed());
+	delete(btn);
+}
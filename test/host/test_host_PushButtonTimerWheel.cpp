@@ -0,0 +1,125 @@
+/*
+ * test_host_PushButtonTimerWheel.cpp
+ *
+ *	Test unitario en host para la rueda de temporizadores PushButtonTimerWheel.
+ *
+ *	Compilacion y ejecucion: ver "Host tests" en README.md
+ */
+
+
+//------------------------------------------------------------------------------------
+//-- TEST HEADERS --------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+#include "unity.h"
+#include "PushButtonTimerWheel.h"
+#include <stdlib.h>
+
+
+//------------------------------------------------------------------------------------
+//-- TEST CASES ----------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Rueda: vencimientos, cancelacion y periodo", "[PushButtonTimerWheel]") {
+	PushButtonTimerWheel wheel(1000, 0);
+	PushButtonTimerWheel::Node filt, hold, stopped;
+	TEST_ASSERT_EQUAL(PushButtonTimerWheel::NoDeadline, wheel.getRemaining(0));
+
+	wheel.start(&filt, 20000, 0, 0);
+	wheel.start(&hold, 300000, 300000, 0);
+	wheel.start(&stopped, 10000, 0, 0);
+	wheel.stop(&stopped);
+	TEST_ASSERT_EQUAL(2, wheel.getCount());
+	TEST_ASSERT_EQUAL(20000, wheel.getRemaining(0));
+
+	// sin vencimientos antes de tiempo
+	wheel.advance(19999);
+	TEST_ASSERT_TRUE(wheel.popExpired() == NULL);
+	TEST_ASSERT_EQUAL(1, wheel.getRemaining(19999));
+	wheel.advance(20000);
+	TEST_ASSERT_TRUE(wheel.popExpired() == &filt);
+	TEST_ASSERT_TRUE(wheel.popExpired() == NULL);
+	TEST_ASSERT_EQUAL(1, wheel.getCount());
+
+	// el siguiente vencimiento es exacto aunque el temporizador este en un nivel superior
+	TEST_ASSERT_EQUAL(280000, wheel.getRemaining(20000));
+
+	// periodico: se reprograma desde su vencimiento, sin acumular el retraso de la activacion
+	wheel.advance(305000);
+	TEST_ASSERT_TRUE(wheel.popExpired() == &hold);
+	TEST_ASSERT_EQUAL(295000, wheel.getRemaining(305000));
+	wheel.advance(1200000);
+	uint32_t fires = 0;
+	while(wheel.popExpired() == &hold){
+		fires++;
+	}
+	TEST_ASSERT_EQUAL(3, fires);
+
+	// cambio de periodo al atender el vencimiento: el siguiente se desplaza sin detener el temporizador
+	wheel.setPeriod(&hold, 50000);
+	TEST_ASSERT_EQUAL(50000, wheel.getRemaining(1200000));
+	wheel.advance(1250000);
+	TEST_ASSERT_TRUE(wheel.popExpired() == &hold);
+	TEST_ASSERT_TRUE(wheel.popExpired() == NULL);
+	TEST_ASSERT_EQUAL(50000, wheel.getRemaining(1250000));
+	TEST_ASSERT_EQUAL(1, wheel.getCount());
+	wheel.stop(&hold);
+	TEST_ASSERT_EQUAL(0, wheel.getCount());
+	TEST_ASSERT_EQUAL(PushButtonTimerWheel::NoDeadline, wheel.getRemaining(1200000));
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Rueda: secuencia aleatoria frente a modelo de referencia", "[PushButtonTimerWheel]") {
+	static const uint32_t Timers = 64;
+	// inicio proximo al desbordamiento del contador de microsegundos
+	uint32_t now = 0xFFFFFFFF - 5000000;
+	PushButtonTimerWheel wheel(1000, now);
+	PushButtonTimerWheel::Node node[Timers];
+	uint32_t deadline[Timers];
+	bool armed[Timers];
+	for(uint32_t i = 0; i < Timers; i++){
+		armed[i] = false;
+	}
+	srand(1234);
+	uint32_t fired = 0;
+	for(uint32_t step = 0; step < 20000; step++){
+		uint32_t i = rand() % Timers;
+		uint32_t op = rand() % 4;
+		if(op == 0){
+			wheel.stop(&node[i]);
+			armed[i] = false;
+		}
+		else if(op == 1 || !armed[i]){
+			// retardos de los tres niveles y fuera de alcance
+			static const uint32_t Range[] = { 60000, 4000000, 250000000, 400000000 };
+			uint32_t delay = 1000 * (1 + rand() % (Range[rand() % 4] / 1000));
+			wheel.start(&node[i], delay, 0, now);
+			deadline[i] = now + delay;
+			armed[i] = true;
+		}
+		// avanza hasta el siguiente vencimiento o una fraccion del mismo
+		uint32_t remaining = wheel.getRemaining(now);
+		uint32_t dt = (remaining == PushButtonTimerWheel::NoDeadline)? 1000 : ((rand() % 2)? remaining : remaining / 2);
+		now += dt;
+		wheel.advance(now);
+		PushButtonTimerWheel::Node* n;
+		while((n = wheel.popExpired()) != NULL){
+			uint32_t k = (uint32_t)(n - node);
+			TEST_ASSERT_TRUE(armed[k]);
+			// vence en su instante, con la resolucion de un tick
+			TEST_ASSERT_TRUE((int32_t)(now - deadline[k]) >= 0);
+			TEST_ASSERT_TRUE((int32_t)(now - deadline[k]) < 1000);
+			armed[k] = false;
+			fired++;
+		}
+		uint32_t count = 0;
+		for(uint32_t k = 0; k < Timers; k++){
+			count += (armed[k])? 1 : 0;
+		}
+		TEST_ASSERT_EQUAL(count, wheel.getCount());
+	}
+	TEST_ASSERT_TRUE(fired > 1000);
+}
@@ -0,0 +1,159 @@
+/*
+ * test_host_PushButtonTrace.cpp
+ *
+ *	Test unitario en host para el registrador de trazas PushButtonTrace, sobre el HAL simulado.
+ *
+ *	Compilacion y ejecucion: ver "Host tests" en README.md
+ */
+
+
+//------------------------------------------------------------------------------------
+//-- TEST HEADERS --------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+#include "mbed_sim.h"
+#include "unity.h"
+#include "PushButton.h"
+#include "PushButtonTrace.h"
+#include <vector>
+
+
+//------------------------------------------------------------------------------------
+//-- SPECIFIC COMPONENTS FOR TESTING -------------------------------------------------
+//------------------------------------------------------------------------------------
+
+static const uint32_t FilterUs = 20000;
+static const uint32_t HoldMs = 100;
+
+static void onEvent(uint32_t /*id*/){}
+
+
+//------------------------------------------------------------------------------------
+static PushButton* newButton(PinName pin){
+	mbed_sim::set_pin(pin, 1);
+	PushButton* btn = new PushButton(pin, 0, PushButton::PressIsLowLevel, PullUp, FilterUs);
+	btn->enablePressEvents(callback(&onEvent));
+	btn->enableHoldEvents(callback(&onEvent), HoldMs);
+	btn->enableReleaseEvents(callback(&onEvent));
+	mbed_sim::run();
+	return btn;
+}
+
+
+//------------------------------------------------------------------------------------
+static std::vector<PushButtonTrace::Record> decode(const uint8_t* blob, uint32_t len, PushButtonTrace::Header& hdr){
+	std::vector<PushButtonTrace::Record> recs;
+	PushButtonTrace::Reader rd(blob, len);
+	TEST_ASSERT_TRUE(rd.isValid());
+	hdr = rd.getHeader();
+	PushButtonTrace::Record rec;
+	while(rd.next(rec)){
+		recs.push_back(rec);
+	}
+	return recs;
+}
+
+
+//------------------------------------------------------------------------------------
+//-- TEST CASES ----------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Traza: registro y decodificacion", "[PushButtonTrace]") {
+	mbed_sim::reset();
+	PushButton* btn = newButton(1);
+	static uint8_t buf[256];
+	PushButtonTrace trace(buf, sizeof(buf));
+	btn->setTraceRecorder(&trace);
+
+	// pulsacion con 7 flancos de rebote, 3 eventos hold y liberacion limpia
+	for(uint32_t i = 0; i < 7; i++){
+		mbed_sim::schedule_pin(1, (i % 2 == 0)? 0 : 1, 10000 + i * 300);
+	}
+	mbed_sim::schedule_pin(1, 1, 360000);
+	mbed_sim::advance(500000);
+
+	// flancos de rebote de 2 bytes
+	TEST_ASSERT_TRUE(trace.size() <= 3 + 6 * 2 + 4 * 3 + 2 * 3);
+	static uint8_t blob[PushButtonTrace::HeaderSize + sizeof(buf)];
+	uint32_t len = trace.snapshot(blob, sizeof(blob));
+	TEST_ASSERT_EQUAL(PushButtonTrace::HeaderSize + trace.size(), len);
+
+	PushButtonTrace::Header hdr;
+	std::vector<PushButtonTrace::Record> recs = decode(blob, len, hdr);
+	TEST_ASSERT_EQUAL(FilterUs, hdr.filter_us);
+	TEST_ASSERT_EQUAL(1000 * HoldMs, hdr.hold_us);
+	TEST_ASSERT_EQUAL(PushButton::PressIsLowLevel, hdr.level);
+	TEST_ASSERT_EQUAL(PushButton::FilterTimer, hdr.filt_mode);
+	TEST_ASSERT_EQUAL(1, hdr.base_level);
+	TEST_ASSERT_EQUAL(0, hdr.dropped);
+
+	const uint8_t kinds[] = {
+		PushButtonTrace::KindFall, PushButtonTrace::KindRise, PushButtonTrace::KindFall, PushButtonTrace::KindRise,
+		PushButtonTrace::KindFall, PushButtonTrace::KindRise, PushButtonTrace::KindFall, PushButtonTrace::KindPress,
+		PushButtonTrace::KindHold, PushButtonTrace::KindHold, PushButtonTrace::KindHold, PushButtonTrace::KindRise,
+		PushButtonTrace::KindRelease };
+	TEST_ASSERT_EQUAL(sizeof(kinds), recs.size());
+	for(uint32_t i = 0; i < recs.size(); i++){
+		TEST_ASSERT_EQUAL(kinds[i], recs[i].kind);
+	}
+	for(uint32_t i = 0; i < 7; i++){
+		TEST_ASSERT_EQUAL(10000 + i * 300, recs[i].ts_us);
+	}
+	TEST_ASSERT_EQUAL(11800 + FilterUs, recs[7].ts_us);
+	TEST_ASSERT_EQUAL(360000, recs[11].ts_us);
+	TEST_ASSERT_EQUAL(360000 + FilterUs, recs[12].ts_us);
+
+	// sin registrador no se registra nada mas
+	btn->setTraceRecorder(NULL);
+	uint32_t size = trace.size();
+	mbed_sim::schedule_pin(1, 0, 600000);
+	mbed_sim::advance(100000);
+	TEST_ASSERT_EQUAL(size, trace.size());
+	delete(btn);
+}
+
+
+//------------------------------------------------------------------------------------
+TEST_CASE("Traza: registrador de vuelo", "[PushButtonTrace]") {
+	mbed_sim::reset();
+	PushButton* btn = newButton(2);
+	static uint8_t buf[32];
+	PushButtonTrace trace(buf, sizeof(buf));
+	btn->setTraceRecorder(&trace);
+
+	// 40 glitches descartados por el filtro, que desbordan el registrador
+	const uint32_t Edges = 40;
+	for(uint32_t i = 0; i < Edges; i++){
+		mbed_sim::schedule_pin(2, (i % 2 == 0)? 0 : 1, 10000 + i * 300);
+	}
+	mbed_sim::advance(100000);
+	TEST_ASSERT_TRUE(trace.getDroppedCount() > 0);
+
+	// se conserva la historia mas reciente, con el nivel de referencia del primer flanco conservado
+	static uint8_t blob[PushButtonTrace::HeaderSize + sizeof(buf)];
+	PushButtonTrace::Header hdr;
+	std::vector<PushButtonTrace::Record> recs = decode(blob, trace.snapshot(blob, sizeof(blob)), hdr);
+	TEST_ASSERT_EQUAL(Edges, hdr.dropped + recs.size());
+	TEST_ASSERT_EQUAL(10000 + (hdr.dropped - 1) * 300, hdr.base_ts_us);
+	uint8_t level = hdr.base_level;
+	for(uint32_t i = 0; i < recs.size(); i++){
+		TEST_ASSERT_EQUAL((level)? PushButtonTrace::KindFall : PushButtonTrace::KindRise, recs[i].kind);
+		TEST_ASSERT_EQUAL(10000 + (hdr.dropped + i) * 300, recs[i].ts_us);
+		level = !level;
+	}
+
+	// un destino reducido recibe solo el registro completo mas reciente, con su instante y nivel de referencia
+	uint32_t len = trace.snapshot(blob, PushButtonTrace::HeaderSize + 3);
+	TEST_ASSERT_EQUAL(PushButtonTrace::HeaderSize + 2, len);
+	recs = decode(blob, len, hdr);
+	TEST_ASSERT_EQUAL(1, recs.size());
+	TEST_ASSERT_EQUAL(Edges - 1, hdr.dropped);
+	TEST_ASSERT_EQUAL(10000 + (Edges - 2) * 300, hdr.base_ts_us);
+	TEST_ASSERT_EQUAL(10000 + (Edges - 1) * 300, recs[0].ts_us);
+	TEST_ASSERT_EQUAL(PushButtonTrace::KindRise, recs[0].kind);
+	TEST_ASSERT_EQUAL(0, hdr.base_level);
+	TEST_ASSERT_EQUAL(0, trace.snapshot(blob, PushButtonTrace::HeaderSize - 1));
+	delete(btn);
+}
@@ -0,0 +1,65 @@
+/*
+ * unity.cpp
+ *
+ *	Ejecucion de los tests registrados con el subconjunto de Unity para host.
+ */
+
+#include "unity.h"
+#include <vector>
+
+
+//------------------------------------------------------------------------------------
+//--- PRIVATE TYPES ------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+struct TestCase {
+	const char* name;
+	const char* tags;
+	host_unity::TestFn fn;
+};
+
+static std::vector<TestCase>& tests(){
+	static std::vector<TestCase> list;
+	return list;
+}
+
+static jmp_buf s_abort;
+
+
+//------------------------------------------------------------------------------------
+void host_unity::add(const char* name, const char* tags, TestFn fn){
+	TestCase t = { name, tags, fn };
+	tests().push_back(t);
+}
+
+
+//------------------------------------------------------------------------------------
+void host_unity::fail(const char* file, int line, const char* msg){
+	printf("%s:%d: FAIL: %s\n", file, line, msg);
+	longjmp(s_abort, 1);
+}
+
+
+//------------------------------------------------------------------------------------
+int unity_run_all_tests(){
+	int failures = 0;
+	for(size_t i = 0; i < tests().size(); i++){
+		const TestCase& t = tests()[i];
+		if(setjmp(s_abort) == 0){
+			t.fn();
+			printf("PASS  %s %s\n", t.tags, t.name);
+		}
+		else{
+			printf("FAIL  %s %s\n", t.tags, t.name);
+			failures++;
+		}
+	}
+	printf("\n%u Tests %d Failures\n", (unsigned)tests().size(), failures);
+	return failures;
+}
+
+
+//------------------------------------------------------------------------------------
+int main(){
+	return (unity_run_all_tests() == 0)? 0 : 1;
+}
@@ -0,0 +1,53 @@
+/*
+ * unity.h
+ *
+ *	Subconjunto de Unity para ejecutar en host los tests escritos con el mismo formato que los tests
+ *	unitarios de ESP-MDF (TEST_CASE y TEST_ASSERT_*). Los tests se registran de forma estatica y se
+ *	ejecutan todos en orden de registro desde el main() de unity.cpp, por lo que pueden repartirse en varios
+ *	ficheros de test enlazados en un mismo ejecutable.
+ */
+
+#ifndef __HOST_UNITY__H
+#define __HOST_UNITY__H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <setjmp.h>
+
+namespace host_unity {
+typedef void (*TestFn)();
+void add(const char* name, const char* tags, TestFn fn);
+void fail(const char* file, int line, const char* msg);
+}
+
+/** Ejecuta todos los tests registrados y devuelve el numero de fallos */
+int unity_run_all_tests();
+
+#define _UNITY_CAT2(a, b)	a##b
+#define _UNITY_CAT(a, b)	_UNITY_CAT2(a, b)
+
+/** El registro se declara en un espacio de nombres anonimo para que los tests de distintos ficheros en la
+ *  misma linea no colisionen al enlazar */
+#define TEST_CASE(name, tags)	\
+	static void _UNITY_CAT(_test_fn_, __LINE__)();	\
+	namespace { struct _UNITY_CAT(_test_reg_, __LINE__) { \
+		_UNITY_CAT(_test_reg_, __LINE__)() { host_unity::add(name, tags, &_UNITY_CAT(_test_fn_, __LINE__)); } \
+	} _UNITY_CAT(_test_reg_inst_, __LINE__); } \
+	static void _UNITY_CAT(_test_fn_, __LINE__)()
+
+#define TEST_FAIL_MESSAGE(msg)				host_unity::fail(__FILE__, __LINE__, msg)
+#define TEST_ASSERT_MESSAGE(cond, msg)		do{ if(!(cond)){ TEST_FAIL_MESSAGE(msg); } }while(0)
+#define TEST_ASSERT(cond)					TEST_ASSERT_MESSAGE((cond), #cond)
+#define TEST_ASSERT_TRUE(cond)				TEST_ASSERT_MESSAGE((cond), #cond " is not true")
+#define TEST_ASSERT_FALSE(cond)				TEST_ASSERT_MESSAGE(!(cond), #cond " is not false")
+#define TEST_ASSERT_NULL(ptr)				TEST_ASSERT_MESSAGE((ptr) == NULL, #ptr " is not NULL")
+#define TEST_ASSERT_NOT_NULL(ptr)			TEST_ASSERT_MESSAGE((ptr) != NULL, #ptr " is NULL")
+#define TEST_ASSERT_EQUAL(exp, act)		\
+	do{ long long _e = (long long)(exp), _a = (long long)(act); if(_e != _a){ \
+		char _m[128]; snprintf(_m, sizeof(_m), "expected %lld, was %lld (" #act ")", _e, _a); TEST_FAIL_MESSAGE(_m); } }while(0)
+#define TEST_ASSERT_EQUAL_UINT32(exp, act)	TEST_ASSERT_EQUAL(exp, act)
+#define TEST_ASSERT_UINT32_WITHIN(delta, exp, act)	\
+	do{ long long _e = (long long)(exp), _a = (long long)(act), _d = (long long)(delta); if(_a < _e - _d || _a > _e + _d){ \
+		char _m[128]; snprintf(_m, sizeof(_m), "expected %lld +/- %lld, was %lld (" #act ")", _e, _d, _a); TEST_FAIL_MESSAGE(_m); } }while(0)
+
+#endif /*__HOST_UNITY__H */
@@ -0,0 +1,196 @@
+/*
+ * trace_replay.cpp
+ *
+ *	Reproduce en host, sobre el HAL simulado de test/host, una traza exportada con PushButtonTrace::snapshot
+ *	(p.ej. volcada por consola desde el dispositivo). Los flancos registrados se aplican al pin de un PushButton
+ *	en sus instantes originales, y se comparan los eventos obtenidos con los registrados en el dispositivo. La
+ *	configuracion de filtrado y de eventos hold puede modificarse para evaluar su efecto sobre un contacto real.
+ *
+ *	Uso:
+ *		trace_replay <traza> [--filter-us N] [--mode timer|stable|integrator|adaptive] [--hold-ms N] [--leading 0|1]
+ *
+ *	Los gestos se reproducen con las ventanas de reconocimiento por defecto (PushButtonGesture::Config), que
+ *	no se registran en la traza. Termina con 0 si los eventos reproducidos coinciden con los registrados.
+ *
+ *	Compilacion (desde este directorio):
+ *		g++ -std=c++11 -I../host -I../.. trace_replay.cpp ../host/mbed_sim.cpp ../../PushButon.cpp
+ *			../../PushButtonManager.cpp ../../PushButtonEventQueue.cpp ../../PushButtonTrace.cpp ../../PushButtonSampler.cpp
+ *			-o trace_replay
+ */
+
+#include "mbed_sim.h"
+#include "PushButton.h"
+#include "PushButtonTrace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+
+//------------------------------------------------------------------------------------
+//-- REPLAY STATE --------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+static const PinName Pin = 1;
+static const char* KindNames[] = { "fall", "rise", "press", "hold", "release", "gesture", "cancel", "storm" };
+
+/** Evento notificado: tipo (PushButtonTrace::Kind), instante y gesto/pulsaciones */
+struct Event {
+	uint8_t kind;
+	uint32_t ts_us;
+	uint32_t value;
+};
+
+static std::vector<Event> replayed;
+
+
+//------------------------------------------------------------------------------------
+static void record(uint8_t kind, uint32_t value = 0){
+	Event e = { kind, PushButton::getTimeUs(), value };
+	replayed.push_back(e);
+}
+static void onPressed(uint32_t /*id*/){ record(PushButtonTrace::KindPress); }
+static void onHold(uint32_t /*id*/){ record(PushButtonTrace::KindHold); }
+static void onReleased(uint32_t /*id*/){ record(PushButtonTrace::KindRelease); }
+static void onCancelled(uint32_t /*id*/){ record(PushButtonTrace::KindCancel); }
+static void onGesture(uint32_t /*id*/, PushButtonGesture::Gesture gesture, uint8_t clicks){
+	record(PushButtonTrace::KindGesture, ((uint32_t)gesture << 8) | clicks);
+}
+
+
+//------------------------------------------------------------------------------------
+static void printEvent(const char* tag, const Event& e, uint32_t base_ts_us){
+	printf("%-9s %10u us  %-8s", tag, e.ts_us - base_ts_us, KindNames[e.kind]);
+	if(e.kind == PushButtonTrace::KindGesture){
+		printf(" gesture=%u clicks=%u", e.value >> 8, e.value & 0xFF);
+	}
+	printf("\n");
+}
+
+
+//------------------------------------------------------------------------------------
+static int usage(){
+	fprintf(stderr, "uso: trace_replay <traza> [--filter-us N] [--mode timer|stable|integrator|adaptive] [--hold-ms N] [--leading 0|1]\n");
+	return 2;
+}
+
+
+//------------------------------------------------------------------------------------
+//-- MAIN ----------------------------------------------------------------------------
+//------------------------------------------------------------------------------------
+
+int main(int argc, char** argv){
+	if(argc < 2){
+		return usage();
+	}
+	FILE* f = fopen(argv[1], "rb");
+	if(!f){
+		fprintf(stderr, "ERR_OPEN %s\n", argv[1]);
+		return 2;
+	}
+	std::vector<uint8_t> blob;
+	uint8_t chunk[512];
+	size_t n;
+	while((n = fread(chunk, 1, sizeof(chunk), f)) > 0){
+		blob.insert(blob.end(), chunk, chunk + n);
+	}
+	fclose(f);
+
+	PushButtonTrace::Reader rd(blob.data(), (uint32_t)blob.size());
+	if(!rd.isValid()){
+		fprintf(stderr, "ERR_TRACE %s\n", argv[1]);
+		return 2;
+	}
+	const PushButtonTrace::Header& hdr = rd.getHeader();
+
+	// configuracion registrada, modificable desde la linea de comandos
+	uint32_t filter_us = hdr.filter_us;
+	uint32_t hold_us = hdr.hold_us;
+	PushButton::FilterMode mode = (PushButton::FilterMode)hdr.filt_mode;
+	bool leading = (hdr.flags & PushButtonTrace::FlagLeadingEdge) != 0;
+	for(int i = 2; i < argc; i++){
+		if(i + 1 >= argc){
+			return usage();
+		}
+		if(strcmp(argv[i], "--filter-us") == 0){
+			filter_us = (uint32_t)strtoul(argv[++i], NULL, 0);
+		}
+		else if(strcmp(argv[i], "--hold-ms") == 0){
+			hold_us = 1000 * (uint32_t)strtoul(argv[++i], NULL, 0);
+		}
+		else if(strcmp(argv[i], "--leading") == 0){
+			leading = strtoul(argv[++i], NULL, 0) != 0;
+		}
+		else if(strcmp(argv[i], "--mode") == 0){
+			const char* m = argv[++i];
+			if(strcmp(m, "timer") == 0){ mode = PushButton::FilterTimer; }
+			else if(strcmp(m, "stable") == 0){ mode = PushButton::FilterStableTime; }
+			else if(strcmp(m, "integrator") == 0){ mode = PushButton::FilterIntegrator; }
+			else if(strcmp(m, "adaptive") == 0){ mode = PushButton::FilterAdaptive; }
+			else{ return usage(); }
+		}
+		else{
+			return usage();
+		}
+	}
+	printf("traza: %u bytes, %u registros descartados, nivel inicial %u\n", hdr.length, hdr.dropped, hdr.base_level);
+	printf("registrada:  filter_us=%u mode=%u hold_us=%u leading=%u\n", hdr.filter_us, hdr.filt_mode, hdr.hold_us,
+			hdr.flags & PushButtonTrace::FlagLeadingEdge);
+	printf("reproducida: filter_us=%u mode=%u hold_us=%u leading=%u\n\n", filter_us, (uint32_t)mode, hold_us, leading);
+
+	// el reloj virtual parte del instante de referencia, de forma que las marcas de tiempo coinciden con las registradas
+	mbed_sim::reset(hdr.base_ts_us);
+	mbed_sim::set_pin(Pin, hdr.base_level);
+	PushButton btn(Pin, 0, (PushButton::LogicLevel)hdr.level, PullNone, filter_us);
+	btn.setFilterMode(mode);
+	btn.enablePressEvents(callback(&onPressed));
+	if(hold_us > 0){
+		btn.enableHoldEvents(callback(&onHold), hold_us / 1000);
+	}
+	btn.enableReleaseEvents(callback(&onReleased));
+	btn.enableGestureEvents(callback(&onGesture));
+	btn.enableCancelEvents(callback(&onCancelled));
+	btn.setLeadingEdgeMode(leading);
+	mbed_sim::run();
+
+	// los flancos se programan en tiempo virtual de 64 bits, por lo que la traza puede cruzar el desbordamiento del reloj
+	std::vector<Event> recorded;
+	uint64_t t = hdr.base_ts_us;
+	uint64_t last_edge = t;
+	uint32_t prev_ts = hdr.base_ts_us;
+	PushButtonTrace::Record rec;
+	while(rd.next(rec)){
+		t += (uint32_t)(rec.ts_us - prev_ts);
+		prev_ts = rec.ts_us;
+		if(rec.kind == PushButtonTrace::KindRise || rec.kind == PushButtonTrace::KindFall){
+			mbed_sim::schedule_pin(Pin, rec.kind, t);
+			last_edge = t;
+		}
+		else{
+			Event e = { rec.kind, rec.ts_us, rec.value };
+			recorded.push_back(e);
+		}
+	}
+	// la traza termina en su ultimo registro: solo se espera al filtrado del ultimo flanco, sin anadir eventos hold
+	// que el dispositivo no llego a registrar
+	uint64_t end = last_edge + filter_us + 1000;
+	mbed_sim::run_until((end > t)? end : t);
+
+	// comparacion de las dos secuencias en orden
+	uint32_t mismatches = 0;
+	size_t total = (recorded.size() > replayed.size())? recorded.size() : replayed.size();
+	for(size_t i = 0; i < total; i++){
+		bool same = i < recorded.size() && i < replayed.size() && recorded[i].kind == replayed[i].kind
+				&& recorded[i].value == replayed[i].value;
+		if(i < recorded.size()){
+			printEvent(same? "registro" : "registro*", recorded[i], hdr.base_ts_us);
+		}
+		if(i < replayed.size()){
+			printEvent(same? "replay" : "replay*", replayed[i], hdr.base_ts_us);
+		}
+		mismatches += same? 0 : 1;
+	}
+	printf("\neventos: %u registrados, %u reproducidos, %u diferencias\n", (uint32_t)recorded.size(),
+			(uint32_t)replayed.size(), mismatches);
+	return (mismatches == 0)? 0 : 1;
+}